@@ -23,12 +23,14 @@
 #include "Core/ConfigManager.h"
 #include "Core/Movie.h"
 
+#include <atomic>
 #include <string>
 
 // This shouldn't be a global, at least not here.
 std::unique_ptr<SoundStream> g_sound_stream;
 
 static bool s_audio_dump_start = false;
+static std::atomic<AudioCommon::SoundDumpCallback> s_sound_dump_callback{nullptr};
 
 namespace AudioCommon
 {
@@ -266,4 +268,14 @@ void ToggleMuteVolume()
   isMuted = !isMuted;
   UpdateSoundStream();
 }
+
+void SetSoundDumpCallback(SoundDumpCallback callback)
+{
+  s_sound_dump_callback.store(callback);
+}
+
+SoundDumpCallback GetSoundDumpCallback()
+{
+  return s_sound_dump_callback.load();
+}
 }
@@ -29,4 +29,10 @@ void StopAudioDump();
 void IncreaseVolume(unsigned short offset);
 void DecreaseVolume(unsigned short offset);
 void ToggleMuteVolume();
+
+// Receives the big-endian stereo DSP samples sent to the mixer, set by the frame dumper to mux
+// audio into the video. Called from the CPU thread.
+using SoundDumpCallback = void (*)(const s16* samples, u32 num_samples, u32 sample_rate);
+void SetSoundDumpCallback(SoundDumpCallback callback);
+SoundDumpCallback GetSoundDumpCallback();
 }
@@ -3,10 +3,14 @@
 // Refer to the license.txt file included.
 // Modified For Ishiiruka By Tino
 
+#include <algorithm>
+#include <cmath>
+
 #include "AudioCommon/AudioCommon.h"
 #include "AudioCommon/Mixer.h"
 #include "Common/Atomic.h"
 #include "Common/CPUDetect.h"
+#include "Common/Intrinsics.h"
 #include "Common/MathUtil.h"
 #include "Common/CommonFuncs.h"
 #include "Core/ConfigManager.h"
@@ -22,10 +26,139 @@ const float CMixer::MAX_FREQ_SHIFT = 200;
 const float CMixer::CONTROL_FACTOR = 0.2f;
 const float CMixer::CONTROL_AVG = 32;
 
+namespace
+{
+// Interpolation kernels used by MixerFifo::Resample. Each reads WINDOW_SIZE
+// interleaved stereo floats from <in> and writes both interpolated channels,
+// <fraction> of a sample past the center of its window, to <out>.
+
+struct LinearKernel
+{
+	static const u32 WINDOW_SIZE = 4;
+
+	static void Interpolate(const float* in, float fraction, float* out)
+	{
+#ifdef _M_X86
+		__m128 p = _mm_mul_ps(_mm_loadu_ps(in),
+			_mm_setr_ps(1 - fraction, 1 - fraction, fraction, fraction));
+		_mm_storel_pi((__m64*)out, _mm_add_ps(p, _mm_movehl_ps(p, p)));
+#else
+		out[0] = (1 - fraction) * in[0] + fraction * in[2];
+		out[1] = (1 - fraction) * in[1] + fraction * in[3];
+#endif
+	}
+};
+
+struct CubicKernel
+{
+	static const u32 WINDOW_SIZE = 8;
+
+	static void Interpolate(const float* in, float fraction, float* out)
+	{
+		static const float cubic_coef[] =
+		{
+		  -0.5f, 1.0f, -0.5f, 0.0f,
+		  1.5f, -2.5f, 0.0f, 1.0f,
+		  -1.5f, 2.0f, 0.5f, 0.0f,
+		  0.5f, -0.5f, 0.0f, 0.0f
+		};
+
+		const float x2 = fraction;       // x
+		const float x1 = x2*x2;          // x^2
+		const float x0 = x1*x2;          // x^3
+
+		float y0 = cubic_coef[0] * x0 + cubic_coef[1] * x1 + cubic_coef[2] * x2 + cubic_coef[3];
+		float y1 = cubic_coef[4] * x0 + cubic_coef[5] * x1 + cubic_coef[6] * x2 + cubic_coef[7];
+		float y2 = cubic_coef[8] * x0 + cubic_coef[9] * x1 + cubic_coef[10] * x2 + cubic_coef[11];
+		float y3 = cubic_coef[12] * x0 + cubic_coef[13] * x1 + cubic_coef[14] * x2 + cubic_coef[15];
+
+#ifdef _M_X86
+		__m128 p = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in), _mm_setr_ps(y0, y0, y1, y1)),
+			_mm_mul_ps(_mm_loadu_ps(in + 4), _mm_setr_ps(y2, y2, y3, y3)));
+		_mm_storel_pi((__m64*)out, _mm_add_ps(p, _mm_movehl_ps(p, p)));
+#else
+		out[0] = y0 * in[0] + y1 * in[2] + y2 * in[4] + y3 * in[6];
+		out[1] = y0 * in[1] + y1 * in[3] + y2 * in[5] + y3 * in[7];
+#endif
+	}
+};
+
+// Blackman windowed sinc, with the interpolated point between taps 7 and 8.
+// Weights are tabulated per phase and linearly interpolated between phases.
+const u32 SINC_TAPS = 16;
+const u32 SINC_PHASES = 256;
+
+struct SincTable
+{
+	alignas(16) float weights[SINC_PHASES + 1][SINC_TAPS];
+};
+
+SincTable BuildSincTable()
+{
+	SincTable table;
+	for (u32 phase = 0; phase <= SINC_PHASES; ++phase)
+	{
+		double fraction = (double)phase / SINC_PHASES;
+		double sum = 0.0;
+		for (u32 tap = 0; tap < SINC_TAPS; ++tap)
+		{
+			double x = tap - (SINC_TAPS / 2 - 1) - fraction;
+			double sinc = x == 0.0 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+			double n = (x + SINC_TAPS / 2) / SINC_TAPS;
+			double window = 0.42 - 0.5 * cos(2 * M_PI * n) + 0.08 * cos(4 * M_PI * n);
+			table.weights[phase][tap] = (float)(sinc * window);
+			sum += sinc * window;
+		}
+		// Unity gain at DC for every phase.
+		for (u32 tap = 0; tap < SINC_TAPS; ++tap)
+			table.weights[phase][tap] = (float)(table.weights[phase][tap] / sum);
+	}
+	return table;
+}
+
+const SincTable s_sinc_table = BuildSincTable();
+
+struct SincKernel
+{
+	static const u32 WINDOW_SIZE = SINC_TAPS * 2;
+
+	static void Interpolate(const float* in, float fraction, float* out)
+	{
+		float position = fraction * SINC_PHASES;
+		u32 phase = std::min((u32)position, SINC_PHASES - 1);
+		float t = position - phase;
+		const float* w0 = s_sinc_table.weights[phase];
+		const float* w1 = s_sinc_table.weights[phase + 1];
+
+#ifdef _M_X86
+		const __m128 vt = _mm_set1_ps(t);
+		__m128 acc = _mm_setzero_ps();
+		for (u32 i = 0; i < SINC_TAPS; i += 4)
+		{
+			__m128 a = _mm_load_ps(w0 + i);
+			__m128 w = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(w1 + i), a), vt));
+			// Both channels share the weights: duplicate each of them.
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(in + i * 2), _mm_unpacklo_ps(w, w)));
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(in + i * 2 + 4), _mm_unpackhi_ps(w, w)));
+		}
+		_mm_storel_pi((__m64*)out, _mm_add_ps(acc, _mm_movehl_ps(acc, acc)));
+#else
+		out[0] = out[1] = 0.0f;
+		for (u32 i = 0; i < SINC_TAPS; ++i)
+		{
+			float w = w0[i] + (w1[i] - w0[i]) * t;
+			out[0] += w * in[i * 2];
+			out[1] += w * in[i * 2 + 1];
+		}
+#endif
+	}
+};
+}
+
 CMixer::CMixer(u32 BackendSampleRate)
-	: m_dma_mixer(this, 32000)
-	, m_streaming_mixer(this, 48000)
-	, m_wiimote_speaker_mixer(this, 3000)
+	: m_dma_mixer(this, 32000, RESAMPLER_CUBIC, true)
+	, m_streaming_mixer(this, 48000, RESAMPLER_CUBIC, true)
+	, m_wiimote_speaker_mixer(this, 3000, RESAMPLER_LINEAR, false)
 	, m_sample_rate(BackendSampleRate)
 	, m_log_dtk_audio(0)
 	, m_log_dsp_audio(0)
@@ -34,61 +167,48 @@ CMixer::CMixer(u32 BackendSampleRate)
 	INFO_LOG(AUDIO_INTERFACE, "Mixer is initialized");
 }
 
-void CMixer::LinearMixerFifo::Interpolate(u32 left_input_index, float* left_output, float* right_output)
+template <class Kernel>
+u32 CMixer::MixerFifo::Resample(float* samples, u32 num_samples, u32& read_index, u32 write_index,
+	float ratio, float l_volume, float r_volume)
 {
-	*left_output = (1 - m_fraction) * m_float_buffer[left_input_index & INDEX_MASK]
-		+ m_fraction * m_float_buffer[(left_input_index + 2) & INDEX_MASK];
-	*right_output = (1 - m_fraction) * m_float_buffer[(left_input_index + 1) & INDEX_MASK]
-		+ m_fraction * m_float_buffer[(left_input_index + 3) & INDEX_MASK];
-}
-
-void CMixer::CubicMixerFifo::Interpolate(u32 left_input_index, float* left_output, float* right_output)
-{
-	static const float cubic_coef[] =
+	// for each output sample pair (left and right),
+	// interpolate around the current input sample
+	// increment output sample position
+	// increment input sample position by ratio, store fraction
+	float fraction = m_fraction;
+	u32 current_sample = 0;
+	for (; current_sample < num_samples * 2 && ((write_index - read_index) & INDEX_MASK) > Kernel::WINDOW_SIZE; current_sample += 2)
 	{
-	  -0.5f, 1.0f, -0.5f, 0.0f,
-	  1.5f, -2.5f, 0.0f, 1.0f,
-	  -1.5f, 2.0f, 0.5f, 0.0f,
-	  0.5f, -0.5f, 0.0f, 0.0f
-	};
-
-	const float x2 = m_fraction;		// x
-	const float x1 = x2*x2;          // x^2
-	const float x0 = x1*x2;          // x^3
-
-	float y0 = cubic_coef[0] * x0 + cubic_coef[1] * x1 + cubic_coef[2] * x2 + cubic_coef[3];
-	float y1 = cubic_coef[4] * x0 + cubic_coef[5] * x1 + cubic_coef[6] * x2 + cubic_coef[7];
-	float y2 = cubic_coef[8] * x0 + cubic_coef[9] * x1 + cubic_coef[10] * x2 + cubic_coef[11];
-	float y3 = cubic_coef[12] * x0 + cubic_coef[13] * x1 + cubic_coef[14] * x2 + cubic_coef[15];
-
-	*left_output = y0 * m_float_buffer[left_input_index & INDEX_MASK]
-		+ y1 * m_float_buffer[(left_input_index + 2) & INDEX_MASK]
-		+ y2 * m_float_buffer[(left_input_index + 4) & INDEX_MASK]
-		+ y3 * m_float_buffer[(left_input_index + 6) & INDEX_MASK];
-	*right_output = y0 * m_float_buffer[(left_input_index + 1) & INDEX_MASK]
-		+ y1 * m_float_buffer[(left_input_index + 3) & INDEX_MASK]
-		+ y2 * m_float_buffer[(left_input_index + 5) & INDEX_MASK]
-		+ y3 * m_float_buffer[(left_input_index + 7) & INDEX_MASK];
+		float output[2];
+		Kernel::Interpolate(&m_float_buffer[read_index & INDEX_MASK], fraction, output);
+		samples[current_sample + 1] += l_volume * output[0];
+		samples[current_sample] += r_volume * output[1];
+		fraction += ratio;
+		read_index += 2 * (s32)fraction;
+		fraction = fraction - (s32)fraction;
+	}
+	m_fraction = fraction;
+	return current_sample;
 }
 
 void CMixer::MixerFifo::Mix(float* samples, u32 numSamples, bool consider_framelimit)
 {
-	u32 current_sample = 0;
 	// Cache access in non-volatile variable so interpolation loop can be optimized
 	u32 read_index = m_read_index.load();
 	const u32 write_index = m_write_index.load();
+	const u32 input_sample_rate = m_input_sample_rate.load();
 	// Sync input rate by fifo size
 	float num_left = (float)(((write_index - read_index) & INDEX_MASK) / 2);
 	m_num_left_i = (num_left + m_num_left_i * (CONTROL_AVG - 1)) / CONTROL_AVG;
 
-	u32 low_waterwark = m_input_sample_rate * SConfig::GetInstance().iTimingVariance / 1000;
+	u32 low_waterwark = input_sample_rate * SConfig::GetInstance().iTimingVariance / 1000;
 	low_waterwark = std::min(low_waterwark, MAX_SAMPLES / 2);
 
 	float offset = (m_num_left_i - low_waterwark) * CONTROL_FACTOR;
 	offset = MathUtil::Clamp(offset, -MAX_FREQ_SHIFT, MAX_FREQ_SHIFT);
 	// adjust framerate with framelimit
 	float emulationspeed = SConfig::GetInstance().m_EmulationSpeed;
-	float aid_sample_rate = m_input_sample_rate + offset;
+	float aid_sample_rate = input_sample_rate + offset;
 	if (consider_framelimit && emulationspeed > 0.0f)
 	{
 		aid_sample_rate = aid_sample_rate * emulationspeed;
@@ -99,22 +219,29 @@ void CMixer::MixerFifo::Mix(float* samples, u32 numSamples, bool consider_framel
 	float ratio = aid_sample_rate / (float)m_mixer->m_sample_rate;
 	float l_volume = (float)m_lvolume.load() / 256.f;
 	float r_volume = (float)m_rvolume.load() / 256.f;
-	// for each output sample pair (left and right),
-	// linear interpolate between current and next sample
-	// increment output sample position
-	// increment input sample position by ratio, store fraction
-	// QUESTION: do we need to check for NUM_CROSSINGS samples before we interpolate?
-	// seems to work fine as is
-	for (; current_sample < numSamples * 2 && ((write_index - read_index) & INDEX_MASK) > GetWindowSize(); current_sample += 2)
+
+	ResamplerType resampler = m_resampler;
+	if (m_follow_config)
+		resampler = static_cast<ResamplerType>(SConfig::GetInstance().iAudioResampler);
+
+	u32 current_sample;
+	switch (resampler)
 	{
-		float l_output, r_output;
-		Interpolate(read_index, &l_output, &r_output);
-		samples[current_sample + 1] += l_volume * l_output;
-		samples[current_sample] += r_volume * r_output;
-		m_fraction += ratio;
-		read_index += 2 * (s32)m_fraction;
-		m_fraction = m_fraction - (s32)m_fraction;
+	case RESAMPLER_LINEAR:
+		current_sample = Resample<LinearKernel>(samples, numSamples, read_index, write_index, ratio,
+			l_volume, r_volume);
+		break;
+	case RESAMPLER_SINC:
+		current_sample = Resample<SincKernel>(samples, numSamples, read_index, write_index, ratio,
+			l_volume, r_volume);
+		break;
+	case RESAMPLER_CUBIC:
+	default:
+		current_sample = Resample<CubicKernel>(samples, numSamples, read_index, write_index, ratio,
+			l_volume, r_volume);
+		break;
 	}
+
 	// pad output if not enough input samples
 	float s[2];
 	s[0] = m_float_buffer[(read_index - 1) & INDEX_MASK] * r_volume;
@@ -130,7 +257,7 @@ void CMixer::MixerFifo::Mix(float* samples, u32 numSamples, bool consider_framel
 
 u32 CMixer::MixerFifo::AvailableSamples()
 {
-	return ((m_write_index.load() - m_read_index.load()) & INDEX_MASK) * 48000 / (2 * m_input_sample_rate);
+	return ((m_write_index.load() - m_read_index.load()) & INDEX_MASK) * 48000 / (2 * m_input_sample_rate.load());
 }
 
 u32 CMixer::AvailableSamples()
@@ -151,7 +278,6 @@ u32 CMixer::Mix(s16* samples, u32 num_samples, bool consider_framelimit)
 {
 	if (!samples)
 		return 0;
-	std::lock_guard<std::mutex> lk(m_cs_mixing);
 	// reset float output buffer
 	m_output_buffer.resize(num_samples * 2);
 	std::fill_n(m_output_buffer.begin(), num_samples * 2, 0.f);
@@ -159,14 +285,26 @@ u32 CMixer::Mix(s16* samples, u32 num_samples, bool consider_framelimit)
 	m_streaming_mixer.Mix(m_output_buffer.data(), num_samples, consider_framelimit);
 	m_wiimote_speaker_mixer.Mix(m_output_buffer.data(), num_samples, consider_framelimit);
 	// dither and clamp
-	for (u32 i = 0; i < num_samples * 2; i += 2)
+	u32 i = 0;
+#ifdef _M_X86
+	const __m128 scale = _mm_set1_ps(32768.0f);
+	const __m128 min = _mm_set1_ps(-32768.f);
+	const __m128 max = _mm_set1_ps(32767.f);
+	for (; i + 8 <= num_samples * 2; i += 8)
+	{
+		__m128 out0 = _mm_mul_ps(_mm_loadu_ps(&m_output_buffer[i]), scale);
+		__m128 out1 = _mm_mul_ps(_mm_loadu_ps(&m_output_buffer[i + 4]), scale);
+		out0 = _mm_min_ps(_mm_max_ps(out0, min), max);
+		out1 = _mm_min_ps(_mm_max_ps(out1, min), max);
+		_mm_storeu_si128((__m128i*)&samples[i],
+			_mm_packs_epi32(_mm_cvttps_epi32(out0), _mm_cvttps_epi32(out1)));
+	}
+#endif
+	for (; i < num_samples * 2; ++i)
 	{
-		float r_output = m_output_buffer[i] * 32768.0f;
-		float l_output = m_output_buffer[i + 1] * 32768.0f;
-		l_output = MathUtil::Clamp(l_output, -32768.f, 32767.f);
-		r_output = MathUtil::Clamp(r_output, -32768.f, 32767.f);
-		samples[i] = s16(r_output);
-		samples[i + 1] = s16(l_output);
+		float output = m_output_buffer[i] * 32768.0f;
+		output = MathUtil::Clamp(output, -32768.f, 32767.f);
+		samples[i] = s16(output);
 	}
 	return num_samples;
 }
@@ -175,7 +313,6 @@ u32 CMixer::Mix(float* samples, u32 num_samples, bool consider_framelimit)
 {
 	if (!samples)
 		return 0;
-	std::lock_guard<std::mutex> lk(m_cs_mixing);
 	memset(samples, 0, num_samples * 2 * sizeof(float));
 	m_dma_mixer.Mix(samples, num_samples, consider_framelimit);
 	m_streaming_mixer.Mix(samples, num_samples, consider_framelimit);
@@ -199,7 +336,11 @@ void CMixer::MixerFifo::PushSamples(const s16* samples, u32 num_samples)
 	// convert to float while copying to buffer
 	for (u32 i = 0; i < num_samples * 2; ++i)
 	{
-		m_float_buffer[(current_write_index + i) & INDEX_MASK] = Signed16ToFloat(Common::swap16(samples[i]));
+		u32 index = (current_write_index + i) & INDEX_MASK;
+		float sample = Signed16ToFloat(Common::swap16(samples[i]));
+		m_float_buffer[index] = sample;
+		if (index < FIFO_PADDING)
+			m_float_buffer[index + MAX_SAMPLES * 2] = sample;
 	}
 	m_write_index.fetch_add(num_samples * 2);
 	return;
@@ -211,6 +352,8 @@ void CMixer::PushSamples(const s16 *samples, u32 num_samples)
 	int sample_rate = m_dma_mixer.GetInputSampleRate();
 	if (m_log_dsp_audio)
 		g_wave_writer_dsp.AddStereoSamplesBE(samples, num_samples, sample_rate);
+	if (AudioCommon::SoundDumpCallback dump_samples = AudioCommon::GetSoundDumpCallback())
+		dump_samples(samples, num_samples, sample_rate);
 }
 
 void CMixer::PushStreamingSamples(const s16 *samples, u32 num_samples)
@@ -261,7 +404,7 @@ void CMixer::SetWiimoteSpeakerVolume(u32 lvolume, u32 rvolume)
 
 void CMixer::MixerFifo::SetInputSampleRate(u32 rate)
 {
-	m_input_sample_rate = rate;
+	m_input_sample_rate.store(rate);
 }
 
 void CMixer::MixerFifo::SetVolume(u32 lvolume, u32 rvolume)
@@ -352,5 +495,5 @@ void CMixer::StopLogDSPAudio()
 
 unsigned int CMixer::MixerFifo::GetInputSampleRate() const
 {
-	return m_input_sample_rate;
+	return m_input_sample_rate.load();
 }
\ No newline at end of file
@@ -7,7 +7,6 @@
 #include <atomic>
 #include <cstring>
 #include <array>
-#include <mutex>
 #include <vector>
 
 #include "AudioCommon/WaveFile.h"
@@ -26,6 +25,8 @@ public:
 
 	static const u32 MAX_SAMPLES = (1024 * 4); // 128 ms
 	static const u32 INDEX_MASK = MAX_SAMPLES * 2 - 1;
+	// Largest interpolation window, in floats (16 stereo samples for the sinc).
+	static const u32 FIFO_PADDING = 32;
 	static const float MAX_FREQ_SHIFT;
 	static const float CONTROL_FACTOR;
 	static const float CONTROL_AVG;
@@ -57,11 +58,6 @@ public:
 	void StartLogDSPAudio(const std::string& filename);
 	void StopLogDSPAudio();
 
-	std::mutex& MixerCritical()
-	{
-		return m_cs_mixing;
-	}
-
 	float GetCurrentSpeed() const
 	{
 		return m_speed.load();
@@ -72,12 +68,26 @@ public:
 	}
 
 protected:
+	// Interpolation used to resample the FIFOs to the output rate.
+	enum ResamplerType
+	{
+		RESAMPLER_LINEAR = 0,
+		RESAMPLER_CUBIC,
+		RESAMPLER_SINC,
+	};
+
+	// Single producer (emulation thread) / single consumer (audio thread) sample
+	// queue. Mixing never blocks on the producer: both sides only exchange the
+	// atomic read and write indices.
 	class MixerFifo
 	{
 	public:
-		MixerFifo(CMixer *mixer, unsigned sample_rate)
+		// With follow_config, the resampler is read from the config on every mix.
+		MixerFifo(CMixer *mixer, unsigned sample_rate, ResamplerType resampler, bool follow_config)
 			: m_mixer(mixer)
 			, m_input_sample_rate(sample_rate)
+			, m_resampler(resampler)
+			, m_follow_config(follow_config)
 			, m_write_index(0)
 			, m_read_index(0)
 			, m_lvolume(255)
@@ -88,8 +98,6 @@ protected:
 			srand((u32)time(nullptr));
 			m_float_buffer.fill(0.0f);
 		}
-		virtual u32 GetWindowSize() = 0;
-		virtual void Interpolate(u32 left_input_index, float* left_output, float* right_output) = 0;
 		void PushSamples(const s16* samples, u32 num_samples);
 		void Mix(float* samples, u32 numSamples, bool consider_framelimit = true);
 		void SetInputSampleRate(u32 rate);
@@ -98,10 +106,20 @@ protected:
 		void GetVolume(u32* lvolume, u32* rvolume) const;
 		u32 AvailableSamples();
 	protected:
+		// Resamples as many output samples as the FIFO content allows, returns
+		// the number of floats written to samples.
+		template <class Kernel>
+		u32 Resample(float* samples, u32 num_samples, u32& read_index, u32 write_index, float ratio,
+			float l_volume, float r_volume);
+
 		CMixer *m_mixer;
-		unsigned m_input_sample_rate;
+		std::atomic<u32> m_input_sample_rate;
+		const ResamplerType m_resampler;
+		const bool m_follow_config;
 
-		std::array<float, MAX_SAMPLES * 2> m_float_buffer;
+		// The first FIFO_PADDING floats are mirrored after the end of the ring, so
+		// that interpolation windows can always be read contiguously.
+		std::array<float, MAX_SAMPLES * 2 + FIFO_PADDING> m_float_buffer;
 
 		std::atomic<u32> m_write_index;
 		std::atomic<u32> m_read_index;
@@ -114,36 +132,12 @@ protected:
 		float m_fraction;
 	};
 
-	class LinearMixerFifo: public MixerFifo
-	{
-	public:
-		LinearMixerFifo(CMixer* mixer, u32 sample_rate): MixerFifo(mixer, sample_rate)
-		{}
-		void Interpolate(u32 left_input_index, float* left_output, float* right_output) override;
-		u32 GetWindowSize() override
-		{
-			return 4;
-		};
-	};
-
-	class CubicMixerFifo: public MixerFifo
-	{
-	public:
-		CubicMixerFifo(CMixer* mixer, u32 sample_rate): MixerFifo(mixer, sample_rate)
-		{}
-		void Interpolate(u32 left_input_index, float* left_output, float* right_output) override;
-		u32 GetWindowSize() override
-		{
-			return 8;
-		};
-	};
-
-	CubicMixerFifo m_dma_mixer;
-	CubicMixerFifo m_streaming_mixer;
+	MixerFifo m_dma_mixer;
+	MixerFifo m_streaming_mixer;
 
 	// Linear interpolation seems to be the best for Wiimote 3khz -> 48khz, for now.
 	// TODO: figure out why and make it work with the above FIR
-	LinearMixerFifo m_wiimote_speaker_mixer;
+	MixerFifo m_wiimote_speaker_mixer;
 
 	u32 m_sample_rate;
 
@@ -153,8 +147,6 @@ protected:
 	bool m_log_dtk_audio;
 	bool m_log_dsp_audio;
 
-	std::mutex m_cs_mixing;
-
 	std::atomic<float> m_speed; // Current rate of the emulation (1.0 = 100% speed)
 
 private:
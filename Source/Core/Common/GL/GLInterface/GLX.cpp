@@ -2,6 +2,8 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <iterator>
+#include <memory>
 #include <string>
 
 #include "Common/GL/GLInterface/GLX.h"
@@ -120,6 +122,7 @@ bool cInterfaceGLX::Create(void* window_handle, bool core)
 	{
 		ctx = glXCreateContextAttribs(dpy, fbconfig, 0, True, context_attribs);
 		XSync(dpy, False);
+		m_attribs.assign(std::begin(context_attribs), std::end(context_attribs));
 	}
 	if (core && (!ctx || s_glxError))
 	{
@@ -135,6 +138,7 @@ bool cInterfaceGLX::Create(void* window_handle, bool core)
 		s_glxError = false;
 		ctx = glXCreateContextAttribs(dpy, fbconfig, 0, True, context_attribs_33);
 		XSync(dpy, False);
+		m_attribs.assign(std::begin(context_attribs_33), std::end(context_attribs_33));
 	}
 	if (!ctx || s_glxError)
 	{
@@ -147,6 +151,7 @@ bool cInterfaceGLX::Create(void* window_handle, bool core)
 		s_glxError = false;
 		ctx = glXCreateContextAttribs(dpy, fbconfig, 0, True, context_attribs_legacy);
 		XSync(dpy, False);
+		m_attribs.assign(std::begin(context_attribs_legacy), std::end(context_attribs_legacy));
 	}
 	if (!ctx || s_glxError)
 	{
@@ -175,10 +180,79 @@ bool cInterfaceGLX::Create(void* window_handle, bool core)
 	return true;
 }
 
+bool cInterfaceGLX::Create(cInterfaceBase* main_context)
+{
+	cInterfaceGLX* glx_context = static_cast<cInterfaceGLX*>(main_context);
+
+	m_is_shared = true;
+	m_core = glx_context->m_core;
+	m_attribs = glx_context->m_attribs;
+	dpy = glx_context->dpy;
+	ctx = nullptr;
+
+	// The window config can't be used for pbuffers, pick one that can with the same format
+	int visual_attribs[] = { GLX_X_RENDERABLE,
+													True,
+													GLX_DRAWABLE_TYPE,
+													GLX_PBUFFER_BIT,
+													GLX_X_VISUAL_TYPE,
+													GLX_TRUE_COLOR,
+													GLX_RED_SIZE,
+													8,
+													GLX_GREEN_SIZE,
+													8,
+													GLX_BLUE_SIZE,
+													8,
+													GLX_DEPTH_SIZE,
+													0,
+													GLX_STENCIL_SIZE,
+													0,
+													None };
+	int fbcount = 0;
+	GLXFBConfig* fbc = glXChooseFBConfig(dpy, DefaultScreen(dpy), visual_attribs, &fbcount);
+	if (!fbc || !fbcount)
+	{
+		ERROR_LOG(VIDEO, "Failed to retrieve a pbuffer framebuffer config");
+		return false;
+	}
+	fbconfig = *fbc;
+	XFree(fbc);
+
+	s_glxError = false;
+	XErrorHandler oldHandler = XSetErrorHandler(&ctxErrorHandler);
+
+	ctx = glXCreateContextAttribs(dpy, fbconfig, glx_context->ctx, True, m_attribs.data());
+	XSync(dpy, False);
+	if (ctx && !s_glxError)
+	{
+		int pbuffer_attribs[] = { GLX_PBUFFER_WIDTH, 1, GLX_PBUFFER_HEIGHT, 1, None };
+		m_pbuffer = glXCreatePbuffer(dpy, fbconfig, pbuffer_attribs);
+		XSync(dpy, False);
+	}
+	XSetErrorHandler(oldHandler);
+
+	if (!ctx || !m_pbuffer || s_glxError)
+	{
+		ERROR_LOG(VIDEO, "Unable to create shared GL context.");
+		Shutdown();
+		return false;
+	}
+	win = m_pbuffer;
+	return true;
+}
+
+std::unique_ptr<cInterfaceBase> cInterfaceGLX::CreateSharedContext()
+{
+	std::unique_ptr<cInterfaceBase> context = std::make_unique<cInterfaceGLX>();
+	if (!context->Create(this))
+		return nullptr;
+	return context;
+}
+
 bool cInterfaceGLX::MakeCurrent()
 {
 	bool success = glXMakeCurrent(dpy, win, ctx);
-	if (success)
+	if (success && !m_is_shared)
 	{
 		// load this function based on the current bound context
 		glXSwapIntervalSGI =
@@ -195,6 +269,21 @@ bool cInterfaceGLX::ClearCurrent()
 // Close backend
 void cInterfaceGLX::Shutdown()
 {
+	if (m_is_shared)
+	{
+		// The display belongs to the main context
+		if (m_pbuffer)
+		{
+			glXDestroyPbuffer(dpy, m_pbuffer);
+			m_pbuffer = 0;
+		}
+		if (ctx)
+		{
+			glXDestroyContext(dpy, ctx);
+			ctx = nullptr;
+		}
+		return;
+	}
 	XWindow.DestroyXWindow();
 	if (ctx)
 	{
@@ -5,7 +5,9 @@
 #pragma once
 
 #include <GL/glx.h>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "Common/GL/GLInterface/X11_Util.h"
 #include "Common/GL/GLInterfaceBase.h"
@@ -18,6 +20,10 @@ private:
 	Window win;
 	GLXContext ctx;
 	GLXFBConfig fbconfig;
+	// attributes the context was created with, reused for shared contexts
+	std::vector<int> m_attribs;
+	// shared contexts have no window and render to a 1x1 pbuffer instead
+	GLXPbuffer m_pbuffer = 0;
 
 public:
 	friend class cX11Window;
@@ -25,6 +31,8 @@ public:
 	void Swap() override;
 	void* GetFuncAddress(const std::string& name) override;
 	bool Create(void* window_handle, bool core) override;
+	bool Create(cInterfaceBase* main_context) override;
+	std::unique_ptr<cInterfaceBase> CreateSharedContext() override;
 	bool MakeCurrent() override;
 	bool ClearCurrent() override;
 	void Shutdown() override;
@@ -28,4 +28,12 @@
 # endif
 #endif
 
+// Lets a single function use AVX2 intrinsics without building the whole file for it. Such
+// functions must only be called after checking cpu_info. MSVC emits any intrinsic anyway.
+#if defined(__GNUC__) || defined(__clang__)
+#  define FUNCTION_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#  define FUNCTION_TARGET_AVX2
+#endif
+
 #endif // _M_X86
@@ -2,11 +2,18 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <functional>
 #include <mbedtls/md5.h>
+#include <sstream>
 #include <string>
+#include <thread>
 
+#include "Common/CommonPaths.h"
+#include "Common/Event.h"
+#include "Common/FileUtil.h"
 #include "Common/MD5.h"
 #include "Common/StringUtil.h"
 #include "DiscIO/Blob.h"
@@ -49,4 +56,144 @@ std::string MD5Sum(const std::string& file_path, std::function<bool(int)> report
 
 	return output_string;
 }
-}
\ No newline at end of file
+
+// The tree hash is the MD5 of the MD5s of every block of this size. Each block can be read,
+// decompressed and hashed on its own, so the work is spread over several threads.
+static const u64 TREE_BLOCK_SIZE = 4 * 1024 * 1024;
+static const unsigned int TREE_MAX_THREADS = 8;
+static const int TREE_CACHE_VERSION = 1;
+
+static std::string DigestToString(const u8* digest)
+{
+	std::string output_string;
+	for (int i = 0; i < 16; ++i)
+		output_string += StringFromFormat("%02x", digest[i]);
+	return output_string;
+}
+
+static std::string GetTreeCachePath(const std::string& file_path)
+{
+	std::string file_name;
+	SplitPath(file_path, nullptr, &file_name, nullptr);
+
+	// Images with the same name can live in different folders
+	u8 path_digest[16];
+	mbedtls_md5(reinterpret_cast<const u8*>(file_path.data()), file_path.size(), path_digest);
+	return File::GetUserPath(D_CACHE_IDX) + "DiscHashes" DIR_SEP + file_name + "_" +
+		DigestToString(path_digest).substr(0, 16) + ".txt";
+}
+
+// The cached hash is only used if the image still has the same size and modification time
+static std::string ReadCachedTreeSum(const std::string& cache_path, u64 file_size, u64 mod_time)
+{
+	std::string contents;
+	if (!File::ReadFileToString(cache_path, contents))
+		return "";
+
+	std::istringstream stream(contents);
+	int version = 0;
+	u64 cached_size = 0, cached_time = 0;
+	std::string sum;
+	stream >> version >> cached_size >> cached_time >> sum;
+	if (!stream || version != TREE_CACHE_VERSION || cached_size != file_size || cached_time != mod_time)
+		return "";
+	return sum;
+}
+
+std::string TreeMD5Sum(const std::string& file_path, std::function<bool(int)> report_progress)
+{
+	const u64 file_size = File::GetSize(file_path);
+	const u64 mod_time = File::GetFileModTime(file_path);
+	const std::string cache_path = GetTreeCachePath(file_path);
+
+	std::string cached_sum = ReadCachedTreeSum(cache_path, file_size, mod_time);
+	if (!cached_sum.empty())
+	{
+		report_progress(100);
+		return cached_sum;
+	}
+
+	std::unique_ptr<DiscIO::IBlobReader> file(DiscIO::CreateBlobReader(file_path));
+	if (!file)
+		return "";
+
+	const u64 game_size = file->GetDataSize();
+	const u64 num_blocks = (game_size + TREE_BLOCK_SIZE - 1) / TREE_BLOCK_SIZE;
+	std::vector<std::array<u8, 16>> block_digests(num_blocks);
+
+	// Blob readers aren't thread-safe, so every thread gets its own
+	unsigned int num_threads = std::max(1u, std::min(std::thread::hardware_concurrency(), TREE_MAX_THREADS));
+	num_threads = static_cast<unsigned int>(std::max<u64>(1, std::min<u64>(num_threads, num_blocks)));
+	std::vector<std::unique_ptr<DiscIO::IBlobReader>> readers;
+	readers.push_back(std::move(file));
+	while (readers.size() < num_threads)
+	{
+		std::unique_ptr<DiscIO::IBlobReader> reader(DiscIO::CreateBlobReader(file_path));
+		if (!reader)
+			break;
+		readers.push_back(std::move(reader));
+	}
+
+	std::atomic<u64> next_block(0);
+	std::atomic<u64> blocks_done(0);
+	std::atomic<bool> stop(false);
+	Common::Event block_done_event;
+
+	std::vector<std::thread> threads;
+	for (auto& blob : readers)
+	{
+		threads.emplace_back([&, reader = blob.get()]() {
+			std::vector<u8> data(TREE_BLOCK_SIZE);
+			for (u64 block = next_block++; block < num_blocks && !stop; block = next_block++)
+			{
+				u64 offset = block * TREE_BLOCK_SIZE;
+				size_t read_size = static_cast<size_t>(std::min(TREE_BLOCK_SIZE, game_size - offset));
+				if (!reader->Read(offset, read_size, data.data()))
+				{
+					stop = true;
+				}
+				else
+				{
+					mbedtls_md5(data.data(), read_size, block_digests[block].data());
+					++blocks_done;
+				}
+				block_done_event.Set();
+			}
+		});
+	}
+
+	int last_progress = -1;
+	while (true)
+	{
+		u64 done = blocks_done;
+		int progress = num_blocks ? static_cast<int>(static_cast<float>(done) / static_cast<float>(num_blocks) * 100) : 100;
+		if (progress != last_progress)
+		{
+			last_progress = progress;
+			if (!report_progress(progress))
+				stop = true;
+		}
+		if (done == num_blocks || stop)
+			break;
+		block_done_event.Wait();
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	if (stop)
+		return "";
+
+	std::array<u8, 16> output;
+	mbedtls_md5(block_digests.empty() ? nullptr : block_digests[0].data(), block_digests.size() * 16,
+		output.data());
+	std::string output_string = DigestToString(output.data());
+
+	File::CreateFullPath(cache_path);
+	File::WriteStringToFile(StringFromFormat("%d %llu %llu %s\n", TREE_CACHE_VERSION,
+		static_cast<unsigned long long>(file_size), static_cast<unsigned long long>(mod_time),
+		output_string.c_str()), cache_path);
+
+	return output_string;
+}
+}
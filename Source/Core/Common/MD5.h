@@ -10,4 +10,8 @@
 namespace MD5
 {
 std::string MD5Sum(const std::string& file_name, std::function<bool(int)> progress);
+
+// Not the MD5 of the image, but the MD5 over the MD5s of its 4 MiB blocks. Those are hashed in
+// parallel, and the result is cached until the image's size or modification time change.
+std::string TreeMD5Sum(const std::string& file_name, std::function<bool(int)> progress);
 }
\ No newline at end of file
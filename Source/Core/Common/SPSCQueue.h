@@ -0,0 +1,74 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// a lockless, single reader, single writer ring buffer
+// unlike FifoQueue, all the storage is allocated up front, so pushing
+// and popping never allocate. Elements are reused, which also lets
+// containers keep their capacity between pushes.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+template <typename T, size_t Capacity>
+class SPSCQueue
+{
+	static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+		"SPSCQueue capacity must be a power of two");
+
+public:
+	u32 Size() const
+	{
+		return m_write_index.load(std::memory_order_acquire) -
+			m_read_index.load(std::memory_order_acquire);
+	}
+
+	bool Empty() const
+	{
+		return Size() == 0;
+	}
+
+	// called from the writer. Returns false if the queue is full.
+	bool Push(const T& t)
+	{
+		const u32 write_index = m_write_index.load(std::memory_order_relaxed);
+		if (write_index - m_read_index.load(std::memory_order_acquire) == Capacity)
+			return false;
+
+		m_data[write_index & (Capacity - 1)] = t;
+		m_write_index.store(write_index + 1, std::memory_order_release);
+		return true;
+	}
+
+	// called from the reader. Returns false if the queue is empty.
+	bool Pop(T& t)
+	{
+		const u32 read_index = m_read_index.load(std::memory_order_relaxed);
+		if (read_index == m_write_index.load(std::memory_order_acquire))
+			return false;
+
+		t = m_data[read_index & (Capacity - 1)];
+		m_read_index.store(read_index + 1, std::memory_order_release);
+		return true;
+	}
+
+	// called from the reader
+	void Clear()
+	{
+		m_read_index.store(m_write_index.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+private:
+	std::array<T, Capacity> m_data{};
+	// both only ever increase, the slot is the index modulo Capacity
+	std::atomic<u32> m_write_index{0};
+	std::atomic<u32> m_read_index{0};
+};
+}
@@ -1430,12 +1430,12 @@ static int GetVEXpp(u8 opPrefix)
 		return 0;
 }
 
-void XEmitter::WriteVEXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W, int extrabytes)
+void XEmitter::WriteVEXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W, int extrabytes, int L)
 {
 	int mmmmm = GetVEXmmmmm(op);
 	int pp = GetVEXpp(opPrefix);
-	// FIXME: we currently don't support 256-bit instructions, and "size" is not the vector size here
-	arg.WriteVEX(this, regOp1, regOp2, 0, pp, mmmmm, W);
+	// L selects 256-bit vectors, only the _ymm and 128-bit lane instructions set it
+	arg.WriteVEX(this, regOp1, regOp2, L, pp, mmmmm, W);
 	Write8(op & 0xFF);
 	arg.WriteRest(this, extrabytes, regOp1);
 }
@@ -1446,11 +1446,11 @@ void XEmitter::WriteVEXOp4(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, co
 	Write8((u8)regOp3 << 4);
 }
 
-void XEmitter::WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W, int extrabytes)
+void XEmitter::WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W, int extrabytes, int L)
 {
 	if (!cpu_info.bAVX)
 		PanicAlert("Trying to use AVX on a system that doesn't support it. Bad programmer.");
-	WriteVEXOp(opPrefix, op, regOp1, regOp2, arg, W, extrabytes);
+	WriteVEXOp(opPrefix, op, regOp1, regOp2, arg, W, extrabytes, L);
 }
 
 void XEmitter::WriteAVXOp4(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, X64Reg regOp3, int W)
@@ -1460,6 +1460,13 @@ void XEmitter::WriteAVXOp4(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, co
 	WriteVEXOp4(opPrefix, op, regOp1, regOp2, arg, regOp3, W);
 }
 
+void XEmitter::WriteAVX2Op(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W, int extrabytes, int L)
+{
+	if (!cpu_info.bAVX2)
+		PanicAlert("Trying to use AVX2 on a system that doesn't support it. Bad programmer.");
+	WriteVEXOp(opPrefix, op, regOp1, regOp2, arg, W, extrabytes, L);
+}
+
 void XEmitter::WriteFMA3Op(u8 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W)
 {
 	if (!cpu_info.bFMA)
@@ -1927,6 +1934,40 @@ void XEmitter::VPANDN(X64Reg regOp1, X64Reg regOp2, const OpArg& arg)   { WriteA
 void XEmitter::VPOR(X64Reg regOp1, X64Reg regOp2, const OpArg& arg)     { WriteAVXOp(0x66, 0xEB, regOp1, regOp2, arg); }
 void XEmitter::VPXOR(X64Reg regOp1, X64Reg regOp2, const OpArg& arg)    { WriteAVXOp(0x66, 0xEF, regOp1, regOp2, arg); }
 
+void XEmitter::VMOVD_xmm(X64Reg dest, const OpArg& arg)   { WriteAVXOp(0x66, 0x6E, dest, INVALID_REG, arg); }
+void XEmitter::VMOVQ_xmm(X64Reg dest, const OpArg& arg)   { WriteAVXOp(0xF3, 0x7E, dest, INVALID_REG, arg); }
+void XEmitter::VMOVDQU(X64Reg dest, const OpArg& arg)     { WriteAVXOp(0xF3, 0x6F, dest, INVALID_REG, arg); }
+void XEmitter::VMOVSS(const OpArg& arg, X64Reg regOp)     { WriteAVXOp(0xF3, sseMOVUPtoRM, regOp, INVALID_REG, arg); }
+void XEmitter::VMOVLPS(const OpArg& arg, X64Reg regOp)    { WriteAVXOp(0x00, sseMOVLPtoRM, regOp, INVALID_REG, arg); }
+void XEmitter::VMOVUPS(const OpArg& arg, X64Reg regOp)    { WriteAVXOp(0x00, sseMOVUPtoRM, regOp, INVALID_REG, arg); }
+void XEmitter::VZEROUPPER()
+{
+	if (!cpu_info.bAVX)
+		PanicAlert("Trying to use AVX on a system that doesn't support it. Bad programmer.");
+	Write8(0xC5);
+	Write8(0xF8);
+	Write8(0x77);
+}
+
+void XEmitter::VCVTDQ2PS_ymm(X64Reg dest, const OpArg& arg)                { WriteAVXOp(0x00, 0x5B, dest, INVALID_REG, arg, 0, 0, 1); }
+void XEmitter::VMULPS_ymm(X64Reg regOp1, X64Reg regOp2, const OpArg& arg)  { WriteAVXOp(0x00, sseMUL, regOp1, regOp2, arg, 0, 0, 1); }
+void XEmitter::VPSHUFB_ymm(X64Reg regOp1, X64Reg regOp2, const OpArg& arg) { WriteAVX2Op(0x66, 0x3800, regOp1, regOp2, arg, 0, 0, 1); }
+void XEmitter::VPSRAD_ymm(X64Reg dest, X64Reg src, u8 shift)
+{
+	WriteAVX2Op(0x66, 0x72, (X64Reg)4, dest, R(src), 0, 1, 1);
+	Write8(shift);
+}
+void XEmitter::VINSERTI128(X64Reg dest, X64Reg src, const OpArg& arg, u8 lane)
+{
+	WriteAVX2Op(0x66, 0x3A38, dest, src, arg, 0, 1, 1);
+	Write8(lane);
+}
+void XEmitter::VEXTRACTI128(const OpArg& arg, X64Reg src, u8 lane)
+{
+	WriteAVX2Op(0x66, 0x3A39, src, INVALID_REG, arg, 0, 1, 1);
+	Write8(lane);
+}
+
 void XEmitter::VFMADD132PS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg)    { WriteFMA3Op(0x98, regOp1, regOp2, arg); }
 void XEmitter::VFMADD213PS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg)    { WriteFMA3Op(0xA8, regOp1, regOp2, arg); }
 void XEmitter::VFMADD231PS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg)    { WriteFMA3Op(0xB8, regOp1, regOp2, arg); }
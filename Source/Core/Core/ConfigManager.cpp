@@ -278,6 +278,7 @@ void SConfig::SaveCoreSettings(IniFile &ini)
 	core->Set("TimeStretching", bTimeStretching);
 	core->Set("RSHACK", bRSHACK);
 	core->Set("Latency", iLatency);
+	core->Set("AudioResampler", iAudioResampler);
 	core->Set("ReduceTimingDispersion", bReduceTimingDispersion);
 	core->Set("SlippiOnlineDelay", m_slippiOnlineDelay);
 	core->Set("SlippiEnableSpectator", m_enableSpectator);
@@ -619,6 +620,7 @@ void SConfig::LoadCoreSettings(IniFile &ini)
 	core->Get("TimeStretching", &bTimeStretching, false);
 	core->Get("RSHACK", &bRSHACK, false);
 	core->Get("Latency", &iLatency, 0);
+	core->Get("AudioResampler", &iAudioResampler, 1);
 	core->Get("ReduceTimingDispersion", &bReduceTimingDispersion, false);
 	core->Get("SlippiEnableSpectator", &m_enableSpectator, true);
 	core->Get("SlippiSpectatorLocalPort", &m_spectator_local_port, 51441);
@@ -845,6 +847,7 @@ void SConfig::LoadDefaults()
 	bTimeStretching = false;
 	bRSHACK = false;
 	iLatency = 14;
+	iAudioResampler = 1;
 
 	iPosX = INT_MIN;
 	iPosY = INT_MIN;
@@ -175,6 +175,7 @@ struct SConfig : NonCopyable
 	bool bTimeStretching = false;
 	bool bRSHACK = false;
 	int iLatency = 14;
+	int iAudioResampler = 1; // 0: linear, 1: cubic, 2: windowed sinc
 
 	bool bRunCompareServer = false;
 	bool bRunCompareClient = false;
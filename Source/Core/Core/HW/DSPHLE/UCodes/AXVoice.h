@@ -12,9 +12,10 @@
 #error AXVoice.h included without specifying version
 #endif
 
-#include <functional>
+#include <cstring>
 
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/MathUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/DSP.h"
@@ -288,7 +289,11 @@ u16 AcceleratorGetSample()
 // We start getting samples not from sample 0, but 0.<curr_pos_frac>. This
 // avoids discontinuities in the audio stream, especially with very low ratios
 // which interpolate a lot of values between two "real" samples.
-u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count, s16* last_samples,
+//
+// This is the sample by sample version, only used for voices whose input does
+// not fit in a block (see ResampleBlock).
+template <typename InputCallback>
+u32 ResampleAudio(InputCallback input_callback, s16* output, u32 count, s16* last_samples,
 	u32 curr_pos, u32 ratio, int srctype, const s16* coeffs)
 {
 	int read_samples_count = 0;
@@ -403,6 +408,72 @@ u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count
 	return curr_pos;
 }
 
+// Maximum number of input samples that can be decoded ahead of resampling for
+// one frame of a voice. Voices needing more than that (very high ratios) are
+// resampled sample by sample instead.
+#define MAX_BLOCK_INPUT_SAMPLES (MAX_SAMPLES_PER_FRAME * 16)
+
+// Returns how many input samples are consumed by resampling <count> samples.
+// <curr_pos> must only contain a fractional part. Computed in 64 bits so that
+// ratios which would wrap curr_pos around simply end up too large for a block.
+u64 GetResampleInputCount(u32 count, u32 curr_pos, u32 ratio, int srctype)
+{
+	if (srctype == SRCTYPE_LINEAR || srctype == SRCTYPE_POLYPHASE)
+		return ((u64)curr_pos + (u64)count * ratio) >> 16;
+	return count;
+}
+
+// Same as ResampleAudio, but working on a block of already decoded samples.
+//
+// <input> is made of 4 history slots (filled from <last_samples> here)
+// followed by the GetResampleInputCount() input samples. Having the history
+// and the input contiguous means the read position of each output sample can
+// be computed directly instead of going through a circular buffer, so the
+// loops below have no loop-carried state besides the position.
+u32 ResampleBlock(s16* input, s16* output, u32 count, s16* last_samples, u32 curr_pos, u32 ratio,
+	int srctype, const s16* coeffs)
+{
+	memcpy(input, last_samples, 4 * sizeof(s16));
+
+	if (0)  // if (coeffs && srctype == SRCTYPE_POLYPHASE), see ResampleAudio.
+	{
+		for (u32 i = 0; i < count; ++i)
+		{
+			curr_pos += ratio;
+
+			const s16* t = &input[curr_pos >> 16];
+			const s16* c = &coeffs[((curr_pos & 0xFFFF) >> 9) << 2];
+
+			s64 samp = ((s64)t[0] * c[0] + (s64)t[1] * c[1] + (s64)t[2] * c[2] + (s64)t[3] * c[3]) >> 15;
+			output[i] = (s16)samp;
+		}
+	}
+	else if (srctype == SRCTYPE_LINEAR || srctype == SRCTYPE_POLYPHASE)
+	{
+		for (u32 i = 0; i < count; ++i)
+		{
+			curr_pos += ratio;
+
+			const s16* t = &input[curr_pos >> 16];
+			s32 curr_frac = curr_pos & 0xFFFF;
+
+			// With a null fraction this yields t[0] exactly, no need to special
+			// case it.
+			output[i] = (t[0] * (0x10000 - curr_frac) + t[1] * curr_frac) >> 16;
+		}
+	}
+	else  // SRCTYPE_NEAREST
+	{
+		memcpy(output, input + 4, count * sizeof(s16));
+		memcpy(last_samples, output + count - 4, 4 * sizeof(s16));
+		return curr_pos;
+	}
+
+	// The last four samples read are the new history.
+	memcpy(last_samples, &input[curr_pos >> 16], 4 * sizeof(s16));
+	return curr_pos & 0xFFFF;
+}
+
 // Read <count> input samples from ARAM, decoding and converting rate
 // if required.
 void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
@@ -412,9 +483,27 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 
 	if (coeffs)
 		coeffs += pb.coef_select * 0x200;
-	u32 curr_pos =
-		ResampleAudio([](u32) { return AcceleratorGetSample(); }, samples, count, pb.src.last_samples,
-			pb.src.cur_addr_frac, HILO_TO_32(pb.src.ratio), pb.src_type, coeffs);
+
+	u32 ratio = HILO_TO_32(pb.src.ratio);
+	u64 input_count = GetResampleInputCount(count, pb.src.cur_addr_frac, ratio, pb.src_type);
+
+	u32 curr_pos;
+	if (input_count <= MAX_BLOCK_INPUT_SAMPLES)
+	{
+		// Decode everything the resampler will need in one go, then resample
+		// from the decoded block.
+		s16 input[4 + MAX_BLOCK_INPUT_SAMPLES];
+		for (u32 i = 0; i < input_count; ++i)
+			input[4 + i] = AcceleratorGetSample();
+
+		curr_pos = ResampleBlock(input, samples, count, pb.src.last_samples, pb.src.cur_addr_frac,
+			ratio, pb.src_type, coeffs);
+	}
+	else
+	{
+		curr_pos = ResampleAudio([](u32) { return AcceleratorGetSample(); }, samples, count,
+			pb.src.last_samples, pb.src.cur_addr_frac, ratio, pb.src_type, coeffs);
+	}
 	pb.src.cur_addr_frac = (curr_pos & 0xFFFF);
 
 	// Update current position in the PB.
@@ -422,6 +511,57 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 	pb.audio_addr.cur_addr_lo = (u16)(cur_addr & 0xFFFF);
 }
 
+#ifdef _M_X86
+// Computes clamp((samples * volume) >> 15, -32767, 32767) on 8 samples at once,
+// each with its own volume.
+inline __m128i ScaleSamplesSSE2(__m128i samples, __m128i volume)
+{
+	// The volume is unsigned but _mm_mulhi_epi16 is a signed multiply: for
+	// volumes >= 0x8000 the high half of the product needs samples added back.
+	__m128i lo = _mm_mullo_epi16(samples, volume);
+	__m128i hi = _mm_add_epi16(_mm_mulhi_epi16(samples, volume),
+		_mm_and_si128(samples, _mm_srai_epi16(volume, 15)));
+
+	__m128i prod0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 15);
+	__m128i prod1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 15);
+
+	// Saturating pack handles the upper bound, the lower one is -32767.
+	return _mm_max_epi16(_mm_packs_epi32(prod0, prod1), _mm_set1_epi16(-32767));
+}
+
+// Volumes for the next 8 samples of a ramp. Volumes are 16 bits and wrap
+// around just like the scalar code does.
+inline __m128i RampVolumeSSE2(u16 volume, u16 volume_delta)
+{
+	return _mm_add_epi16(_mm_set1_epi16(volume),
+		_mm_mullo_epi16(_mm_set1_epi16(volume_delta), _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7)));
+}
+#endif
+
+// Scale samples in place with a ramped volume.
+void ApplyVolume(s16* samples, u32 count, u16& volume, u16 volume_delta)
+{
+	u32 i = 0;
+
+#ifdef _M_X86
+	__m128i vol = RampVolumeSSE2(volume, volume_delta);
+	const __m128i vol_step = _mm_set1_epi16(volume_delta * 8);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i s = _mm_loadu_si128((const __m128i*)&samples[i]);
+		_mm_storeu_si128((__m128i*)&samples[i], ScaleSamplesSSE2(s, vol));
+		vol = _mm_add_epi16(vol, vol_step);
+	}
+	volume += volume_delta * i;
+#endif
+
+	for (; i < count; ++i)
+	{
+		samples[i] = MathUtil::Clamp((samples[i] * volume) >> 15, -32767, 32767);  // -32768 ?
+		volume += volume_delta;
+	}
+}
+
 // Add samples to an output buffer, with optional volume ramping.
 void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
 {
@@ -434,7 +574,33 @@ void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ra
 	if (!ramp)
 		volume_delta = 0;
 
-	for (u32 i = 0; i < count; ++i)
+	u32 i = 0;
+
+#ifdef _M_X86
+	if (count >= 8)
+	{
+		__m128i vol = RampVolumeSSE2(volume, volume_delta);
+		const __m128i vol_step = _mm_set1_epi16(volume_delta * 8);
+		__m128i sample = _mm_setzero_si128();
+		for (; i + 8 <= count; i += 8)
+		{
+			sample = ScaleSamplesSSE2(_mm_loadu_si128((const __m128i*)&input[i]), vol);
+			vol = _mm_add_epi16(vol, vol_step);
+
+			// Sign extend to 32 bits before accumulating.
+			__m128i out0 = _mm_loadu_si128((const __m128i*)&out[i]);
+			__m128i out1 = _mm_loadu_si128((const __m128i*)&out[i + 4]);
+			out0 = _mm_add_epi32(out0, _mm_srai_epi32(_mm_unpacklo_epi16(sample, sample), 16));
+			out1 = _mm_add_epi32(out1, _mm_srai_epi32(_mm_unpackhi_epi16(sample, sample), 16));
+			_mm_storeu_si128((__m128i*)&out[i], out0);
+			_mm_storeu_si128((__m128i*)&out[i + 4], out1);
+		}
+		volume += volume_delta * i;
+		*dpop = (s16)_mm_extract_epi16(sample, 7);
+	}
+#endif
+
+	for (; i < count; ++i)
 	{
 		s64 sample = input[i];
 		sample *= volume;
@@ -471,12 +637,7 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 	GetInputSamples(pb, samples, count, coeffs);
 
 	// Apply a global volume ramp using the volume envelope parameters.
-	for (u32 i = 0; i < count; ++i)
-	{
-		samples[i] = MathUtil::Clamp(((s32)samples[i] * pb.vol_env.cur_volume) >> 15, -32767,
-			32767);  // -32768 ?
-		pb.vol_env.cur_volume += pb.vol_env.cur_volume_delta;
-	}
+	ApplyVolume(samples, count, pb.vol_env.cur_volume, pb.vol_env.cur_volume_delta);
 
 	// Optionally, execute a low pass filter
 	// TODO: LPF code is currently broken, causing Super Monkey Ball sound
@@ -552,9 +713,10 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 
 		// We use ratio 0x55555 == (5 * 65536 + 21845) / 65536 == 5.3333 which
 		// is the nearest we can get to 96/18
-		u32 curr_pos = ResampleAudio([&samples](u32 i) { return samples[i]; }, wm_samples, wm_count,
-			pb.remote_src.last_samples, pb.remote_src.cur_addr_frac, 0x55555,
-			SRCTYPE_POLYPHASE, coeffs);
+		s16 wm_input[4 + MAX_SAMPLES_PER_FRAME];
+		memcpy(wm_input + 4, samples, count * sizeof(s16));
+		u32 curr_pos = ResampleBlock(wm_input, wm_samples, wm_count, pb.remote_src.last_samples,
+			pb.remote_src.cur_addr_frac, 0x55555, SRCTYPE_POLYPHASE, coeffs);
 		pb.remote_src.cur_addr_frac = curr_pos & 0xFFFF;
 
 		// Mix to main[0-3] and aux[0-3]
@@ -2,7 +2,10 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <cinttypes>
+#include <cstring>
 #include <map>
 #include <mutex>
 #include <thread>
@@ -79,6 +82,52 @@ static Common::FifoQueue<ReadRequest, false> s_request_queue;
 static Common::FifoQueue<ReadResult, false> s_result_queue;
 static std::map<u64, ReadResult> s_result_map;
 
+// Read-ahead for sequential disc accesses. When the request queue runs dry, the
+// DVD thread reads a few aligned blocks past the end of every stream of
+// back-to-back reads, so the next request of that stream can be served from
+// memory. Blob readers aren't thread-safe, so all of this is done on the DVD
+// thread and only touched by others while it is stopped.
+// This only affects how fast the host gets the data; emulated timing is
+// still decided by ticks_until_completion.
+static const u64 PREFETCH_BLOCK_SIZE = 0x20000;
+static const size_t PREFETCH_CACHE_BLOCKS = 32;
+static const u64 PREFETCH_AHEAD_BLOCKS = 8;
+static const u32 PREFETCH_MIN_SEQUENTIAL_READS = 2;
+// DTK audio streaming and game reads are interleaved, so track a few streams.
+static const size_t MAX_READ_STREAMS = 4;
+
+struct PrefetchBlock
+{
+	u64 offset = 0;
+	bool decrypt = false;
+	bool valid = false;
+	bool used = false;
+	u64 last_use = 0;
+	std::vector<u8> data;
+};
+
+struct ReadStream
+{
+	u64 next_offset = 0;
+	bool decrypt = false;
+	u32 sequential_reads = 0;
+	u64 prefetched_until = 0;
+	u64 last_use = 0;
+};
+
+static std::array<PrefetchBlock, PREFETCH_CACHE_BLOCKS> s_prefetch_cache;
+static std::array<ReadStream, MAX_READ_STREAMS> s_read_streams;
+static u64 s_prefetch_tick;
+
+static u64 s_prefetch_hits;
+static u64 s_prefetch_misses;
+static u64 s_prefetch_wasted;
+
+static void ResetPrefetch();
+static bool ReadFromPrefetchCache(u64 offset, u32 length, bool decrypt, u8* out);
+static void TrackReadStream(u64 offset, u32 length, bool decrypt);
+static bool PrefetchNextBlock();
+
 void Start()
 {
 	s_finish_read = CoreTiming::RegisterEvent("FinishReadDVDThread", FinishRead);
@@ -92,12 +141,21 @@ void Start()
 	// much, because this will never get exposed to the emulated game.
 	s_next_id = 0;
 
+	s_prefetch_hits = 0;
+	s_prefetch_misses = 0;
+	s_prefetch_wasted = 0;
+
 	StartDVDThread();
 }
 
 static void StartDVDThread()
 {
 	_assert_(!s_dvd_thread.joinable());
+
+	// WaitUntilIdle restarts the thread whenever the volume or the partition
+	// changes, which also makes this the place to drop stale prefetched data.
+	ResetPrefetch();
+
 	s_dvd_thread_exiting.Clear();
 	s_dvd_thread = std::thread(DVDThread);
 }
@@ -105,6 +163,10 @@ static void StartDVDThread()
 void Stop()
 {
 	StopDVDThread();
+
+	INFO_LOG(DVDINTERFACE, "Read-ahead: %" PRIu64 " hits, %" PRIu64 " misses, "
+		"%" PRIu64 " prefetched blocks evicted unused.",
+		s_prefetch_hits, s_prefetch_misses, s_prefetch_wasted);
 }
 
 static void StopDVDThread()
@@ -263,13 +325,143 @@ static void FinishRead(u64 id, s64 cycles_late)
 		buffer);
 }
 
+static void ResetPrefetch()
+{
+	for (PrefetchBlock& block : s_prefetch_cache)
+		block.valid = false;
+	s_read_streams.fill(ReadStream());
+	s_prefetch_tick = 0;
+}
+
+static PrefetchBlock* FindPrefetchBlock(u64 offset, bool decrypt)
+{
+	for (PrefetchBlock& block : s_prefetch_cache)
+	{
+		if (block.valid && block.offset == offset && block.decrypt == decrypt)
+			return &block;
+	}
+	return nullptr;
+}
+
+static bool ReadFromPrefetchCache(u64 offset, u32 length, bool decrypt, u8* out)
+{
+	if (length == 0)
+		return false;
+
+	const u64 first_block = offset - offset % PREFETCH_BLOCK_SIZE;
+	const u64 end = offset + length;
+
+	// Only serve requests that are entirely cached, so that a request
+	// never mixes cached data with a second read from the volume.
+	for (u64 block_offset = first_block; block_offset < end; block_offset += PREFETCH_BLOCK_SIZE)
+	{
+		if (!FindPrefetchBlock(block_offset, decrypt))
+			return false;
+	}
+
+	for (u64 block_offset = first_block; block_offset < end; block_offset += PREFETCH_BLOCK_SIZE)
+	{
+		PrefetchBlock* block = FindPrefetchBlock(block_offset, decrypt);
+		const u64 copy_start = std::max(offset, block_offset);
+		const u64 copy_end = std::min(end, block_offset + PREFETCH_BLOCK_SIZE);
+		memcpy(out + (copy_start - offset), block->data.data() + (copy_start - block_offset),
+			static_cast<size_t>(copy_end - copy_start));
+		block->used = true;
+		block->last_use = ++s_prefetch_tick;
+	}
+	return true;
+}
+
+static void TrackReadStream(u64 offset, u32 length, bool decrypt)
+{
+	ReadStream* stream = nullptr;
+	for (ReadStream& candidate : s_read_streams)
+	{
+		if (candidate.sequential_reads != 0 && candidate.next_offset == offset &&
+			candidate.decrypt == decrypt)
+		{
+			stream = &candidate;
+			break;
+		}
+	}
+
+	if (stream)
+	{
+		++stream->sequential_reads;
+	}
+	else
+	{
+		stream = &*std::min_element(s_read_streams.begin(), s_read_streams.end(),
+			[](const ReadStream& a, const ReadStream& b) { return a.last_use < b.last_use; });
+		stream->decrypt = decrypt;
+		stream->sequential_reads = 1;
+		stream->prefetched_until = 0;
+	}
+
+	stream->next_offset = offset + length;
+	stream->last_use = ++s_prefetch_tick;
+}
+
+// Reads at most one block ahead of a sequential stream. Returns false
+// when there is nothing left to prefetch.
+static bool PrefetchNextBlock()
+{
+	if (!DVDInterface::VolumeIsValid())
+		return false;
+
+	for (ReadStream& stream : s_read_streams)
+	{
+		if (stream.sequential_reads < PREFETCH_MIN_SEQUENTIAL_READS)
+			continue;
+
+		const u64 window_start = stream.next_offset - stream.next_offset % PREFETCH_BLOCK_SIZE;
+		const u64 window_end = window_start + PREFETCH_AHEAD_BLOCKS * PREFETCH_BLOCK_SIZE;
+		u64 block_offset = std::max(stream.prefetched_until, window_start);
+
+		while (block_offset < window_end && FindPrefetchBlock(block_offset, stream.decrypt))
+			block_offset += PREFETCH_BLOCK_SIZE;
+		stream.prefetched_until = block_offset;
+		if (block_offset >= window_end)
+			continue;
+
+		PrefetchBlock& victim = *std::min_element(s_prefetch_cache.begin(), s_prefetch_cache.end(),
+			[](const PrefetchBlock& a, const PrefetchBlock& b) {
+				return !a.valid ? b.valid : (b.valid && a.last_use < b.last_use);
+			});
+		if (victim.valid && !victim.used)
+			++s_prefetch_wasted;
+
+		victim.data.resize(PREFETCH_BLOCK_SIZE);
+		victim.valid = DVDInterface::GetVolume().Read(block_offset, PREFETCH_BLOCK_SIZE,
+			victim.data.data(), stream.decrypt);
+		if (!victim.valid)
+		{
+			// Most likely the end of the disc. Stop following this stream.
+			stream.sequential_reads = 0;
+			return true;
+		}
+		victim.offset = block_offset;
+		victim.decrypt = stream.decrypt;
+		victim.used = false;
+		victim.last_use = ++s_prefetch_tick;
+
+		stream.prefetched_until = block_offset + PREFETCH_BLOCK_SIZE;
+		return true;
+	}
+
+	return false;
+}
+
 static void DVDThread()
 {
 	Common::SetCurrentThreadName("DVD thread");
 
+	bool prefetch_pending = false;
 	while (true)
 	{
-		s_request_queue_expanded.Wait();
+		// Only sleep once there is nothing left to read ahead.
+		if (!prefetch_pending)
+			s_request_queue_expanded.Wait();
 
 		if (s_dvd_thread_exiting.IsSet())
 			return;
@@ -278,9 +470,19 @@ static void DVDThread()
 		while (s_request_queue.Pop(request))
 		{
 			std::vector<u8> buffer(request.length);
-			const DiscIO::IVolume& volume = DVDInterface::GetVolume();
-			if (!volume.Read(request.dvd_offset, request.length, buffer.data(), request.decrypt))
-				buffer.resize(0);
+			if (ReadFromPrefetchCache(request.dvd_offset, request.length, request.decrypt,
+				buffer.data()))
+			{
+				++s_prefetch_hits;
+			}
+			else
+			{
+				++s_prefetch_misses;
+				const DiscIO::IVolume& volume = DVDInterface::GetVolume();
+				if (!volume.Read(request.dvd_offset, request.length, buffer.data(), request.decrypt))
+					buffer.resize(0);
+			}
+			TrackReadStream(request.dvd_offset, request.length, request.decrypt);
 
 			request.realtime_done_us = Common::Timer::GetTimeUs();
 
@@ -290,6 +492,9 @@ static void DVDThread()
 			if (s_dvd_thread_exiting.IsSet())
 				return;
 		}
+
+		// One block at a time, so that new requests never wait for more than one block.
+		prefetch_pending = PrefetchNextBlock();
 	}
 }
 }
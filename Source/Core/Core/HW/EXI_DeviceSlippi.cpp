@@ -1327,7 +1327,7 @@ void CEXISlippi::prepareFrameData(u8 *payload)
 		}
 	}
 
-	auto commSettings = g_replayComm->getSettings();
+	const auto &commSettings = g_replayComm->getSettings();
 	if (commSettings.rollbackDisplayMethod == "normal")
 	{
 		auto nextFrame = m_current_game->GetFrameAt(frameSeqIdx);
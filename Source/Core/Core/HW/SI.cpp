@@ -636,7 +636,7 @@ void UpdateDevices()
 		if(!NetPlay::IsNetPlayRunning())
 		{
 			for(int i = 0; i < 4; i++)
-				GCAdapter::Input(i);
+				GCAdapter::Input(i, nullptr, false);
 		}
 
 		// Pretend that there's always new data
@@ -5,6 +5,8 @@
 #include <algorithm>
 #include <array>
 #include <cctype>
+#include <condition_variable>
+#include <deque>
 #include <iterator>
 #include <mbedtls/config.h>
 #include <mbedtls/md.h>
@@ -19,6 +21,7 @@
 #include "Common/Hash.h"
 #include "Common/NandPaths.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
 #include "Common/Timer.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
@@ -88,9 +91,40 @@ static u8 s_language = static_cast<u8>(DiscIO::Language::LANGUAGE_UNKNOWN);
 static bool s_bRecordingFromSaveState = false;
 static bool s_bPolled = false;
 
-// s_InputDisplay is used by both CPU and GPU (is mutable).
+// The last input of every controller, kept by the CPU thread while the input display is
+// shown. The GPU thread only turns them into strings when it draws the display.
+struct InputDisplayState
+{
+	bool valid = false;
+	ControllerState pad;
+	std::array<u8, 32> report;
+	WiimoteEmu::ReportFeatures rptf;
+	int ext;
+	wiimote_key key;
+};
+// s_input_display is used by both CPU and GPU (is mutable).
 static std::mutex s_input_display_lock;
-static std::string s_InputDisplay[8];
+static InputDisplayState s_input_display[8];
+
+// Guards tmpInput against being reallocated or refilled while a recording is being saved.
+static std::mutex s_temp_input_lock;
+
+// Recordings are written to disk by a background thread, in batches, so that saving a state
+// or exporting a long recording doesn't stall the thread asking for it.
+struct DTMWriteJob
+{
+	std::string filename;
+	DTMHeader header;
+	std::vector<u8> input;
+	bool copy_state;
+};
+static const size_t DTM_WRITE_BATCH_SIZE = 1024 * 1024;
+static std::mutex s_dtm_write_lock;
+static std::condition_variable s_dtm_write_cv;
+static std::deque<DTMWriteJob> s_dtm_write_queue;
+static bool s_dtm_writing = false;
+static bool s_dtm_write_stop = false;
+static std::thread s_dtm_write_thread;
 
 static GCManipFunction gcmfunc = nullptr;
 static WiiManipFunction wiimfunc = nullptr;
@@ -151,33 +185,6 @@ static std::array<u8, 20> ConvertGitRevisionToBytes(const std::string& revision)
 	return revision_bytes;
 }
 
-// NOTE: GPU Thread
-std::string GetInputDisplay()
-{
-	if (!IsMovieActive())
-	{
-		s_controllers = 0;
-		for (int i = 0; i < 4; ++i)
-		{
-			if (SerialInterface::GetDeviceType(i) != SIDEVICE_NONE)
-				s_controllers |= (1 << i);
-			if (g_wiimote_sources[i] != WIIMOTE_SRC_NONE)
-				s_controllers |= (1 << (i + 4));
-		}
-	}
-
-	std::string input_display;
-	{
-		std::lock_guard<std::mutex> guard(s_input_display_lock);
-		for (int i = 0; i < 8; ++i)
-		{
-			if ((s_controllers & (1 << i)) != 0)
-				input_display += s_InputDisplay[i];
-		}
-	}
-	return input_display;
-}
-
 // NOTE: GPU Thread
 std::string GetRTCDisplay()
 {
@@ -247,8 +254,11 @@ void Init()
 	if (!tmpHeader.bFromSaveState || !IsPlayingInput())
 		Core::SetStateFileName("");
 
-	for (auto& disp : s_InputDisplay)
-		disp.clear();
+	{
+		std::lock_guard<std::mutex> guard(s_input_display_lock);
+		for (auto& disp : s_input_display)
+			disp.valid = false;
+	}
 
 	if (!IsMovieActive())
 	{
@@ -604,9 +614,11 @@ bool BeginRecordingInput(int controllers)
 
 	s_playMode = MODE_RECORDING;
 	s_author = SConfig::GetInstance().m_strMovieAuthor;
-	EnsureTmpInputSize(1);
-
-	s_currentByte = s_totalBytes = 0;
+	{
+		std::lock_guard<std::mutex> guard(s_temp_input_lock);
+		EnsureTmpInputSize(1);
+		s_currentByte = s_totalBytes = 0;
+	}
 
 	Core::UpdateWantDeterminism();
 
@@ -667,8 +679,8 @@ static std::string Analog1DToString(u8 v, const std::string& prefix, u8 range =
 	}
 }
 
-// NOTE: CPU Thread
-static void SetInputDisplayString(ControllerState padState, int controllerID)
+// NOTE: GPU Thread
+static std::string GetInputDisplayString(ControllerState padState, int controllerID)
 {
 	std::string display_str = StringFromFormat("P%d:", controllerID + 1);
 
@@ -701,23 +713,31 @@ static void SetInputDisplayString(ControllerState padState, int controllerID)
 	display_str += Analog2DToString(padState.AnalogStickX, padState.AnalogStickY, " ANA");
 	display_str += Analog2DToString(padState.CStickX, padState.CStickY, " C");
 
-	std::lock_guard<std::mutex> guard(s_input_display_lock);
-	s_InputDisplay[controllerID] = std::move(display_str);
+	return display_str;
 }
 
 // NOTE: CPU Thread
-static void SetWiiInputDisplayString(int remoteID, u8* const data,
+static void SetInputDisplayState(ControllerState padState, int controllerID)
+{
+	if (!SConfig::GetInstance().m_ShowInputDisplay)
+		return;
+
+	std::lock_guard<std::mutex> guard(s_input_display_lock);
+	s_input_display[controllerID].valid = true;
+	s_input_display[controllerID].pad = padState;
+}
+
+// NOTE: GPU Thread
+static std::string GetWiiInputDisplayString(int remoteID, const u8* const data,
 	const WiimoteEmu::ReportFeatures& rptf, int ext,
 	const wiimote_key key)
 {
-	int controllerID = remoteID + 4;
-
 	std::string display_str = StringFromFormat("R%d:", remoteID + 1);
 
-	u8* const coreData = rptf.core ? (data + rptf.core) : nullptr;
-	u8* const accelData = rptf.accel ? (data + rptf.accel) : nullptr;
-	u8* const irData = rptf.ir ? (data + rptf.ir) : nullptr;
-	u8* const extData = rptf.ext ? (data + rptf.ext) : nullptr;
+	const u8* const coreData = rptf.core ? (data + rptf.core) : nullptr;
+	const u8* const accelData = rptf.accel ? (data + rptf.accel) : nullptr;
+	const u8* const irData = rptf.ir ? (data + rptf.ir) : nullptr;
+	const u8* const extData = rptf.ext ? (data + rptf.ext) : nullptr;
 
 	if (coreData)
 	{
@@ -823,8 +843,59 @@ static void SetWiiInputDisplayString(int remoteID, u8* const data,
 		display_str += Analog2DToString(cc.rx1 | (cc.rx2 << 1) | (cc.rx3 << 3), cc.ry, " R-ANA", 31);
 	}
 
+	return display_str;
+}
+
+// NOTE: CPU Thread
+static void SetWiiInputDisplayState(int remoteID, const u8* const data,
+	const WiimoteEmu::ReportFeatures& rptf, int ext,
+	const wiimote_key key)
+{
+	if (!SConfig::GetInstance().m_ShowInputDisplay)
+		return;
+
 	std::lock_guard<std::mutex> guard(s_input_display_lock);
-	s_InputDisplay[controllerID] = std::move(display_str);
+	InputDisplayState& state = s_input_display[remoteID + 4];
+	state.valid = true;
+	std::copy_n(data, std::min<size_t>(rptf.size, state.report.size()), state.report.begin());
+	state.rptf = rptf;
+	state.ext = ext;
+	state.key = key;
+}
+
+// NOTE: GPU Thread
+std::string GetInputDisplay()
+{
+	if (!IsMovieActive())
+	{
+		s_controllers = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (SerialInterface::GetDeviceType(i) != SIDEVICE_NONE)
+				s_controllers |= (1 << i);
+			if (g_wiimote_sources[i] != WIIMOTE_SRC_NONE)
+				s_controllers |= (1 << (i + 4));
+		}
+	}
+
+	InputDisplayState states[8];
+	{
+		std::lock_guard<std::mutex> guard(s_input_display_lock);
+		std::copy(std::begin(s_input_display), std::end(s_input_display), std::begin(states));
+	}
+
+	std::string input_display;
+	for (int i = 0; i < 8; ++i)
+	{
+		if ((s_controllers & (1 << i)) == 0 || !states[i].valid)
+			continue;
+		if (i < 4)
+			input_display += GetInputDisplayString(states[i].pad, i);
+		else
+			input_display += GetWiiInputDisplayString(i - 4, states[i].report.data(), states[i].rptf,
+				states[i].ext, states[i].key);
+	}
+	return input_display;
 }
 
 // NOTE: CPU Thread
@@ -858,7 +929,7 @@ void CheckPadStatus(GCPadStatus* PadStatus, int controllerID)
 	s_padState.reset = s_bReset;
 	s_bReset = false;
 
-	SetInputDisplayString(s_padState, controllerID);
+	SetInputDisplayState(s_padState, controllerID);
 }
 
 // NOTE: CPU Thread
@@ -869,6 +940,7 @@ void RecordInput(GCPadStatus* PadStatus, int controllerID)
 
 	CheckPadStatus(PadStatus, controllerID);
 
+	std::lock_guard<std::mutex> guard(s_temp_input_lock);
 	EnsureTmpInputSize((size_t)(s_currentByte + 8));
 	memcpy(&(tmpInput[s_currentByte]), &s_padState, 8);
 	s_currentByte += 8;
@@ -879,7 +951,7 @@ void RecordInput(GCPadStatus* PadStatus, int controllerID)
 void CheckWiimoteStatus(int wiimote, u8* data, const WiimoteEmu::ReportFeatures& rptf, int ext,
 	const wiimote_key key)
 {
-	SetWiiInputDisplayString(wiimote, data, rptf, ext, key);
+	SetWiiInputDisplayState(wiimote, data, rptf, ext, key);
 
 	if (IsRecordingInput())
 		RecordWiimote(wiimote, data, rptf.size);
@@ -891,6 +963,7 @@ void RecordWiimote(int wiimote, u8* data, u8 size)
 		return;
 
 	InputUpdate();
+	std::lock_guard<std::mutex> guard(s_temp_input_lock);
 	EnsureTmpInputSize((size_t)(s_currentByte + size + 1));
 	tmpInput[s_currentByte++] = size;
 	memcpy(&(tmpInput[s_currentByte]), data, size);
@@ -942,6 +1015,8 @@ bool PlayInput(const std::string& filename)
 	if (s_playMode != MODE_NONE)
 		return false;
 
+	FlushRecording();
+
 	if (!File::Exists(filename))
 		return false;
 
@@ -975,10 +1050,13 @@ bool PlayInput(const std::string& filename)
 
 	Core::UpdateWantDeterminism();
 
-	s_totalBytes = g_recordfd.GetSize() - 256;
-	EnsureTmpInputSize((size_t)s_totalBytes);
-	g_recordfd.ReadArray(tmpInput, (size_t)s_totalBytes);
-	s_currentByte = 0;
+	{
+		std::lock_guard<std::mutex> guard(s_temp_input_lock);
+		s_totalBytes = g_recordfd.GetSize() - 256;
+		EnsureTmpInputSize((size_t)s_totalBytes);
+		g_recordfd.ReadArray(tmpInput, (size_t)s_totalBytes);
+		s_currentByte = 0;
+	}
 	g_recordfd.Close();
 
 	// Load savestate (and skip to frame data)
@@ -1010,6 +1088,8 @@ void DoState(PointerWrap& p)
 // NOTE: Host Thread
 void LoadInput(const std::string& filename)
 {
+	FlushRecording();
+
 	File::IOFile t_record;
 	if (!t_record.Open(filename, "r+b"))
 	{
@@ -1059,6 +1139,7 @@ void LoadInput(const std::string& filename)
 		s_totalInputCount = tmpHeader.inputCount;
 		s_totalTickCount = s_tickCountAtLastInput = tmpHeader.tickCount;
 
+		std::lock_guard<std::mutex> guard(s_temp_input_lock);
 		EnsureTmpInputSize((size_t)totalSavedBytes);
 		s_totalBytes = totalSavedBytes;
 		t_record.ReadArray(tmpInput, (size_t)s_totalBytes);
@@ -1280,7 +1361,7 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
 	if (s_padState.reset)
 		ProcessorInterface::ResetButton_Tap();
 
-	SetInputDisplayString(s_padState, controllerID);
+	SetInputDisplayState(s_padState, controllerID);
 	CheckInputEnd();
 }
 
@@ -1370,12 +1451,74 @@ void EndPlayInput(bool cont)
 	}
 }
 
+static void WriteRecording(const DTMWriteJob& job)
+{
+	File::IOFile save_record(job.filename, "wb");
+	bool success = save_record.WriteArray(&job.header, 1);
+
+	for (size_t offset = 0; success && offset < job.input.size(); offset += DTM_WRITE_BATCH_SIZE)
+	{
+		success = save_record.WriteBytes(&job.input[offset],
+			std::min(DTM_WRITE_BATCH_SIZE, job.input.size() - offset));
+	}
+	save_record.Close();
+
+	if (success && job.copy_state)
+	{
+		std::string stateFilename = job.filename + ".sav";
+		success = File::Copy(File::GetUserPath(D_STATESAVES_IDX) + "dtm.sav", stateFilename);
+	}
+
+	if (success)
+		Core::DisplayMessage(StringFromFormat("DTM %s saved", job.filename.c_str()), 2000);
+	else
+		Core::DisplayMessage(StringFromFormat("Failed to save %s", job.filename.c_str()), 2000);
+}
+
+// NOTE: DTM Writer Thread
+static void RecordingWriterThread()
+{
+	Common::SetCurrentThreadName("DTM writer");
+
+	std::unique_lock<std::mutex> lock(s_dtm_write_lock);
+	while (true)
+	{
+		s_dtm_write_cv.wait(lock, [] { return !s_dtm_write_queue.empty() || s_dtm_write_stop; });
+		if (s_dtm_write_queue.empty())
+			return;
+
+		DTMWriteJob job = std::move(s_dtm_write_queue.front());
+		s_dtm_write_queue.pop_front();
+		s_dtm_writing = true;
+		lock.unlock();
+
+		WriteRecording(job);
+
+		lock.lock();
+		s_dtm_writing = false;
+		s_dtm_write_cv.notify_all();
+	}
+}
+
+// Writes out everything still queued, then stops the writer thread
+static void StopRecordingWriter()
+{
+	{
+		std::lock_guard<std::mutex> guard(s_dtm_write_lock);
+		s_dtm_write_stop = true;
+		s_dtm_write_cv.notify_all();
+	}
+	if (s_dtm_write_thread.joinable())
+		s_dtm_write_thread.join();
+}
+
 // NOTE: Save State + Host Thread
 void SaveRecording(const std::string& filename)
 {
-	File::IOFile save_record(filename, "wb");
-	// Create the real header now and write it
-	DTMHeader header;
+	// Create the real header now, the writer thread writes it
+	DTMWriteJob job;
+	job.filename = filename;
+	DTMHeader& header = job.header;
 	memset(&header, 0, sizeof(DTMHeader));
 
 	header.filetype[0] = 'D';
@@ -1427,20 +1570,27 @@ void SaveRecording(const std::string& filename)
 	header.uniqueID = 0;
 	// header.audioEmulator;
 
-	save_record.WriteArray(&header, 1);
-
-	bool success = save_record.WriteArray(tmpInput, (size_t)s_totalBytes);
+	job.copy_state = s_bRecordingFromSaveState;
+	{
+		std::lock_guard<std::mutex> guard(s_temp_input_lock);
+		job.input.assign(tmpInput, tmpInput + s_totalBytes);
+	}
 
-	if (success && s_bRecordingFromSaveState)
+	std::lock_guard<std::mutex> guard(s_dtm_write_lock);
+	if (!s_dtm_write_thread.joinable())
 	{
-		std::string stateFilename = filename + ".sav";
-		success = File::Copy(File::GetUserPath(D_STATESAVES_IDX) + "dtm.sav", stateFilename);
+		s_dtm_write_stop = false;
+		s_dtm_write_thread = std::thread(RecordingWriterThread);
 	}
+	s_dtm_write_queue.push_back(std::move(job));
+	s_dtm_write_cv.notify_all();
+}
 
-	if (success)
-		Core::DisplayMessage(StringFromFormat("DTM %s saved", filename.c_str()), 2000);
-	else
-		Core::DisplayMessage(StringFromFormat("Failed to save %s", filename.c_str()), 2000);
+// NOTE: Any thread
+void FlushRecording()
+{
+	std::unique_lock<std::mutex> lock(s_dtm_write_lock);
+	s_dtm_write_cv.wait(lock, [] { return s_dtm_write_queue.empty() && !s_dtm_writing; });
 }
 
 void SetGCInputManip(GCManipFunction func)
@@ -1574,6 +1724,9 @@ void GetMD5()
 // NOTE: EmuThread
 void Shutdown()
 {
+	StopRecordingWriter();
+
+	std::lock_guard<std::mutex> guard(s_temp_input_lock);
 	s_currentInputCount = s_totalInputCount = s_totalFrames = s_totalBytes = s_tickCountAtLastInput =
 		0;
 	delete[] tmpInput;
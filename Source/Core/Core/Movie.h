@@ -170,6 +170,8 @@ bool PlayWiimote(int wiimote, u8* data, const struct WiimoteEmu::ReportFeatures&
 	const wiimote_key key);
 void EndPlayInput(bool cont);
 void SaveRecording(const std::string& filename);
+// SaveRecording writes on a background thread, this waits for everything queued to be on disk
+void FlushRecording();
 void DoState(PointerWrap& p);
 void CheckMD5();
 void GetMD5();
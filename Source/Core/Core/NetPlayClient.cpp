@@ -8,16 +8,19 @@
 #include <mbedtls/md5.h>
 #include <memory>
 #include <thread>
+#include <xxhash.h>
 #include "Common/Common.h"
 #include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
 #include "Common/ENetUtil.h"
 #include "Common/MD5.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
 #include "Common/Timer.h"
 #include "Core/Core.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/EXI_DeviceIPL.h"
+#include "Core/HW/Memmap.h"
 #include "Core/HW/SI.h"
 #include "Core/HW/SI_DeviceGCController.h"
 #include "Core/HW/Sram.h"
@@ -25,8 +28,10 @@
 #include "Core/HW/WiimoteReal/WiimoteReal.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_usb_bt_emu.h"
 #include "Core/Movie.h"
+#include "Core/PowerPC/PowerPC.h"
 #include "InputCommon/GCAdapter.h"
 #include "InputCommon/InputStabilizer.h"
+#include "VideoCommon/Fifo.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -259,6 +264,70 @@ void NetPlayClient::SetLocalPlayerBuffer(u32 buffer)
 	dialog->OnPlayerPadBufferChanged(local_player->buffer);
 }
 
+// Hashing all of RAM every frame would cost too much, so every frame only one slice of it
+//  is hashed, in rotation. A full pass over MEM1 takes 96 frames.
+static const u32 DESYNC_HASH_REGION_SIZE = 0x40000;
+// Whole regions only, the rest of MEM1 is left out
+static const u32 DESYNC_MEM1_SIZE = Memory::REALRAM_SIZE / DESYNC_HASH_REGION_SIZE * DESYNC_HASH_REGION_SIZE;
+
+static u32 GetDesyncRegionCount()
+{
+	u32 count = DESYNC_MEM1_SIZE / DESYNC_HASH_REGION_SIZE;
+	if (SConfig::GetInstance().bWii)
+		count += Memory::EXRAM_SIZE / DESYNC_HASH_REGION_SIZE;
+	return count;
+}
+
+static u64 HashDesyncRegion(u32 region)
+{
+	const u32 mem1_regions = DESYNC_MEM1_SIZE / DESYNC_HASH_REGION_SIZE;
+	const u8* data;
+	if (region < mem1_regions)
+		data = Memory::m_pRAM + region * DESYNC_HASH_REGION_SIZE;
+	else
+		data = Memory::m_pEXRAM + (region - mem1_regions) * DESYNC_HASH_REGION_SIZE;
+	return XXH64(data, DESYNC_HASH_REGION_SIZE);
+}
+
+// The GPU thread writes EFB and XFB copies to RAM on its own schedule in dual core, so RAM
+// only matches between players once the GPU caught up with the CPU. That's always the case
+// in single core, and can be forced with the deterministic GPU thread.
+static bool SyncGPUForDesyncHash()
+{
+	if (!SConfig::GetInstance().bCPUThread)
+		return true;
+	if (!Fifo::UseDeterministicGPUThread())
+		return false;
+	Fifo::SyncGPU(Fifo::SyncGPUReason::Other);
+	return true;
+}
+
+static std::string DescribeDesyncRegion(u32 region)
+{
+	const u32 mem1_regions = DESYNC_MEM1_SIZE / DESYNC_HASH_REGION_SIZE;
+	if (region < mem1_regions)
+	{
+		u32 start = 0x80000000 + region * DESYNC_HASH_REGION_SIZE;
+		return StringFromFormat("MEM1 %08x-%08x", start, start + DESYNC_HASH_REGION_SIZE - 1);
+	}
+	u32 start = 0x90000000 + (region - mem1_regions) * DESYNC_HASH_REGION_SIZE;
+	return StringFromFormat("MEM2 %08x-%08x", start, start + DESYNC_HASH_REGION_SIZE - 1);
+}
+
+static u64 HashCPUState()
+{
+	const PowerPC::PowerPCState& state = PowerPC::ppcState;
+	const u32 misc[] = {state.pc, state.msr, state.fpscr, state.xer_ca, state.xer_so_ov};
+	XXH64_state_t hash;
+	XXH64_reset(&hash, 0);
+	XXH64_update(&hash, state.gpr, sizeof(state.gpr));
+	XXH64_update(&hash, state.ps, sizeof(state.ps));
+	XXH64_update(&hash, state.cr_val, sizeof(state.cr_val));
+	XXH64_update(&hash, state.sr, sizeof(state.sr));
+	XXH64_update(&hash, misc, sizeof(misc));
+	return XXH64_digest(&hash);
+}
+
 // called from ---NETPLAY--- thread
 unsigned int NetPlayClient::OnData(sf::Packet& packet)
 {
@@ -364,7 +433,8 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 
 		// Trusting server for good map value (>=0 && <4)
 		// add to pad buffer
-		m_pad_buffer.at(map).Push(pad);
+		if (!m_pad_buffer.at(map).Push(pad))
+			ERROR_LOG(NETPLAY, "Pad buffer %d is full, dropping input", map);
 		m_gc_pad_event.Set();
 	}
 	break;
@@ -383,7 +453,8 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 
 		// Trusting server for good map value (>=0 && <4)
 		// add to Wiimote buffer
-		m_wiimote_buffer.at(map).Push(nw);
+		if (!m_wiimote_buffer.at(map).Push(nw))
+			ERROR_LOG(NETPLAY, "Wiimote buffer %d is full, dropping input", map);
 		m_wii_pad_event.Set();
 	}
 	break;
@@ -532,8 +603,20 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 	{
 		int pid_to_blame;
 		u32 frame;
+		u8 source;
+		u32 region;
 		packet >> pid_to_blame;
 		packet >> frame;
+		packet >> source;
+		packet >> region;
+
+		std::string what;
+		if (source == DESYNC_TIMEBASE)
+			what = "timebase";
+		else if (source == DESYNC_CPU_STATE)
+			what = "CPU registers";
+		else
+			what = DescribeDesyncRegion(region);
 
 		std::string player = "??";
 		std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
@@ -542,7 +625,7 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 			if (it != m_players.end())
 				player = it->second.name;
 		}
-		dialog->OnDesync(frame, player);
+		dialog->OnDesync(frame, player, what);
 	}
 	break;
 
@@ -752,6 +835,7 @@ void NetPlayClient::ThreadFunc()
 		if (m_traversal_client)
 			m_traversal_client->HandleResends();
 		net = enet_host_service(m_client, &netEvent, 250);
+		SendOutgoingPads();
 		while (!m_async_queue.Empty())
 		{
 			Send(*(m_async_queue.Front().get()));
@@ -895,13 +979,26 @@ void NetPlayClient::ReportFrameTimeToServer(float frame_time)
 // called from ---CPU--- thread
 void NetPlayClient::SendPadState(const int in_game_pad, const GCPadStatus& pad)
 {
-	auto spac = std::make_unique<sf::Packet>();
-	*spac << static_cast<MessageId>(NP_MSG_PAD_DATA);
-	*spac << static_cast<PadMapping>(in_game_pad);
-	*spac << pad.button << pad.analogA << pad.analogB << pad.stickX << pad.stickY << pad.substickX
-		<< pad.substickY << pad.triggerLeft << pad.triggerRight;
+	if (!m_outgoing_pads.Push(OutgoingPad{static_cast<PadMapping>(in_game_pad), pad}))
+		ERROR_LOG(NETPLAY, "Outgoing pad queue is full, dropping input");
+	ENetUtil::WakeupThread(m_client);
+}
 
-	SendAsync(std::move(spac));
+// called from ---NETPLAY--- thread
+void NetPlayClient::SendOutgoingPads()
+{
+	OutgoingPad outgoing;
+	while (m_outgoing_pads.Pop(outgoing))
+	{
+		const GCPadStatus& pad = outgoing.status;
+		m_pad_packet.clear();
+		m_pad_packet << static_cast<MessageId>(NP_MSG_PAD_DATA);
+		m_pad_packet << outgoing.in_game_pad;
+		m_pad_packet << pad.button << pad.analogA << pad.analogB << pad.stickX << pad.stickY
+			<< pad.substickX << pad.substickY << pad.triggerLeft << pad.triggerRight;
+
+		Send(m_pad_packet);
+	}
 }
 
 // called from ---CPU--- thread
@@ -1033,15 +1130,13 @@ void NetPlayClient::UpdateDevices()
 // called from ---NETPLAY--- thread
 void NetPlayClient::ClearBuffers()
 {
-	// clear pad buffers, Clear method isn't thread safe
+	// clear pad buffers, only safe while the game isn't reading them
 	for (unsigned int i = 0; i < 4; ++i)
 	{
-		while (m_pad_buffer[i].Size())
-			m_pad_buffer[i].Pop();
-
-		while (m_wiimote_buffer[i].Size())
-			m_wiimote_buffer[i].Pop();
+		m_pad_buffer[i].Clear();
+		m_wiimote_buffer[i].Clear();
 	}
+	m_outgoing_pads.Clear();
 }
 
 // called from ---NETPLAY--- thread
@@ -1173,7 +1268,12 @@ void NetPlayClient::SendNetPad(int pad_nb)
 
 				while (m_pad_buffer[ingame_pad].Size() <= BufferSizeForPort(ingame_pad) / (SConfig::GetInstance().iPollingMethod == POLLING_ONSIREAD ? buffer_accuracy : 1))
 				{
-					m_pad_buffer[ingame_pad].Push(status);
+					// The queue is bounded, a buffer setting past its capacity must not spin here
+					if (!m_pad_buffer[ingame_pad].Push(status))
+					{
+						ERROR_LOG(NETPLAY, "Pad buffer %d is full, not filling it further", ingame_pad);
+						break;
+					}
 					SendPadState(ingame_pad, status);
 				}
 			}
@@ -1203,7 +1303,12 @@ void NetPlayClient::SendNetPad(int pad_nb)
 
 				while (m_pad_buffer[pad_nb].Size() <= BufferSizeForPort(pad_nb) / (SConfig::GetInstance().iPollingMethod == POLLING_ONSIREAD ? buffer_accuracy : 1))
 				{
-					m_pad_buffer[pad_nb].Push(status);
+					// The queue is bounded, a buffer setting past its capacity must not spin here
+					if (!m_pad_buffer[pad_nb].Push(status))
+					{
+						ERROR_LOG(NETPLAY, "Pad buffer %d is full, not filling it further", pad_nb);
+						break;
+					}
 					SendPadState(pad_nb, status);
 				}
 			}
@@ -1225,7 +1330,11 @@ bool NetPlayClient::WiimoteUpdate(int _number, u8* data, const u8 size, u8 repor
 			do
 			{
 				// add to buffer
-				m_wiimote_buffer[_number].Push(nw);
+				if (!m_wiimote_buffer[_number].Push(nw))
+				{
+					ERROR_LOG(NETPLAY, "Wiimote buffer %d is full, not filling it further", _number);
+					break;
+				}
 
 				SendWiimoteState(_number, nw);
 			} while (m_wiimote_buffer[_number].Size() <=
@@ -1388,12 +1497,26 @@ void NetPlayClient::SendTimeBase()
 	std::lock_guard<std::mutex> lk(crit_netplay_client);
 
 	u64 timebase = SystemTimers::GetFakeTimeBase();
+	u32 frame = netplay_client->m_timebase_frame++;
+	u64 state_hash = HashCPUState();
+	u32 region = DESYNC_NO_MEMORY_REGION;
+	u64 memory_hash = 0;
+	if (SyncGPUForDesyncHash())
+	{
+		region = frame % GetDesyncRegionCount();
+		memory_hash = HashDesyncRegion(region);
+	}
 
 	auto spac = std::make_unique<sf::Packet>();
 	*spac << static_cast<MessageId>(NP_MSG_TIMEBASE);
 	*spac << static_cast<u32>(timebase);
-	*spac << static_cast<u32>(timebase << 32);
-	*spac << netplay_client->m_timebase_frame++;
+	*spac << static_cast<u32>(timebase >> 32);
+	*spac << frame;
+	*spac << static_cast<u32>(state_hash);
+	*spac << static_cast<u32>(state_hash >> 32);
+	*spac << region;
+	*spac << static_cast<u32>(memory_hash);
+	*spac << static_cast<u32>(memory_hash >> 32);
 
 	netplay_client->SendAsync(std::move(spac));
 }
@@ -1430,7 +1553,7 @@ void NetPlayClient::ComputeMD5(const std::string& file_identifier)
 	}
 
 	m_MD5_thread = std::thread([this, file]() {
-		std::string sum = MD5::MD5Sum(file, [&](int progress) {
+		std::string sum = MD5::TreeMD5Sum(file, [&](int progress) {
 			sf::Packet spac;
 			spac << static_cast<MessageId>(NP_MSG_MD5_PROGRESS);
 			spac << progress;
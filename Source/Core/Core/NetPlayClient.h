@@ -15,6 +15,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
 #include "Common/FifoQueue.h"
+#include "Common/SPSCQueue.h"
 #include "Common/TraversalClient.h"
 #include "Core/NetPlayProto.h"
 #include "InputCommon/GCPadStatus.h"
@@ -38,7 +39,7 @@ public:
 	virtual void OnMsgStopGame() = 0;
 	virtual void OnMinimumPadBufferChanged(u32 buffer) = 0;
 	virtual void OnPlayerPadBufferChanged(u32 buffer) = 0;
-	virtual void OnDesync(u32 frame, const std::string& player) = 0;
+	virtual void OnDesync(u32 frame, const std::string& player, const std::string& what) = 0;
 	virtual void OnConnectionLost() = 0;
 	virtual void OnTraversalError(int error) = 0;
 	virtual bool IsRecording() = 0;
@@ -166,8 +167,21 @@ protected:
 
 	Common::FifoQueue<std::unique_ptr<sf::Packet>, false> m_async_queue;
 
-	std::array<Common::FifoQueue<GCPadStatus>, 4> m_pad_buffer;
-	std::array<Common::FifoQueue<NetWiimote>, 4> m_wiimote_buffer;
+	// Room for far more than the largest pad buffer the UI allows
+	static constexpr size_t PAD_QUEUE_CAPACITY = 1024;
+
+	std::array<Common::SPSCQueue<GCPadStatus, PAD_QUEUE_CAPACITY>, 4> m_pad_buffer;
+	std::array<Common::SPSCQueue<NetWiimote, PAD_QUEUE_CAPACITY>, 4> m_wiimote_buffer;
+
+	// Local pad states on their way from the CPU thread to the netplay thread, which packs
+	//  them into m_pad_packet. That way sending pads never locks or allocates on the CPU thread.
+	struct OutgoingPad
+	{
+		PadMapping in_game_pad;
+		GCPadStatus status;
+	};
+	Common::SPSCQueue<OutgoingPad, PAD_QUEUE_CAPACITY> m_outgoing_pads;
+	sf::Packet m_pad_packet;
 
 	ENetHost* m_client = nullptr;
 	ENetPeer* m_server = nullptr;
@@ -203,6 +217,7 @@ private:
 
 	void UpdateDevices();
 	void SendPadState(int in_game_pad, const GCPadStatus& np);
+	void SendOutgoingPads();
 	void SendWiimoteState(int in_game_pad, const NetWiimote& nw);
 	unsigned int OnData(sf::Packet& packet);
 	void Send(sf::Packet& packet);
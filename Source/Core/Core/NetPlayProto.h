@@ -88,6 +88,20 @@ enum
 	NP_MSG_SYNC_GC_SRAM = 0xF0,
 };
 
+// What differed between players when the server reports a desync
+enum
+{
+	DESYNC_TIMEBASE = 0,
+	DESYNC_CPU_STATE = 1,
+	DESYNC_MEMORY = 2,
+};
+
+// Sent instead of a RAM slice when the memory couldn't be hashed consistently that frame
+enum : u32
+{
+	DESYNC_NO_MEMORY_REGION = 0xFFFFFFFF,
+};
+
 enum
 {
 	CON_ERR_SERVER_FULL = 1,
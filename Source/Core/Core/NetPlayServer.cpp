@@ -732,28 +732,47 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 	case NP_MSG_TIMEBASE:
 	{
 		u32 x, y, frame;
+		FrameDigest digest;
 		packet >> x;
 		packet >> y;
 		packet >> frame;
+		digest.timebase = x | ((u64)y << 32);
+		packet >> x;
+		packet >> y;
+		digest.state_hash = x | ((u64)y << 32);
+		packet >> digest.region;
+		packet >> x;
+		packet >> y;
+		digest.memory_hash = x | ((u64)y << 32);
 
 		if (m_desync_detected)
 			break;
 
-		u64 timebase = x | ((u64)y << 32);
-		std::vector<std::pair<PlayerId, u64>>& timebases = m_timebase_by_frame[frame];
-		timebases.emplace_back(player.pid, timebase);
-		if (timebases.size() >= m_players.size())
+		std::vector<std::pair<PlayerId, FrameDigest>>& digests = m_timebase_by_frame[frame];
+		digests.emplace_back(player.pid, digest);
+		if (digests.size() >= m_players.size())
 		{
 			// we have all records for this frame
 
-			if (!std::all_of(timebases.begin(), timebases.end(), [&](std::pair<PlayerId, u64> pair) {
-				return pair.second == timebases[0].second;
+			// Compare against a player that hashed memory, players that couldn't match any RAM
+			const FrameDigest* reference = &digests[0].second;
+			for (const auto& pair : digests)
+			{
+				if (pair.second.region != DESYNC_NO_MEMORY_REGION)
+				{
+					reference = &pair.second;
+					break;
+				}
+			}
+
+			if (!std::all_of(digests.begin(), digests.end(), [&](const std::pair<PlayerId, FrameDigest>& pair) {
+				return pair.second == *reference;
 			}))
 			{
 				int pid_to_blame = -1;
-				for (auto pair : timebases)
+				for (const auto& pair : digests)
 				{
-					if (std::all_of(timebases.begin(), timebases.end(), [&](std::pair<PlayerId, u64> other) {
+					if (std::all_of(digests.begin(), digests.end(), [&](const std::pair<PlayerId, FrameDigest>& other) {
 						return other.first == pair.first || other.second != pair.second;
 					}))
 					{
@@ -763,10 +782,26 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 					}
 				}
 
+				// Report the most basic thing that differs, a differing timebase
+				//  usually drags the CPU state and memory along with it
+				u8 source = DESYNC_MEMORY;
+				for (const auto& pair : digests)
+				{
+					if (pair.second.timebase != digests[0].second.timebase)
+					{
+						source = DESYNC_TIMEBASE;
+						break;
+					}
+					if (pair.second.state_hash != digests[0].second.state_hash)
+						source = DESYNC_CPU_STATE;
+				}
+
 				sf::Packet spac;
 				spac << (MessageId)NP_MSG_DESYNC_DETECTED;
 				spac << pid_to_blame;
 				spac << frame;
+				spac << source;
+				spac << reference->region;
 				SendToClients(spac);
 
 				m_desync_detected = true;
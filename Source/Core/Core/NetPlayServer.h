@@ -117,7 +117,26 @@ private:
 
 	std::map<PlayerId, Client> m_players;
 
-	std::unordered_map<u32, std::vector<std::pair<PlayerId, u64>>> m_timebase_by_frame;
+	// What every client reports about its emulated state at the end of a frame
+	struct FrameDigest
+	{
+		u64 timebase;
+		u64 state_hash;  // CPU registers
+		u32 region;      // Slice of RAM hashed this frame
+		u64 memory_hash;
+
+		// Memory is only compared when both players could hash it
+		bool operator==(const FrameDigest& other) const
+		{
+			if (timebase != other.timebase || state_hash != other.state_hash)
+				return false;
+			if (region == DESYNC_NO_MEMORY_REGION || other.region == DESYNC_NO_MEMORY_REGION)
+				return true;
+			return region == other.region && memory_hash == other.memory_hash;
+		}
+		bool operator!=(const FrameDigest& other) const { return !(*this == other); }
+	};
+	std::unordered_map<u32, std::vector<std::pair<PlayerId, FrameDigest>>> m_timebase_by_frame;
 	bool m_desync_detected;
 
 	struct
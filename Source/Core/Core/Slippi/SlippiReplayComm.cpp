@@ -1,13 +1,29 @@
 #include <cctype>
+#include <chrono>
 #include <memory>
 #include "SlippiReplayComm.h"
 #include "Common/CommonPaths.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/LogManager.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
 #include "Core/ConfigManager.h"
 
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// How often the comm file is stat'ed when inotify is unavailable, and how soon an
+// unreadable file is parsed again. Also bounds how long shutting down the watcher takes.
+static const std::chrono::milliseconds WATCH_POLL_INTERVAL(50);
+
 std::unique_ptr<SlippiReplayComm> g_replayComm;
 
+std::function<void(const SlippiReplayComm::WatchSettings &)> SlippiReplayComm::onGameLoaded;
+std::function<void()> SlippiReplayComm::onQueueEmpty;
+
 // https://stackoverflow.com/questions/216823/whats-the-best-way-to-trim-stdstring
 // trim from start (in place)
 static inline void ltrim(std::string &s)
@@ -33,11 +49,22 @@ SlippiReplayComm::SlippiReplayComm()
 	INFO_LOG(EXPANSIONINTERFACE, "SlippiReplayComm: Using playback config path: %s",
 	         SConfig::GetInstance().m_strSlippiInput.c_str());
 	configFilePath = SConfig::GetInstance().m_strSlippiInput.c_str();
+
+	// Parse once up front so that the first isNewReplay call sees the file as it is now,
+	// the watcher then only has to deal with changes
+	publish(parseFile());
 }
 
-SlippiReplayComm::~SlippiReplayComm() {}
+SlippiReplayComm::~SlippiReplayComm()
+{
+	if (!watcherThread.joinable())
+		return;
+	watcherRunning.Clear();
+	watcherWakeup.Set();
+	watcherThread.join();
+}
 
-SlippiReplayComm::CommSettings SlippiReplayComm::getSettings()
+const SlippiReplayComm::CommSettings &SlippiReplayComm::getSettings()
 {
 	return commFileSettings;
 }
@@ -89,6 +116,8 @@ void SlippiReplayComm::nextReplay()
 		if (!queueWasEmpty) std::cout << "[NO_GAME]" << std::endl;
 		queueWasEmpty = true;
 #endif
+		if (onQueueEmpty)
+			onQueueEmpty();
 		return;
 	}
 
@@ -132,6 +161,9 @@ std::unique_ptr<Slippi::SlippiGame> SlippiReplayComm::loadGame()
 		}
 
 		current = ws;
+
+		if (onGameLoaded)
+			onGameLoaded(ws);
 	}
 
 	return std::move(result);
@@ -139,22 +171,123 @@ std::unique_ptr<Slippi::SlippiGame> SlippiReplayComm::loadGame()
 
 void SlippiReplayComm::loadFile()
 {
-	// TODO: Consider even only checking file mod time every 250 ms or something? Not sure
-	// TODO: what the perf impact is atm
+	// Every Slippi device creates a comm, only playback ever polls it for replays. The watcher
+	// is started then, so that netplay sessions don't get a thread for a file they don't use.
+	if (!watcherThread.joinable())
+	{
+		watcherRunning.Set();
+		watcherThread = std::thread(&SlippiReplayComm::watchFile, this);
+	}
+
+	// Called every playback frame, so only take the lock if the watcher has something new
+	u32 generation = pendingGeneration.load(std::memory_order_acquire);
+	if (generation == loadedGeneration)
+		return;
+
+	std::lock_guard<std::mutex> lk(pendingMutex);
+	loadedGeneration = pendingGeneration.load(std::memory_order_relaxed);
+
+	auto queue = std::move(commFileSettings.queue);
+	commFileSettings = pendingFile.settings;
+	if (pendingFile.replaceQueue)
+		queueWasEmpty = false;
+	else
+		commFileSettings.queue = std::move(queue);
+}
+
+void SlippiReplayComm::publish(ParsedFile parsed)
+{
+	std::lock_guard<std::mutex> lk(pendingMutex);
+	pendingFile = std::move(parsed);
+	pendingGeneration.fetch_add(1, std::memory_order_release);
+}
 
-	u64 modTime = File::GetFileModTime(configFilePath);
-	if (modTime != 0 && modTime == configLastLoadModTime)
+void SlippiReplayComm::watchFile()
+{
+	Common::SetCurrentThreadName("Slippi Comm File Watcher");
+
+	bool retry = false;
+
+#ifdef __linux__
+	// Watch the directory rather than the file, so that files replaced by a rename are seen too
+	std::string dir, filename, extension;
+	SplitPath(configFilePath, &dir, &filename, &extension);
+	filename += extension;
+	if (dir.empty())
+		dir = ".";
+
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd >= 0 &&
+	    inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) >= 0)
 	{
-		// TODO: Maybe be smarter than just using mod time? Look for other things that would
-		// TODO: indicate that file has changed and needs to be reloaded?
+		alignas(struct inotify_event) char buffer[4096];
+		while (watcherRunning.IsSet())
+		{
+			pollfd pfd = {fd, POLLIN, 0};
+			bool changed = retry;
+			if (poll(&pfd, 1, (int)WATCH_POLL_INTERVAL.count()) > 0)
+			{
+				ssize_t len;
+				while ((len = read(fd, buffer, sizeof(buffer))) > 0)
+				{
+					for (char *ptr = buffer; ptr < buffer + len;)
+					{
+						const struct inotify_event *event = (const struct inotify_event *)ptr;
+						if (event->len && filename == event->name)
+							changed = true;
+						ptr += sizeof(struct inotify_event) + event->len;
+					}
+				}
+			}
+
+			if (changed)
+			{
+				ParsedFile parsed = parseFile();
+				// Only a file being written is worth retrying, not a missing one
+				retry = !parsed.valid && File::Exists(configFilePath);
+				publish(std::move(parsed));
+			}
+		}
+		close(fd);
 		return;
 	}
 
+	WARN_LOG(EXPANSIONINTERFACE, "SlippiReplayComm: inotify unavailable, polling comm file instead");
+	if (fd >= 0)
+		close(fd);
+#endif
+
+	// Mod times only have a resolution of one second, so compare sizes as well
+	u64 lastModTime = File::GetFileModTime(configFilePath);
+	u64 lastSize = lastModTime ? File::GetSize(configFilePath) : 0;
+	while (watcherRunning.IsSet())
+	{
+		watcherWakeup.WaitFor(WATCH_POLL_INTERVAL);
+
+		u64 modTime = File::GetFileModTime(configFilePath);
+		u64 size = modTime ? File::GetSize(configFilePath) : 0;
+		// A missing file only counts as a change when the previous poll still saw it
+		bool unchanged = modTime == 0 ? lastModTime == 0 :
+		                                !retry && modTime == lastModTime && size == lastSize;
+		if (unchanged)
+			continue;
+
+		lastModTime = modTime;
+		lastSize = size;
+
+		ParsedFile parsed = parseFile();
+		retry = !parsed.valid && modTime != 0;
+		publish(std::move(parsed));
+	}
+}
+
+SlippiReplayComm::ParsedFile SlippiReplayComm::parseFile()
+{
 	WARN_LOG(EXPANSIONINTERFACE, "File change detected in comm file: %s", configFilePath.c_str());
-	configLastLoadModTime = modTime;
 
-	// TODO: Maybe load file in a more intelligent way to save
-	// TODO: file operations
+	ParsedFile parsed;
+	CommSettings &settings = parsed.settings;
+
 	std::string commFileContents;
 	File::ReadFileToString(configFilePath, commFileContents);
 
@@ -162,16 +295,16 @@ void SlippiReplayComm::loadFile()
 	if (res.is_discarded() || !res.is_object())
 	{
 		// Happens if there is a parse error, I think?
-		commFileSettings.mode = "normal";
-		commFileSettings.replayPath = "";
-		commFileSettings.startFrame = Slippi::GAME_FIRST_FRAME;
-		commFileSettings.endFrame = INT_MAX;
-		commFileSettings.commandId = "";
-		commFileSettings.outputOverlayFiles = false;
-		commFileSettings.isRealTimeMode = false;
-		commFileSettings.shouldResync = true;
-		commFileSettings.rollbackDisplayMethod = "off";
-		commFileSettings.gameStation = "";
+		settings.mode = "normal";
+		settings.replayPath = "";
+		settings.startFrame = Slippi::GAME_FIRST_FRAME;
+		settings.endFrame = INT_MAX;
+		settings.commandId = "";
+		settings.outputOverlayFiles = false;
+		settings.isRealTimeMode = false;
+		settings.shouldResync = true;
+		settings.rollbackDisplayMethod = "off";
+		settings.gameStation = "";
 
 		if (res.is_string())
 		{
@@ -179,38 +312,39 @@ void SlippiReplayComm::loadFile()
 			// This is really only here because when developing it might be easier
 			// to just throw in a string instead of an object
 
-			commFileSettings.replayPath = res.get<std::string>();
+			settings.replayPath = res.get<std::string>();
+			parsed.valid = true;
 		}
 		else
 		{
 			WARN_LOG(EXPANSIONINTERFACE, "Comm file load error detected. Check file format");
 
-			// Reset in the case of read error. this fixes a race condition where file mod time changes but
-			// the file is not readable yet?
-			configLastLoadModTime = 0;
+			// Parse again soon in the case of read error. this fixes a race condition where file
+			// mod time changes but the file is not readable yet?
+			parsed.valid = false;
 		}
 
-		return;
+		return parsed;
 	}
 
 	// TODO: Support file with only path string
-	commFileSettings.mode = res.value("mode", "normal");
-	commFileSettings.replayPath = res.value("replay", "");
-	commFileSettings.startFrame = res.value("startFrame", Slippi::GAME_FIRST_FRAME);
-	commFileSettings.endFrame = res.value("endFrame", INT_MAX);
-	commFileSettings.commandId = res.value("commandId", "");
-	commFileSettings.outputOverlayFiles = res.value("outputOverlayFiles", false);
-	commFileSettings.isRealTimeMode = res.value("isRealTimeMode", false);
-	commFileSettings.shouldResync = res.value("shouldResync", true);
-	commFileSettings.rollbackDisplayMethod = res.value("rollbackDisplayMethod", "off");
-	commFileSettings.gameStation = res.value("gameStation", "");
-
-	if (commFileSettings.mode == "queue")
+	settings.mode = res.value("mode", "normal");
+	settings.replayPath = res.value("replay", "");
+	settings.startFrame = res.value("startFrame", Slippi::GAME_FIRST_FRAME);
+	settings.endFrame = res.value("endFrame", INT_MAX);
+	settings.commandId = res.value("commandId", "");
+	settings.outputOverlayFiles = res.value("outputOverlayFiles", false);
+	settings.isRealTimeMode = res.value("isRealTimeMode", false);
+	settings.shouldResync = res.value("shouldResync", true);
+	settings.rollbackDisplayMethod = res.value("rollbackDisplayMethod", "off");
+	settings.gameStation = res.value("gameStation", "");
+	parsed.valid = true;
+
+	if (settings.mode == "queue")
 	{
 		auto queue = res["queue"];
 		if (queue.is_array())
 		{
-			std::queue<WatchSettings>().swap(commFileSettings.queue);
 			int index = 0;
 			for (json::iterator it = queue.begin(); it != queue.end(); ++it)
 			{
@@ -223,10 +357,12 @@ void SlippiReplayComm::loadFile()
 				w.gameStation = el.value("gameStation", "");
 				w.index = index++;
 
-				commFileSettings.queue.push(w);
+				settings.queue.push(w);
 			};
 
-			queueWasEmpty = false;
+			parsed.replaceQueue = true;
 		}
 	}
+
+	return parsed;
 }
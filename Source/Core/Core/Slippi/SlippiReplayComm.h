@@ -1,8 +1,15 @@
 #pragma once
 
 #include <SlippiLib/SlippiGame.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
 #include <queue>
 #include <string>
+#include <thread>
+
+#include "Common/Event.h"
+#include "Common/Flag.h"
 
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
@@ -41,22 +48,47 @@ class SlippiReplayComm
 
 	WatchSettings current;
 
-	CommSettings getSettings();
+	const CommSettings &getSettings();
 	void nextReplay();
 	bool isNewReplay();
 	std::unique_ptr<Slippi::SlippiGame> loadGame();
 
+	// Optional hooks for frontends driving playback themselves, called on the CPU thread.
+	// onGameLoaded runs whenever a replay starts playing, onQueueEmpty whenever the
+	// game asks for the next replay of an exhausted queue.
+	static std::function<void(const WatchSettings &)> onGameLoaded;
+	static std::function<void()> onQueueEmpty;
+
   private:
+	// Comm file contents as parsed by the watcher thread
+	struct ParsedFile
+	{
+		CommSettings settings;
+		bool replaceQueue = false; // The queue is only replaced by a valid "queue" entry
+		bool valid = false;
+	};
+
 	void loadFile();
 	std::string getReplayPath();
 
+	ParsedFile parseFile();
+	void publish(ParsedFile parsed);
+	void watchFile();
+
 	std::string configFilePath;
-	json fileData;
 	std::string previousReplayLoaded;
 	std::string previousCommandId;
 	int previousIndex;
 
-	u64 configLastLoadModTime;
+	// The comm file is watched on its own thread, which only reparses it when it changes.
+	// The CPU thread picks up new settings in loadFile when the generation moves.
+	std::thread watcherThread;
+	Common::Flag watcherRunning;
+	Common::Event watcherWakeup;
+	std::mutex pendingMutex;
+	ParsedFile pendingFile;
+	std::atomic<u32> pendingGeneration{0};
+	u32 loadedGeneration = 0;
 
 	// Queue stuff
 	bool queueWasEmpty = true;
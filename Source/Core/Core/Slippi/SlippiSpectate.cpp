@@ -27,8 +27,7 @@ void SlippiSpectateServer::write(u8 *payload, u32 length)
 	{
 		return;
 	}
-	std::string str_payload((char *)payload, length);
-	m_event_queue.Push(str_payload);
+	m_event_queue.Push(QueuedEvent{SPECTATE_EVENT_GAME, std::string((char *)payload, length)});
 }
 
 // CALLED FROM DOLPHIN MAIN THREAD
@@ -38,10 +37,7 @@ void SlippiSpectateServer::startGame()
 	{
 		return;
 	}
-
-	json start_game_message;
-	start_game_message["type"] = "start_game";
-	m_event_queue.Push(start_game_message.dump());
+	m_event_queue.Push(QueuedEvent{SPECTATE_EVENT_START_GAME, ""});
 }
 
 // CALLED FROM DOLPHIN MAIN THREAD
@@ -51,96 +47,283 @@ void SlippiSpectateServer::endGame(bool dolphin_closed)
 	{
 		return;
 	}
-	json end_game_message;
-	end_game_message["type"] = "end_game";
-	end_game_message["dolphin_closed"] = dolphin_closed;
-	m_event_queue.Push(end_game_message.dump());
+	m_event_queue.Push(QueuedEvent{SPECTATE_EVENT_END_GAME, std::string(1, dolphin_closed ? 1 : 0)});
+}
+
+static std::string buildBinaryEvent(u8 type, u32 cursor, u32 next_cursor, const std::string &payload)
+{
+	std::string frame(SPECTATE_BINARY_HEADER_SIZE, '\0');
+	frame[0] = (char)type;
+	for (int i = 0; i < 4; i++)
+	{
+		frame[1 + i] = (char)(cursor >> (24 - i * 8));
+		frame[5 + i] = (char)(next_cursor >> (24 - i * 8));
+	}
+	frame.append(payload);
+	return frame;
+}
+
+static u32 readBinaryCursor(const std::string &frame, size_t offset)
+{
+	return ((u32)(u8)frame[offset] << 24) | ((u32)(u8)frame[offset + 1] << 16) |
+	       ((u32)(u8)frame[offset + 2] << 8) | (u32)(u8)frame[offset + 3];
+}
+
+// Legacy JSON message for an event in the binary framing
+static std::string buildJsonEvent(const char *frame, size_t length)
+{
+	if (length < SPECTATE_BINARY_HEADER_SIZE)
+	{
+		return "";
+	}
+
+	std::string binary(frame, length);
+	std::string payload = binary.substr(SPECTATE_BINARY_HEADER_SIZE);
+	json message;
+	switch ((u8)binary[0])
+	{
+	case SPECTATE_EVENT_GAME:
+		message["type"] = "game_event";
+		message["payload"] = base64::Base64::Encode(payload);
+		break;
+	case SPECTATE_EVENT_MENU:
+		// Menu events never had a cursor
+		message["type"] = "menu_event";
+		message["payload"] = base64::Base64::Encode(payload);
+		return message.dump();
+	case SPECTATE_EVENT_START_GAME:
+		message["type"] = "start_game";
+		break;
+	case SPECTATE_EVENT_END_GAME:
+		message["type"] = "end_game";
+		message["dolphin_closed"] = !payload.empty() && payload[0] != 0;
+		break;
+	}
+	message["cursor"] = readBinaryCursor(binary, 1);
+	message["next_cursor"] = readBinaryCursor(binary, 5);
+	return message.dump();
 }
 
 // CALLED FROM SERVER THREAD
-void SlippiSpectateServer::writeEvents(u16 peer_id)
+void SlippiSpectateLog::append(const std::string &frame)
 {
-	// Send menu events
-	if (!m_in_game && (m_sockets[peer_id]->m_menu_cursor != m_menu_cursor))
+	if (m_segments.empty() || m_segments.back()->data.size() + frame.size() > m_segments.back()->data.capacity())
 	{
-		ENetPacket *packet = enet_packet_create(m_menu_event.data(), m_menu_event.length(), ENET_PACKET_FLAG_RELIABLE);
-		// Batch for sending
-		enet_peer_send(m_sockets[peer_id]->m_peer, 0, packet);
-		// Record for the peer that it was sent
-		m_sockets[peer_id]->m_menu_cursor = m_menu_cursor;
+		std::shared_ptr<Segment> segment = std::make_shared<Segment>();
+		// Packets point into the data, so it must never reallocate
+		segment->data.reserve(std::max<size_t>(SPECTATE_LOG_SEGMENT_SIZE, frame.size()));
+		segment->first_index = end();
+		segment->bytes = segment->data.capacity();
+		m_bytes += segment->bytes;
+		m_segments.push_back(segment);
+		retireSegments();
 	}
 
-	// Send game events
-	// Loop through each event that needs to be sent
-	//  send all the events starting at their cursor
-	// If the client's cursor is beyond the end of the event buffer, then
-	//  it's probably left over from an old game. (Or is invalid anyway)
-	//  So reset it back to 0
-	if (m_sockets[peer_id]->m_cursor > m_event_buffer.size())
+	Segment *segment = m_segments.back().get();
+	m_index.push_back(EventRef{segment, (u32)segment->data.size(), (u32)frame.size()});
+	segment->data.append(frame);
+}
+
+// CALLED FROM SERVER THREAD
+void SlippiSpectateLog::clear()
+{
+	m_index.clear();
+	m_segments.clear();
+	m_first_index = 0;
+	m_bytes = 0;
+}
+
+// CALLED FROM SERVER THREAD
+void SlippiSpectateLog::retireSegments()
+{
+	// The segment being written to always stays
+	while (m_bytes > SPECTATE_LOG_MAX_BYTES && m_segments.size() > 1)
 	{
-		m_sockets[peer_id]->m_cursor = 0;
+		u64 count = m_segments[1]->first_index - m_segments[0]->first_index;
+		m_index.erase(m_index.begin(), m_index.begin() + (size_t)count);
+		m_first_index += count;
+		m_bytes -= m_segments[0]->bytes;
+		m_segments.pop_front();
+		INFO_LOG(SLIPPI, "Spectator event log is full, dropped events before %llu", (unsigned long long)m_first_index);
+	}
+}
+
+void SlippiSpectateLog::releaseSegment(ENetPacket *packet)
+{
+	delete (std::shared_ptr<Segment> *)packet->userData;
+}
+
+// CALLED FROM SERVER THREAD
+ENetPacket *SlippiSpectateLog::createPacket(u64 index, bool binary)
+{
+	const EventRef &ref = m_index[(size_t)(index - m_first_index)];
+	Segment *segment = ref.segment;
+	const char *data = segment->data.data() + ref.offset;
+	size_t length = ref.length;
+
+	if (!binary)
+	{
+		size_t event = (size_t)(index - segment->first_index);
+		if (segment->json.size() <= event)
+		{
+			segment->json.resize(event + 1);
+		}
+		// Growing a deque at the end leaves the other strings where they are
+		std::string &message = segment->json[event];
+		if (message.empty())
+		{
+			message = buildJsonEvent(data, length);
+			segment->bytes += message.size();
+			m_bytes += message.size();
+		}
+		data = message.data();
+		length = message.size();
 	}
 
-	for (u64 i = m_sockets[peer_id]->m_cursor; i < m_event_buffer.size(); i++)
+	ENetPacket *packet = enet_packet_create(data, length, ENET_PACKET_FLAG_RELIABLE | ENET_PACKET_FLAG_NO_ALLOCATE);
+	packet->userData = new std::shared_ptr<Segment>(segment->shared_from_this());
+	packet->freeCallback = &SlippiSpectateLog::releaseSegment;
+	return packet;
+}
+
+// Frees packets that ended up not being queued on any peer
+static void releaseSharedPackets(ENetPacket *packets[2])
+{
+	for (int i = 0; i < 2; i++)
 	{
-		ENetPacket *packet =
-		    enet_packet_create(m_event_buffer[i].data(), m_event_buffer[i].size(), ENET_PACKET_FLAG_RELIABLE);
-		// Batch for sending
-		enet_peer_send(m_sockets[peer_id]->m_peer, 0, packet);
-		m_sockets[peer_id]->m_cursor++;
+		if (packets[i] && packets[i]->referenceCount == 0)
+		{
+			enet_packet_destroy(packets[i]);
+		}
 	}
 }
 
 // CALLED FROM SERVER THREAD
-void SlippiSpectateServer::popEvents()
+void SlippiSpectateServer::writeEvents()
 {
-	// Loop through the event queue and keep popping off events and handling them
-	while (!m_event_queue.Empty())
+	// Send menu events
+	if (!m_in_game)
 	{
-		std::string event;
-		m_event_queue.Pop(event);
-		// These two are meta-events, used to signify the start/end of a game
-		json json_message = json::parse(event, nullptr, false);
-		if (!json_message.is_discarded() && (json_message.find("type") != json_message.end()))
+		ENetPacket *packets[2] = {nullptr, nullptr}; // JSON, binary
+		for (auto &it : m_sockets)
 		{
-			if (json_message["type"] == "end_game")
+			SlippiSocket &socket = *it.second;
+			if (!socket.m_shook_hands || socket.m_menu_cursor == m_menu_cursor)
 			{
-				u32 cursor = (u32)(m_event_buffer.size() + m_cursor_offset);
-				json_message["cursor"] = cursor;
-				json_message["next_cursor"] = cursor + 1;
-				m_menu_cursor = 0;
-				m_event_buffer.push_back(json_message.dump());
-				m_cursor_offset += m_event_buffer.size();
-				m_menu_event.clear();
-				m_in_game = false;
 				continue;
 			}
-			if (json_message["type"] == "start_game")
+			if (!m_menu_event.empty())
+			{
+				ENetPacket *&packet = packets[socket.m_binary];
+				if (!packet)
+				{
+					if (!socket.m_binary && m_menu_event_json.empty())
+					{
+						m_menu_event_json = buildJsonEvent(m_menu_event.data(), m_menu_event.size());
+					}
+					const std::string &data = socket.m_binary ? m_menu_event : m_menu_event_json;
+					packet = enet_packet_create(data.data(), data.size(), ENET_PACKET_FLAG_RELIABLE);
+				}
+				enet_peer_send(socket.m_peer, 0, packet);
+			}
+			// Record for the peer that it was sent
+			socket.m_menu_cursor = m_menu_cursor;
+		}
+		releaseSharedPackets(packets);
+	}
+
+	// Send game events
+	// If a client's cursor is beyond the end of the event log, then
+	//  it's probably left over from an old game. (Or is invalid anyway)
+	//  So reset it back to 0. If it's before the oldest event we still
+	//  have, the best we can do is to bring it up to that one.
+	u64 first_cursor = m_event_log.end();
+	for (auto &it : m_sockets)
+	{
+		SlippiSocket &socket = *it.second;
+		if (!socket.m_shook_hands)
+		{
+			continue;
+		}
+		if (socket.m_cursor > m_event_log.end())
+		{
+			socket.m_cursor = 0;
+		}
+		if (socket.m_cursor < m_event_log.begin())
+		{
+			WARN_LOG(SLIPPI, "Spectator fell behind the kept events, skipping to the oldest one");
+			socket.m_cursor = m_event_log.begin();
+		}
+		first_cursor = std::min(first_cursor, socket.m_cursor);
+	}
+
+	// Walk the events from the furthest behind client. Every event is packed once and
+	//  queued for each client sitting at that cursor, which then moves on to the next one.
+	for (u64 i = first_cursor; i < m_event_log.end(); i++)
+	{
+		ENetPacket *packets[2] = {nullptr, nullptr}; // JSON, binary
+		for (auto &it : m_sockets)
+		{
+			SlippiSocket &socket = *it.second;
+			if (!socket.m_shook_hands || socket.m_cursor != i)
 			{
-				m_event_buffer.clear();
-				u32 cursor = (u32)(m_event_buffer.size() + m_cursor_offset);
-				m_in_game = true;
-				json_message["cursor"] = cursor;
-				json_message["next_cursor"] = cursor + 1;
-				m_event_buffer.push_back(json_message.dump());
 				continue;
 			}
+			ENetPacket *&packet = packets[socket.m_binary];
+			if (!packet)
+			{
+				packet = m_event_log.createPacket(i, socket.m_binary);
+			}
+			enet_peer_send(socket.m_peer, 0, packet);
+			socket.m_cursor++;
 		}
+		releaseSharedPackets(packets);
+	}
+}
+
+// CALLED FROM SERVER THREAD
+void SlippiSpectateServer::pushEvent(u8 type, const std::string &payload)
+{
+	u32 cursor = (u32)(m_event_log.end() + m_cursor_offset);
+	m_event_log.append(buildBinaryEvent(type, cursor, cursor + 1, payload));
+}
 
-		// Make json wrapper for game event
-		json game_event;
+// CALLED FROM SERVER THREAD
+void SlippiSpectateServer::popEvents()
+{
+	// Loop through the event queue and keep popping off events and handling them
+	QueuedEvent event;
+	while (m_event_queue.Pop(event))
+	{
+		// These two are meta-events, used to signify the start/end of a game
+		if (event.type == SPECTATE_EVENT_END_GAME)
+		{
+			m_menu_cursor = 0;
+			pushEvent(SPECTATE_EVENT_END_GAME, event.payload);
+			m_cursor_offset += m_event_log.end();
+			m_menu_event.clear();
+			m_menu_event_json.clear();
+			m_in_game = false;
+			continue;
+		}
+		if (event.type == SPECTATE_EVENT_START_GAME)
+		{
+			m_event_log.clear();
+			m_in_game = true;
+			pushEvent(SPECTATE_EVENT_START_GAME, "");
+			continue;
+		}
 
 		if (!m_in_game)
 		{
-			game_event["payload"] = base64::Base64::Encode(event);
 			m_menu_cursor += 1;
-			game_event["type"] = "menu_event";
-			m_menu_event = game_event.dump();
+			m_menu_event = buildBinaryEvent(SPECTATE_EVENT_MENU, 0, 0, event.payload);
+			m_menu_event_json.clear();
 			continue;
 		}
 
-		u8 command = (u8)event[0];
-		m_event_concat = m_event_concat + event;
+		u8 command = (u8)event.payload[0];
+		m_event_concat.append(event.payload);
 
 		static std::unordered_map<u8, bool> sendEvents = {
 		    {0x36, true}, // GAME_INIT
@@ -151,14 +334,8 @@ void SlippiSpectateServer::popEvents()
 
 		if (sendEvents.count(command))
 		{
-			u32 cursor = (u32)(m_event_buffer.size() + m_cursor_offset);
-			game_event["payload"] = base64::Base64::Encode(m_event_concat);
-			game_event["type"] = "game_event";
-			game_event["cursor"] = cursor;
-			game_event["next_cursor"] = cursor + 1;
-			m_event_buffer.push_back(game_event.dump());
-
-			m_event_concat = "";
+			pushEvent(SPECTATE_EVENT_GAME, m_event_concat);
+			m_event_concat.clear();
 		}
 	}
 }
@@ -224,7 +401,7 @@ void SlippiSpectateServer::handleMessage(u8 *buffer, u32 length, u16 peer_id)
 			if (requested_cursor >= m_cursor_offset)
 			{
 				// If the requested cursor is past what events we even have, then just tell them to start over
-				if (requested_cursor > m_event_buffer.size() + m_cursor_offset)
+				if (requested_cursor > m_event_log.end() + m_cursor_offset)
 				{
 					m_sockets[peer_id]->m_cursor = 0;
 				}
@@ -240,13 +417,29 @@ void SlippiSpectateServer::handleMessage(u8 *buffer, u32 length, u16 peer_id)
 				m_sockets[peer_id]->m_cursor = 0;
 			}
 
+			// Events before the oldest one still kept can't be replayed anymore
+			if (m_sockets[peer_id]->m_cursor < m_event_log.begin())
+			{
+				m_sockets[peer_id]->m_cursor = m_event_log.begin();
+			}
+
 			sent_cursor = (u32)m_sockets[peer_id]->m_cursor + (u32)m_cursor_offset;
 
+			// Clients that understand the binary framing ask for it, everyone else keeps getting JSON
+			bool binary = false;
+			if (json_message.find("protocol") != json_message.end() && json_message["protocol"] == "binary" &&
+			    json_message.find("protocol_version") != json_message.end() &&
+			    json_message["protocol_version"].is_number_integer() && json_message["protocol_version"] >= 1)
+			{
+				binary = true;
+			}
+			m_sockets[peer_id]->m_binary = binary;
+
 			// If someone joins while at the menu, don't catch them up
 			//  set their cursor to the end
 			if (!m_in_game)
 			{
-				m_sockets[peer_id]->m_cursor = m_event_buffer.size();
+				m_sockets[peer_id]->m_cursor = m_event_log.end();
 			}
 
 			json reply;
@@ -254,6 +447,11 @@ void SlippiSpectateServer::handleMessage(u8 *buffer, u32 length, u16 peer_id)
 			reply["nick"] = "Slippi Online";
 			reply["version"] = scm_slippi_semver_str;
 			reply["cursor"] = sent_cursor;
+			if (binary)
+			{
+				reply["protocol"] = "binary";
+				reply["protocol_version"] = SPECTATE_BINARY_PROTOCOL_VERSION;
+			}
 
 			std::string packet_buffer = reply.dump();
 
@@ -315,14 +513,7 @@ void SlippiSpectateServer::SlippicommSocketThread(void)
 		// Pop off any events in the queue
 		popEvents();
 
-		std::map<u16, std::shared_ptr<SlippiSocket>>::iterator it = m_sockets.begin();
-		for (; it != m_sockets.end(); it++)
-		{
-			if (it->second->m_shook_hands)
-			{
-				writeEvents(it->first);
-			}
-		}
+		writeEvents();
 
 		ENetEvent event;
 		while (enet_host_service(server, &event, 1) > 0)
@@ -2,7 +2,9 @@
 
 #include <atomic>
 #include <chrono>
+#include <deque>
 #include <map>
+#include <memory>
 #include <thread>
 
 #include "Common/FifoQueue.h"
@@ -27,15 +29,79 @@ typedef int SOCKET;
 #define KEEPALIVE_TYPE 3
 #define MENU_TYPE 4
 
+// Binary framing, negotiated by sending "protocol": "binary" and "protocol_version" in the
+//  connect_request. Handshakes stay JSON, every event is then sent as a 9 byte header
+//  followed by the raw event bytes, without JSON or base64:
+//    u8  type (SPECTATE_EVENT_*)
+//    u32 cursor, big endian
+//    u32 next_cursor, big endian
+//  Menu events carry a cursor of 0, end_game carries one byte that is 1 if dolphin closed.
+#define SPECTATE_BINARY_PROTOCOL_VERSION 1
+#define SPECTATE_BINARY_HEADER_SIZE 9
+#define SPECTATE_EVENT_GAME 1
+#define SPECTATE_EVENT_MENU 2
+#define SPECTATE_EVENT_START_GAME 3
+#define SPECTATE_EVENT_END_GAME 4
+
 class SlippiSocket
 {
   public:
 	u64 m_cursor = 0;           // Index of the last game event this client sent
 	u64 m_menu_cursor = 0;      // The latest menu event that this socket has sent
 	bool m_shook_hands = false; // Has this client shaken hands yet?
+	bool m_binary = false;      // Did this client negotiate the binary framing?
 	ENetPeer *m_peer = NULL;    // The ENet peer object for the socket
 };
 
+// Keeping a whole set of events around would grow without bound, so the log holds at most
+//  this many bytes. Past that the oldest segments get dropped and clients that fall that far
+//  behind are moved up to the oldest event still kept.
+#define SPECTATE_LOG_SEGMENT_SIZE (256 * 1024)
+#define SPECTATE_LOG_MAX_BYTES (64 * 1024 * 1024)
+
+// Append-only log of the events of the current game, in their binary framing. Events are
+//  packed back to back into large segments and indexed by cursor, so looking one up is O(1).
+//  Packets point into the segments instead of copying them, and keep the segment alive until
+//  ENet is done with them, even if the log has already dropped it.
+class SlippiSpectateLog
+{
+  public:
+	// Index of the oldest event still kept, and one past the newest
+	u64 begin() const { return m_first_index; }
+	u64 end() const { return m_first_index + m_index.size(); }
+
+	void append(const std::string &frame);
+	// Drops every event and starts indexing again from 0
+	void clear();
+	// Packet for the event at the given index, in the binary or the legacy JSON framing.
+	//  The JSON message is only built the first time a JSON client asks for it.
+	ENetPacket *createPacket(u64 index, bool binary);
+
+  private:
+	struct Segment : std::enable_shared_from_this<Segment>
+	{
+		std::string data;             // Binary frames, never grows past its reserved size
+		std::deque<std::string> json; // JSON messages by event, built lazily
+		u64 first_index = 0;
+		size_t bytes = 0;
+	};
+	struct EventRef
+	{
+		Segment *segment;
+		u32 offset;
+		u32 length;
+	};
+
+	void retireSegments();
+	// ENet free callback, drops the packet's reference to its segment
+	static void releaseSegment(ENetPacket *packet);
+
+	std::deque<std::shared_ptr<Segment>> m_segments;
+	std::deque<EventRef> m_index;
+	u64 m_first_index = 0;
+	size_t m_bytes = 0;
+};
+
 class SlippiSpectateServer
 {
   public:
@@ -69,7 +135,12 @@ class SlippiSpectateServer
 	//  dolphin thread and the spectator server thread. The purpose here
 	//  is to avoid blocking (even if just for a brief mutex) on the main
 	//  dolphin thread.
-	Common::FifoQueue<std::string> m_event_queue;
+	struct QueuedEvent
+	{
+		u8 type; // SPECTATE_EVENT_GAME for raw game data, or START_GAME/END_GAME
+		std::string payload;
+	};
+	Common::FifoQueue<QueuedEvent> m_event_queue;
 	// Bool gets flipped by the destrctor to tell the server thread to shut down
 	//  bools are probably atomic by default, but just for safety...
 	std::atomic<bool> m_stop_socket_thread;
@@ -78,8 +149,9 @@ class SlippiSpectateServer
 	bool m_in_game;
 	std::map<u16, std::shared_ptr<SlippiSocket>> m_sockets;
 	std::string m_event_concat = "";
-	std::vector<std::string> m_event_buffer;
-	std::string m_menu_event;
+	SlippiSpectateLog m_event_log;
+	std::string m_menu_event;      // Latest menu event in the binary framing
+	std::string m_menu_event_json; // Same, in the JSON framing. Built lazily
 	// In order to emulate Wii behavior, the cursor position should be strictly
 	//  increasing. But internally, we need to index arrays by the cursor value.
 	//  To solve this, we keep an "offset" value that is added to all outgoing
@@ -100,9 +172,11 @@ class SlippiSpectateServer
 	void SlippicommSocketThread(void);
 	// Handle an incoming message on a socket
 	void handleMessage(u8 *buffer, u32 length, u16 peer_id);
-	// Catch up given socket to the latest events
-	//  Does nothing if they're already caught up.
-	void writeEvents(u16 peer_id);
+	// Catch up all sockets to the latest events
+	//  Each event is packed once and shared by all sockets that need it.
+	void writeEvents();
+	// Append an event with the given type and payload to the event log
+	void pushEvent(u8 type, const std::string &payload);
 	// Pop events
 	void popEvents();
 };
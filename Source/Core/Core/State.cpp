@@ -308,6 +308,9 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 	// For easy debugging
 	Common::SetCurrentThreadName("SaveState thread");
 
+	// The recording saved with the previous state may still be being written
+	Movie::FlushRecording();
+
 	// Moving to last overwritten save-state
 	if (File::Exists(filename))
 	{
@@ -8,11 +8,13 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <cstdio>
 #include <cstring>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 #include <zlib.h>
@@ -55,6 +57,10 @@ CompressedBlobReader::CompressedBlobReader(File::IOFile file, const std::string&
   // I still add some safety margin.
   const u32 zlib_buffer_size = m_header.block_size + 64;
   m_zlib_buffer.resize(zlib_buffer_size);
+
+  // The stream is reset for every block instead of setting it up from scratch.
+  m_z_stream = {};
+  inflateInit(&m_z_stream);
 }
 
 std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(File::IOFile file,
@@ -69,6 +75,7 @@ std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(File::IOFile
 
 CompressedBlobReader::~CompressedBlobReader()
 {
+  inflateEnd(&m_z_stream);
 }
 
 // IMPORTANT: Calling this function invalidates all earlier pointers gotten from this function.
@@ -98,9 +105,6 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
     offset &= ~(1ULL << 63);
   }
 
-  // clear unused part of zlib buffer. maybe this can be deleted when it works fully.
-  memset(&m_zlib_buffer[comp_block_size], 0, m_zlib_buffer.size() - comp_block_size);
-
   m_file.Seek(offset, SEEK_SET);
   if (!m_file.ReadBytes(m_zlib_buffer.data(), comp_block_size))
   {
@@ -123,7 +127,8 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
   }
   else
   {
-    z_stream z = {};
+    z_stream& z = m_z_stream;
+    inflateReset(&z);
     z.next_in = m_zlib_buffer.data();
     z.avail_in = comp_block_size;
     if (z.avail_in > m_header.block_size)
@@ -132,7 +137,6 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
     }
     z.next_out = out_ptr;
     z.avail_out = m_header.block_size;
-    inflateInit(&z);
     int status = inflate(&z, Z_FULL_FLUSH);
     u32 uncomp_size = m_header.block_size - z.avail_out;
     if (status != Z_STREAM_END)
@@ -141,7 +145,6 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
       // to be sure, don't use compressed isos :P
       PanicAlert("Failure reading block %" PRIu64 " - out of data and not at end.", block_num);
     }
-    inflateEnd(&z);
     if (uncomp_size != m_header.block_size)
     {
       PanicAlert("Wrong block size");
@@ -151,6 +154,58 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
   return true;
 }
 
+namespace
+{
+// Blocks handed to each compression thread per batch.
+constexpr u32 BLOCKS_PER_THREAD = 16;
+
+struct CompressionBlock
+{
+  std::vector<u8> in_buf;
+  std::vector<u8> out_buf;
+  const u8* write_buf = nullptr;
+  u32 write_size = 0;
+  bool stored = false;
+  bool failed = false;
+};
+
+// Deflates one block with its own stream, falling back to storing the block
+// as-is if it doesn't compress well. Independent of the other blocks, so any
+// number of these can run in parallel.
+void CompressBlock(z_stream* z, CompressionBlock* block, u32 block_size)
+{
+  block->failed = false;
+  if (deflateReset(z) != Z_OK)
+  {
+    block->failed = true;
+    return;
+  }
+
+  z->next_in = block->in_buf.data();
+  z->avail_in = block_size;
+  z->next_out = block->out_buf.data();
+  z->avail_out = block_size;
+
+  int status = deflate(z, Z_FINISH);
+  u32 comp_size = block_size - z->avail_out;
+
+  if ((status != Z_STREAM_END) || (z->avail_out < 10))
+  {
+    // let's store uncompressed
+    block->write_buf = block->in_buf.data();
+    block->write_size = block_size;
+    block->stored = true;
+  }
+  else
+  {
+    // let's store compressed
+    block->write_buf = block->out_buf.data();
+    block->write_size = comp_size;
+    block->stored = false;
+  }
+}
+}  // namespace
+
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
                         u32 sub_type, int block_size, CompressCB callback, void* arg)
 {
@@ -169,6 +224,9 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     return false;
   }
 
+  // IsGCZBlob read the start of the file, go back to the first block.
+  infile.Seek(0, SEEK_SET);
+
   File::IOFile outfile(outfile_path, "wb");
   if (!outfile)
   {
@@ -192,9 +250,21 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     scrubbing = true;
   }
 
-  z_stream z = {};
-  if (deflateInit(&z, 9) != Z_OK)
-    return false;
+  // Every thread deflates with its own stream. Blocks are still read and
+  // written in order by this thread, so the output is the same as when
+  // compressing one block at a time.
+  const u32 num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<z_stream> streams(num_threads);
+  for (size_t i = 0; i < streams.size(); ++i)
+  {
+    streams[i] = {};
+    if (deflateInit(&streams[i], 9) != Z_OK)
+    {
+      for (size_t j = 0; j < i; ++j)
+        deflateEnd(&streams[j]);
+      return false;
+    }
+  }
 
   callback(GetStringT("Files opened, ready to compress."), 0, arg);
 
@@ -209,8 +279,12 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
   std::vector<u64> offsets(header.num_blocks);
   std::vector<u32> hashes(header.num_blocks);
-  std::vector<u8> out_buf(block_size);
-  std::vector<u8> in_buf(block_size);
+  std::vector<CompressionBlock> batch(num_threads * BLOCKS_PER_THREAD);
+  for (CompressionBlock& block : batch)
+  {
+    block.in_buf.resize(block_size);
+    block.out_buf.resize(block_size);
+  }
 
   // seek past the header (we will write it at the end)
   outfile.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
@@ -221,87 +295,88 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
   u64 position = 0;
   int num_compressed = 0;
   int num_stored = 0;
-  int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
   bool success = true;
 
-  for (u32 i = 0; i < header.num_blocks; i++)
+  for (u32 first = 0; first < header.num_blocks; first += (u32)batch.size())
   {
-    if (i % progress_monitor == 0)
+    const u32 count = std::min<u32>((u32)batch.size(), header.num_blocks - first);
+
+    const u64 inpos = infile.Tell();
+    int ratio = 0;
+    if (inpos != 0)
+      ratio = (int)(100 * position / inpos);
+
+    std::string temp =
+        StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), first,
+                         header.num_blocks, ratio);
+    bool was_cancelled = !callback(temp, (float)first / (float)header.num_blocks, arg);
+    if (was_cancelled)
     {
-      const u64 inpos = infile.Tell();
-      int ratio = 0;
-      if (inpos != 0)
-        ratio = (int)(100 * position / inpos);
-
-      std::string temp =
-          StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
-                           header.num_blocks, ratio);
-      bool was_cancelled = !callback(temp, (float)i / (float)header.num_blocks, arg);
-      if (was_cancelled)
+      success = false;
+      break;
+    }
+
+    for (u32 i = 0; i < count; i++)
+    {
+      std::vector<u8>& in_buf = batch[i].in_buf;
+      size_t read_bytes;
+      if (scrubbing)
+        read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
+      else
+        infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
+      if (read_bytes < header.block_size)
+        std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
+    }
+
+    std::atomic<u32> next_block(0);
+    auto compress_blocks = [&](z_stream* z) {
+      for (u32 i = next_block++; i < count; i = next_block++)
+        CompressBlock(z, &batch[i], header.block_size);
+    };
+    std::vector<std::thread> threads;
+    for (u32 t = 1; t < num_threads && t * BLOCKS_PER_THREAD < count; t++)
+      threads.emplace_back(compress_blocks, &streams[t]);
+    compress_blocks(&streams[0]);
+    for (std::thread& thread : threads)
+      thread.join();
+
+    for (u32 i = 0; i < count; i++)
+    {
+      const CompressionBlock& block = batch[i];
+      if (block.failed)
       {
+        ERROR_LOG(DISCIO, "Deflate failed");
         success = false;
         break;
       }
-    }
-
-    offsets[i] = position;
 
-    size_t read_bytes;
-    if (scrubbing)
-      read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
-    else
-      infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
-    if (read_bytes < header.block_size)
-      std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
-
-    int retval = deflateReset(&z);
-    z.next_in = in_buf.data();
-    z.avail_in = header.block_size;
-    z.next_out = out_buf.data();
-    z.avail_out = block_size;
+      offsets[first + i] = position;
+      if (block.stored)
+      {
+        offsets[first + i] |= 0x8000000000000000ULL;
+        num_stored++;
+      }
+      else
+      {
+        num_compressed++;
+      }
 
-    if (retval != Z_OK)
-    {
-      ERROR_LOG(DISCIO, "Deflate failed");
-      success = false;
-      break;
-    }
+      if (!outfile.WriteBytes(block.write_buf, block.write_size))
+      {
+        PanicAlertT("Failed to write the output file \"%s\".\n"
+                    "Check that you have enough space available on the target drive.",
+                    outfile_path.c_str());
+        success = false;
+        break;
+      }
 
-    int status = deflate(&z, Z_FINISH);
-    int comp_size = block_size - z.avail_out;
+      position += block.write_size;
 
-    u8* write_buf;
-    int write_size;
-    if ((status != Z_STREAM_END) || (z.avail_out < 10))
-    {
-      // PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-      // let's store uncompressed
-      write_buf = in_buf.data();
-      offsets[i] |= 0x8000000000000000ULL;
-      write_size = block_size;
-      num_stored++;
-    }
-    else
-    {
-      // let's store compressed
-      // PanicAlert("Comp %i to %i", block_size, comp_size);
-      write_buf = out_buf.data();
-      write_size = comp_size;
-      num_compressed++;
+      hashes[first + i] = HashAdler32(block.write_buf, block.write_size);
     }
 
-    if (!outfile.WriteBytes(write_buf, write_size))
-    {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
-      success = false;
+    if (!success)
       break;
-    }
-
-    position += write_size;
-
-    hashes[i] = HashAdler32(write_buf, write_size);
   }
 
   header.compressed_data_size = position;
@@ -322,7 +397,8 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
   }
 
   // Cleanup
-  deflateEnd(&z);
+  for (z_stream& z : streams)
+    deflateEnd(&z);
 
   if (success)
   {
@@ -16,6 +16,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <zlib.h>
 
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
@@ -64,6 +65,7 @@ private:
   File::IOFile m_file;
   u64 m_file_size;
   std::vector<u8> m_zlib_buffer;
+  z_stream m_z_stream;
   std::string m_file_name;
 };
 
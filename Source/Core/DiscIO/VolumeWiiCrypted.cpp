@@ -2,6 +2,8 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstring>
 #include <map>
@@ -9,6 +11,7 @@
 #include <mbedtls/sha1.h>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -30,7 +33,8 @@ namespace DiscIO
 CVolumeWiiCrypted::CVolumeWiiCrypted(std::unique_ptr<IBlobReader> reader, u64 _VolumeOffset,
 	const unsigned char* _pVolumeKey)
 	: m_pReader(std::move(reader)), m_AES_ctx(std::make_unique<mbedtls_aes_context>()),
-	m_VolumeOffset(_VolumeOffset), m_dataOffset(0x20000), m_LastDecryptedBlockOffset(-1)
+	m_VolumeOffset(_VolumeOffset), m_dataOffset(0x20000), m_block_cache(s_cache_blocks),
+	m_block_cache_tick(0), m_read_buffer(s_max_batch_blocks * s_block_total_size)
 {
 	mbedtls_aes_setkey_dec(m_AES_ctx.get(), _pVolumeKey, 128);
 }
@@ -38,7 +42,7 @@ CVolumeWiiCrypted::CVolumeWiiCrypted(std::unique_ptr<IBlobReader> reader, u64 _V
 bool CVolumeWiiCrypted::ChangePartition(u64 offset)
 {
 	m_VolumeOffset = offset;
-	m_LastDecryptedBlockOffset = -1;
+	ClearBlockCache();
 
 	u8 volume_key[16];
 	DiscIO::VolumeKeyForPartition(*m_pReader, offset, volume_key);
@@ -50,6 +54,89 @@ CVolumeWiiCrypted::~CVolumeWiiCrypted()
 {
 }
 
+void CVolumeWiiCrypted::ClearBlockCache()
+{
+	for (CachedBlock& cached : m_block_cache)
+	{
+		cached.block = static_cast<u64>(-1);
+		cached.last_use = 0;
+	}
+}
+
+const CVolumeWiiCrypted::CachedBlock* CVolumeWiiCrypted::GetCachedBlock(u64 block) const
+{
+	for (CachedBlock& cached : m_block_cache)
+	{
+		if (cached.block == block)
+		{
+			cached.last_use = ++m_block_cache_tick;
+			return &cached;
+		}
+	}
+	return nullptr;
+}
+
+bool CVolumeWiiCrypted::DecryptBlocks(u64 first_block, u32 count) const
+{
+	// Consecutive blocks are contiguous in the blob, so they can be read at once.
+	if (!m_pReader->Read(m_VolumeOffset + m_dataOffset + first_block * s_block_total_size,
+		count * s_block_total_size, m_read_buffer.data()))
+		return false;
+
+	// Evict the least recently used entries. Each one is marked as used right
+	// away so that it isn't picked twice.
+	std::array<CachedBlock*, s_max_batch_blocks> destinations;
+	for (u32 i = 0; i < count; ++i)
+	{
+		CachedBlock* victim = &*std::min_element(
+			m_block_cache.begin(), m_block_cache.end(),
+			[](const CachedBlock& a, const CachedBlock& b) { return a.last_use < b.last_use; });
+		victim->block = first_block + i;
+		victim->last_use = ++m_block_cache_tick;
+		destinations[i] = victim;
+	}
+
+	// Decrypt the blocks' data.
+	// 0x3D0 - 0x3DF of each block in m_read_buffer will be overwritten,
+	// but that won't affect anything, because we won't
+	// use the content of m_read_buffer anymore after this.
+	//
+	// The only thing we currently use from the 0x000 - 0x3FF part
+	// of the block is the IV (at 0x3D0), but it also contains SHA-1
+	// hashes that IOS uses to check that discs aren't tampered with.
+	// http://wiibrew.org/wiki/Wii_Disc#Encrypted
+	//
+	// mbedtls uses AES-NI on its own when the CPU supports it.
+	auto decrypt_range = [&](u32 begin, u32 end) {
+		for (u32 i = begin; i < end; ++i)
+		{
+			u8* block = &m_read_buffer[i * s_block_total_size];
+			mbedtls_aes_crypt_cbc(m_AES_ctx.get(), MBEDTLS_AES_DECRYPT, s_block_data_size,
+				&block[0x3D0], &block[s_block_header_size], destinations[i]->data);
+		}
+	};
+
+	// The key schedule is only read while decrypting, so threads can share it.
+	u32 num_threads = std::min(count / s_min_blocks_per_thread,
+		std::max(std::thread::hardware_concurrency(), 1u));
+	if (num_threads <= 1)
+	{
+		decrypt_range(0, count);
+		return true;
+	}
+
+	std::vector<std::thread> threads;
+	u32 blocks_per_thread = (count + num_threads - 1) / num_threads;
+	u32 begin = blocks_per_thread;
+	for (; begin < count; begin += blocks_per_thread)
+		threads.emplace_back(decrypt_range, begin, std::min(begin + blocks_per_thread, count));
+	decrypt_range(0, blocks_per_thread);
+	for (std::thread& thread : threads)
+		thread.join();
+
+	return true;
+}
+
 bool CVolumeWiiCrypted::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer, bool decrypt) const
 {
 	if (m_pReader == nullptr)
@@ -60,39 +147,35 @@ bool CVolumeWiiCrypted::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer, bool de
 
 	FileMon::FindFilename(_ReadOffset);
 
-	std::vector<u8> read_buffer(s_block_total_size);
 	while (_Length > 0)
 	{
 		// Calculate block offset
 		u64 Block = _ReadOffset / s_block_data_size;
 		u64 Offset = _ReadOffset % s_block_data_size;
 
-		if (m_LastDecryptedBlockOffset != Block)
+		const CachedBlock* cached = GetCachedBlock(Block);
+		if (!cached)
 		{
-			// Read the current block
-			if (!m_pReader->Read(m_VolumeOffset + m_dataOffset + Block * s_block_total_size,
-				s_block_total_size, read_buffer.data()))
+			// Decrypt this block along with the following ones this read needs,
+			// stopping at the first one that is already cached.
+			u64 last_block = (_ReadOffset + _Length - 1) / s_block_data_size;
+			u32 count = 1;
+			while (count < s_max_batch_blocks && Block + count <= last_block &&
+				!GetCachedBlock(Block + count))
+			{
+				++count;
+			}
+
+			if (!DecryptBlocks(Block, count))
 				return false;
 
-			// Decrypt the block's data.
-			// 0x3D0 - 0x3DF in m_pBuffer will be overwritten,
-			// but that won't affect anything, because we won't
-			// use the content of m_pBuffer anymore after this
-			mbedtls_aes_crypt_cbc(m_AES_ctx.get(), MBEDTLS_AES_DECRYPT, s_block_data_size,
-				&read_buffer[0x3D0], &read_buffer[s_block_header_size],
-				m_LastDecryptedBlock);
-			m_LastDecryptedBlockOffset = Block;
-
-			// The only thing we currently use from the 0x000 - 0x3FF part
-			// of the block is the IV (at 0x3D0), but it also contains SHA-1
-			// hashes that IOS uses to check that discs aren't tampered with.
-			// http://wiibrew.org/wiki/Wii_Disc#Encrypted
+			cached = GetCachedBlock(Block);
 		}
 
 		// Copy the decrypted data
 		u64 MaxSizeToCopy = s_block_data_size - Offset;
 		u64 CopySize = (_Length > MaxSizeToCopy) ? MaxSizeToCopy : _Length;
-		memcpy(_pBuffer, &m_LastDecryptedBlock[Offset], (size_t)CopySize);
+		memcpy(_pBuffer, &cached->data[Offset], (size_t)CopySize);
 
 		// Update offsets
 		_Length -= CopySize;
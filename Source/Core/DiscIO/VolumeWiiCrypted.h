@@ -56,14 +56,34 @@ private:
 	static const unsigned int s_block_data_size = 0x7C00;
 	static const unsigned int s_block_total_size = s_block_header_size + s_block_data_size;
 
+	// Number of decrypted blocks kept in the cache (about 2 MiB).
+	static const unsigned int s_cache_blocks = 64;
+	// Most blocks read and decrypted at once for a single sequential read.
+	static const unsigned int s_max_batch_blocks = 32;
+	// Batches are only split across threads when each gets at least that many.
+	static const unsigned int s_min_blocks_per_thread = 4;
+
+	struct CachedBlock
+	{
+		u64 block = static_cast<u64>(-1);
+		u64 last_use = 0;
+		u8 data[s_block_data_size];
+	};
+
+	const CachedBlock* GetCachedBlock(u64 block) const;
+	bool DecryptBlocks(u64 first_block, u32 count) const;
+	void ClearBlockCache();
+
 	std::unique_ptr<IBlobReader> m_pReader;
 	std::unique_ptr<mbedtls_aes_context> m_AES_ctx;
 
 	u64 m_VolumeOffset;
 	u64 m_dataOffset;
 
-	mutable u64 m_LastDecryptedBlockOffset;
-	mutable unsigned char m_LastDecryptedBlock[s_block_data_size];
+	// LRU cache of decrypted blocks, indexed by block number in the partition.
+	mutable std::vector<CachedBlock> m_block_cache;
+	mutable u64 m_block_cache_tick;
+	mutable std::vector<u8> m_read_buffer;
 };
 
 }  // namespace
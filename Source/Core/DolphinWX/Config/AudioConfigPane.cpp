@@ -48,6 +48,12 @@ void AudioConfigPane::InitializeGUI()
 		new wxSpinCtrl(this, wxID_ANY, "", wxDefaultPosition, wxDefaultSize, wxSP_ARROW_KEYS, 0, 30);
 	m_audio_latency_label = new wxStaticText(this, wxID_ANY, _("Latency:"));
 
+	m_audio_resampler_strings.Add(_("Linear"));
+	m_audio_resampler_strings.Add(_("Cubic"));
+	m_audio_resampler_strings.Add(_("Windowed Sinc"));
+	m_audio_resampler_choice =
+		new wxChoice(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, m_audio_resampler_strings);
+
 	m_time_stretching_checkbox = new wxCheckBox(this, wxID_ANY, _("Time Stretching"));
 	m_RS_Hack_checkbox = new wxCheckBox(this, wxID_ANY, _("Rogue Squadron 2/3 Hack"));
 	m_audio_backend_choice->SetToolTip(
@@ -56,6 +62,8 @@ void AudioConfigPane::InitializeGUI()
 		"crackling. Certain backends only."));
 	m_dpl2_decoder_checkbox->SetToolTip(
 		_("Enables Dolby Pro Logic II emulation using 5.1 surround. Certain backends only."));
+	m_audio_resampler_choice->SetToolTip(_("Interpolation used to convert game audio to the output "
+		"sample rate. Windowed Sinc has the highest quality but costs the most CPU time."));
 
 	const int space5 = FromDIP(5);
 
@@ -87,6 +95,10 @@ void AudioConfigPane::InitializeGUI()
 		wxALIGN_CENTER_VERTICAL);
 	backend_grid_sizer->Add(m_audio_latency_spinctrl, wxGBPosition(2, 1), wxDefaultSpan,
 		wxALIGN_CENTER_VERTICAL);
+	backend_grid_sizer->Add(new wxStaticText(this, wxID_ANY, _("Resampling:")), wxGBPosition(3, 0),
+		wxDefaultSpan, wxALIGN_CENTER_VERTICAL);
+	backend_grid_sizer->Add(m_audio_resampler_choice, wxGBPosition(3, 1), wxDefaultSpan,
+		wxALIGN_CENTER_VERTICAL);
 
 	wxStaticBoxSizer* const backend_static_box_sizer =
 		new wxStaticBoxSizer(wxVERTICAL, this, _("Backend Settings"));
@@ -127,6 +139,7 @@ void AudioConfigPane::LoadGUIValues()
 	m_volume_text->SetLabel(wxString::Format("%d %%", SConfig::GetInstance().m_Volume));
 	m_dpl2_decoder_checkbox->SetValue(startup_params.bDPL2Decoder);
 	m_audio_latency_spinctrl->SetValue(startup_params.iLatency);
+	m_audio_resampler_choice->SetSelection(startup_params.iAudioResampler);
 
 	m_time_stretching_checkbox->SetValue(startup_params.bTimeStretching);
 	m_RS_Hack_checkbox->SetValue(startup_params.bRSHACK);
@@ -161,6 +174,8 @@ void AudioConfigPane::BindEvents()
 
 	m_audio_latency_spinctrl->Bind(wxEVT_SPINCTRL, &AudioConfigPane::OnLatencySpinCtrlChanged, this);
 	m_audio_latency_spinctrl->Bind(wxEVT_UPDATE_UI, &WxEventUtils::OnEnableIfCoreNotRunning);
+	m_audio_resampler_choice->Bind(wxEVT_CHOICE, &AudioConfigPane::OnResamplerChoiceChanged, this);
+
 	m_time_stretching_checkbox->Bind(wxEVT_CHECKBOX, &AudioConfigPane::OnTimeStretchingCheckBoxChanged, this);
 	m_RS_Hack_checkbox->Bind(wxEVT_CHECKBOX, &AudioConfigPane::OnRS_Hack_checkboxChanged, this);
 }
@@ -209,6 +224,11 @@ void AudioConfigPane::OnLatencySpinCtrlChanged(wxCommandEvent& event)
 	SConfig::GetInstance().iLatency = m_audio_latency_spinctrl->GetValue();
 }
 
+void AudioConfigPane::OnResamplerChoiceChanged(wxCommandEvent& event)
+{
+	SConfig::GetInstance().iAudioResampler = m_audio_resampler_choice->GetSelection();
+}
+
 void AudioConfigPane::PopulateBackendChoiceBox()
 {
 	for (const std::string& backend : AudioCommon::GetSoundBackends())
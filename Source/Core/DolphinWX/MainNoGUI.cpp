@@ -2,20 +2,27 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <climits>
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
+#include <fstream>
 #include <getopt.h>
+#include <mutex>
 #include <signal.h>
 #include <string>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
+#include "Common/FileUtil.h"
 #include "Common/Flag.h"
 #include "Common/Logging/LogManager.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/Timer.h"
 
 #include "Core/Analytics.h"
 #include "Core/BootManager.h"
@@ -27,6 +34,8 @@
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_stm.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_usb_bt_emu.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_WiiMote.h"
+#include "Core/Movie.h"
+#include "Core/Slippi/SlippiReplayComm.h"
 #include "Core/State.h"
 
 #include "UICommon/UICommon.h"
@@ -54,6 +63,233 @@ namespace ProcessorInterface
 void PowerButton_Tap();
 }
 
+#ifdef IS_PLAYBACK
+// Batch rendering: plays a list of replays back to back through a queue comm file and
+// dumps every one of them to its own video file. Progress is reported on stdout as
+// one JSON object per line. Only playback builds consume the queue comm file.
+struct BatchJob
+{
+	std::string replay;
+	std::string output;
+	int start_frame = Slippi::GAME_FIRST_FRAME;
+	int end_frame = INT_MAX;
+};
+
+static std::vector<BatchJob> s_batch_jobs;
+static std::mutex s_batch_lock;
+static int s_batch_current_job = -1;
+static u64 s_batch_job_start_frame;
+static u64 s_batch_job_start_ms;
+static u64 s_batch_start_ms;
+static u64 s_batch_total_frames;
+static u64 s_batch_last_report_ms;
+static std::thread s_batch_prefetch_thread;
+
+static void PrintBatchEvent(const json& event)
+{
+	std::string line = event.dump();
+	fprintf(stdout, "%s\n", line.c_str());
+	fflush(stdout);
+}
+
+static bool LoadBatchJobs(const std::string& path)
+{
+	std::string contents;
+	if (!File::ReadFileToString(path, contents))
+		return false;
+
+	auto res = json::parse(contents, nullptr, false);
+	if (res.is_discarded() || !res.is_array())
+		return false;
+
+	for (const json& el : res)
+	{
+		if (!el.is_object())
+			continue;
+
+		BatchJob job;
+		job.replay = el.value("replay", "");
+		job.output = el.value("output", "");
+		job.start_frame = el.value("startFrame", Slippi::GAME_FIRST_FRAME);
+		job.end_frame = el.value("endFrame", INT_MAX);
+
+		// A missing replay would stall the queue forever, so leave those out up front
+		if (job.replay.empty() || job.output.empty() || !File::Exists(job.replay))
+		{
+			PrintBatchEvent({{"event", "job_skipped"}, {"replay", job.replay}, {"output", job.output}});
+			continue;
+		}
+
+		s_batch_jobs.push_back(std::move(job));
+	}
+	return true;
+}
+
+static bool WriteBatchCommFile(const std::string& path)
+{
+	json queue = json::array();
+	for (const BatchJob& job : s_batch_jobs)
+		queue.push_back({{"path", job.replay}, {"startFrame", job.start_frame}, {"endFrame", job.end_frame}});
+
+	json comm = {{"mode", "queue"},
+	             {"commandId", std::to_string(Common::Timer::GetTimeMs())},
+	             {"isRealTimeMode", false},
+	             {"outputOverlayFiles", false},
+	             {"queue", queue}};
+	return File::WriteStringToFile(comm.dump(), path);
+}
+
+// Reads a replay ahead of time so that loading it doesn't wait on the disk
+static void PrefetchBatchReplay(size_t index)
+{
+	if (s_batch_prefetch_thread.joinable())
+		s_batch_prefetch_thread.join();
+	if (index >= s_batch_jobs.size())
+		return;
+
+	s_batch_prefetch_thread = std::thread([path = s_batch_jobs[index].replay] {
+		std::ifstream file;
+		OpenFStream(file, path, std::ios_base::in | std::ios_base::binary);
+		char buffer[64 * 1024];
+		while (file.read(buffer, sizeof(buffer)))
+		{
+		}
+	});
+}
+
+// Must be called with s_batch_lock held
+static void FinishBatchJob()
+{
+	if (s_batch_current_job < 0)
+		return;
+
+	const u64 frames = Movie::GetCurrentFrame() - s_batch_job_start_frame;
+	const u64 ms = std::max<u64>(Common::Timer::GetTimeMs() - s_batch_job_start_ms, 1);
+	s_batch_total_frames += frames;
+
+	const BatchJob& job = s_batch_jobs[s_batch_current_job];
+	PrintBatchEvent({{"event", "job_done"},
+	                 {"job", s_batch_current_job},
+	                 {"replay", job.replay},
+	                 {"output", job.output},
+	                 {"frames", frames},
+	                 {"seconds", ms / 1000.0},
+	                 {"fps", frames * 1000.0 / ms}});
+	s_batch_current_job = -1;
+}
+
+static void OnBatchGameLoaded(const SlippiReplayComm::WatchSettings& settings)
+{
+	{
+		std::lock_guard<std::mutex> lk(s_batch_lock);
+		FinishBatchJob();
+
+		if (settings.index < 0 || settings.index >= (int)s_batch_jobs.size())
+			return;
+
+		s_batch_current_job = settings.index;
+		s_batch_job_start_frame = Movie::GetCurrentFrame();
+		s_batch_job_start_ms = Common::Timer::GetTimeMs();
+
+		const BatchJob& job = s_batch_jobs[s_batch_current_job];
+		std::string directory, filename, extension;
+		SplitPath(job.output, &directory, &filename, &extension);
+		g_renderer->StartNewFrameDumpFile(directory, filename);
+		SConfig::GetInstance().m_DumpFrames = true;
+
+		PrintBatchEvent({{"event", "job_start"},
+		                 {"job", s_batch_current_job},
+		                 {"jobs", s_batch_jobs.size()},
+		                 {"replay", job.replay},
+		                 {"output", job.output}});
+	}
+
+	// Overlap reading the next replay with playing and encoding this one. Outside of the lock,
+	// as it waits for the previous prefetch to finish.
+	PrefetchBatchReplay(settings.index + 1);
+}
+
+static void OnBatchQueueEmpty()
+{
+	std::lock_guard<std::mutex> lk(s_batch_lock);
+	FinishBatchJob();
+
+	s_running.Clear();
+}
+
+static void ReportBatchProgress()
+{
+	std::lock_guard<std::mutex> lk(s_batch_lock);
+	const u64 now = Common::Timer::GetTimeMs();
+	if (s_batch_current_job < 0 || now - s_batch_last_report_ms < 1000)
+		return;
+
+	const u64 frames = Movie::GetCurrentFrame() - s_batch_job_start_frame;
+	const u64 ms = std::max<u64>(now - s_batch_job_start_ms, 1);
+	PrintBatchEvent({{"event", "progress"},
+	                 {"job", s_batch_current_job},
+	                 {"frames", frames},
+	                 {"end_frame", s_batch_jobs[s_batch_current_job].end_frame},
+	                 {"fps", frames * 1000.0 / ms}});
+	s_batch_last_report_ms = now;
+}
+
+static void ReportBatchFinished()
+{
+	if (s_batch_prefetch_thread.joinable())
+		s_batch_prefetch_thread.join();
+
+	std::lock_guard<std::mutex> lk(s_batch_lock);
+	const u64 ms = std::max<u64>(Common::Timer::GetTimeMs() - s_batch_start_ms, 1);
+	PrintBatchEvent({{"event", "batch_done"},
+	                 {"jobs", s_batch_jobs.size()},
+	                 {"frames", s_batch_total_frames},
+	                 {"seconds", ms / 1000.0},
+	                 {"fps", s_batch_total_frames * 1000.0 / ms}});
+}
+
+static bool SetUpBatch(const std::string& jobs_path)
+{
+	if (!LoadBatchJobs(jobs_path))
+	{
+		fprintf(stderr, "Could not read batch file %s\n", jobs_path.c_str());
+		return false;
+	}
+	if (s_batch_jobs.empty())
+	{
+		fprintf(stderr, "No replays to render in %s\n", jobs_path.c_str());
+		return false;
+	}
+
+	const std::string comm_path = jobs_path + ".comm.json";
+	if (!WriteBatchCommFile(comm_path))
+	{
+		fprintf(stderr, "Could not write %s\n", comm_path.c_str());
+		return false;
+	}
+
+	SConfig& config = SConfig::GetInstance();
+	config.m_strSlippiInput = comm_path;
+	// Frame dumping starts with the first replay, so the boot sequence isn't recorded
+	config.m_DumpFrames = false;
+	config.m_DumpFramesSilent = true;
+	// Render as fast as the host allows
+	config.m_EmulationSpeed = 0.0f;
+
+	SlippiReplayComm::onGameLoaded = OnBatchGameLoaded;
+	SlippiReplayComm::onQueueEmpty = OnBatchQueueEmpty;
+
+	s_batch_start_ms = Common::Timer::GetTimeMs();
+	PrintBatchEvent({{"event", "batch_start"}, {"jobs", s_batch_jobs.size()}});
+	PrefetchBatchReplay(0);
+	return true;
+}
+#else
+static void ReportBatchProgress()
+{
+}
+#endif
+
 class Platform
 {
 public:
@@ -64,6 +300,7 @@ public:
 		while (s_running.IsSet())
 		{
 			Core::HostDispatchJobs();
+			ReportBatchProgress();
 			std::this_thread::sleep_for(std::chrono::milliseconds(100));
 		}
 	}
@@ -345,6 +582,7 @@ class PlatformX11 : public Platform
 				rendererIsFullscreen = false;
 			}
 			Core::HostDispatchJobs();
+			ReportBatchProgress();
 			usleep(100000);
 		}
 	}
@@ -376,17 +614,29 @@ static Platform* GetPlatform()
 int main(int argc, char* argv[])
 {
 	int ch, help = 0;
+	std::string batch_path;
 	struct option longopts[] = { { "exec", no_argument, nullptr, 'e' },
+#ifdef IS_PLAYBACK
+	{ "render-batch", required_argument, nullptr, 'r' },
+#endif
 	{ "help", no_argument, nullptr, 'h' },
 	{ "version", no_argument, nullptr, 'v' },
 	{ nullptr, 0, nullptr, 0 } };
 
-	while ((ch = getopt_long(argc, argv, "eh?v", longopts, 0)) != -1)
+#ifdef IS_PLAYBACK
+	const char* shortopts = "er:h?v";
+#else
+	const char* shortopts = "eh?v";
+#endif
+	while ((ch = getopt_long(argc, argv, shortopts, longopts, 0)) != -1)
 	{
 		switch (ch)
 		{
 		case 'e':
 			break;
+		case 'r':
+			batch_path = optarg;
+			break;
 		case 'h':
 		case '?':
 			help = 1;
@@ -401,8 +651,16 @@ int main(int argc, char* argv[])
 	{
 		fprintf(stderr, "%s\n\n", scm_rev_str.c_str());
 		fprintf(stderr, "A multi-platform GameCube/Wii emulator\n\n");
+#ifdef IS_PLAYBACK
+		fprintf(stderr, "Usage: %s [-e <file>] [-r <jobs>] [-h] [-v]\n", argv[0]);
+#else
 		fprintf(stderr, "Usage: %s [-e <file>] [-h] [-v]\n", argv[0]);
+#endif
 		fprintf(stderr, "  -e, --exec     Load the specified file\n");
+#ifdef IS_PLAYBACK
+		fprintf(stderr, "  -r, --render-batch  Render the replays listed in a JSON file to video, e.g.\n"
+			"                      [{\"replay\": \"a.slp\", \"output\": \"out/a\"}]\n");
+#endif
 		fprintf(stderr, "  -h, --help     Show this help message\n");
 		fprintf(stderr, "  -v, --version  Print version and exit\n");
 		return 1;
@@ -418,6 +676,11 @@ int main(int argc, char* argv[])
 	UICommon::SetUserDirectory("");  // Auto-detect user folder
 	UICommon::Init();
 
+#ifdef IS_PLAYBACK
+	if (!batch_path.empty() && !SetUpBatch(batch_path))
+		return 1;
+#endif
+
 	Core::SetOnStoppedCallback([]() { s_running.Clear(); });
 	platform->Init();
 
@@ -448,6 +711,11 @@ int main(int argc, char* argv[])
 	Core::Stop();
 
 	Core::Shutdown();
+
+#ifdef IS_PLAYBACK
+	if (!batch_path.empty())
+		ReportBatchFinished();
+#endif
 	platform->Shutdown();
 	UICommon::Shutdown();
 
@@ -590,10 +590,11 @@ void NetPlayDialog::OnPlayerPadBufferChanged(u32 buffer)
 	GetEventHandler()->AddPendingEvent(evt);
 }
 
-void NetPlayDialog::OnDesync(u32 frame, const std::string& player)
+void NetPlayDialog::OnDesync(u32 frame, const std::string& player, const std::string& what)
 {
 	m_desync_frame = frame;
 	m_desync_player = player;
+	m_desync_what = what;
 	wxThreadEvent evt(wxEVT_THREAD, NP_GUI_EVT_DESYNC);
 	GetEventHandler()->AddPendingEvent(evt);
 }
@@ -745,7 +746,7 @@ void NetPlayDialog::OnThread(wxThreadEvent& event)
 	case NP_GUI_EVT_DESYNC:
 	{
 		std::string msg = "Possible desync detected from player " + m_desync_player + " on frame " +
-			std::to_string(m_desync_frame);
+			std::to_string(m_desync_frame) + " in " + m_desync_what;
 
 		AddChatMessage(ChatMessageType::Error, msg);
 
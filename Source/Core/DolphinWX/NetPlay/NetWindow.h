@@ -100,7 +100,7 @@ public:
 	void OnMsgStopGame() override;
 	void OnMinimumPadBufferChanged(u32 buffer) override;
 	void OnPlayerPadBufferChanged(u32 buffer) override;
-	void OnDesync(u32 frame, const std::string& player) override;
+	void OnDesync(u32 frame, const std::string& player, const std::string& what) override;
 	void OnConnectionLost() override;
 	void OnTraversalError(int error) override;
 
@@ -175,6 +175,7 @@ private:
 	u32 m_player_pad_buffer;
 	u32 m_desync_frame;
 	std::string m_desync_player;
+	std::string m_desync_what;
 
 	std::vector<int> m_playerids;
 
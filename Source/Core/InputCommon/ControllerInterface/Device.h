@@ -42,7 +42,7 @@ public:
 	public:
 		virtual std::string GetName() const = 0;
 		virtual ~Control() {}
-		bool InputGateOn();
+		static bool InputGateOn();
 
 		virtual Input* ToInput() { return nullptr; }
 		virtual Output* ToOutput() { return nullptr; }
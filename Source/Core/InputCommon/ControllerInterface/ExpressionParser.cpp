@@ -207,6 +207,48 @@ public:
 	}
 };
 
+// Deeper programs are rare enough to just be evaluated on the tree
+static const int MAX_STACK_DEPTH = 16;
+
+class ExpressionCompiler
+{
+public:
+	std::vector<ExpressionInstruction> program;
+	std::vector<ExpressionOutput> outputs;
+	bool program_valid = true;
+	bool outputs_valid = true;
+	// whether the node being compiled gets its output state inverted
+	bool inverted = false;
+
+	void EmitZero() { Emit({EXPRESSION_OP_ZERO, nullptr}, 1); }
+	void EmitControl(Device::Control* control)
+	{
+		Device::Input* const input = control->ToInput();
+		if (input)
+			Emit({EXPRESSION_OP_INPUT, input}, 1);
+		else
+			program_valid = false;
+
+		Device::Output* const output = control->ToOutput();
+		if (output)
+			outputs.push_back({output, inverted});
+		else
+			outputs_valid = false;
+	}
+	void EmitOperator(ExpressionOpcode op, int operands) { Emit({op, nullptr}, 1 - operands); }
+
+private:
+	void Emit(const ExpressionInstruction& instruction, int stack_change)
+	{
+		program.push_back(instruction);
+		m_depth += stack_change;
+		if (m_depth > MAX_STACK_DEPTH)
+			program_valid = false;
+	}
+
+	int m_depth = 0;
+};
+
 class ExpressionNode
 {
 public:
@@ -214,6 +256,7 @@ public:
 	virtual ControlState GetValue() { return 0; }
 	virtual void SetValue(ControlState state) {}
 	virtual int CountNumControls() { return 0; }
+	virtual void Compile(ExpressionCompiler& compiler) const = 0;
 	virtual operator std::string() { return ""; }
 };
 
@@ -226,6 +269,7 @@ public:
 	ControlState GetValue() override { return 0.0; }
 	void SetValue(ControlState value) override {}
 	int CountNumControls() override { return 0; }
+	void Compile(ExpressionCompiler& compiler) const override { compiler.EmitZero(); }
 	operator std::string() override { return "`" + name + "`"; }
 };
 
@@ -244,6 +288,7 @@ public:
 	ControlState GetValue() override { return control->ToInput()->GetGatedState(); }
 	void SetValue(ControlState value) override { control->ToOutput()->SetGatedState(value); }
 	int CountNumControls() override { return 1; }
+	void Compile(ExpressionCompiler& compiler) const override { compiler.EmitControl(control); }
 	operator std::string() override { return "`" + (std::string)qualifier + "`"; }
 private:
 	std::shared_ptr<Device> m_device;
@@ -293,6 +338,25 @@ public:
 	}
 
 	int CountNumControls() override { return lhs->CountNumControls() + rhs->CountNumControls(); }
+	void Compile(ExpressionCompiler& compiler) const override
+	{
+		lhs->Compile(compiler);
+		rhs->Compile(compiler);
+		switch (op)
+		{
+		case TOK_AND:
+			compiler.EmitOperator(EXPRESSION_OP_AND, 2);
+			break;
+		case TOK_OR:
+			compiler.EmitOperator(EXPRESSION_OP_OR, 2);
+			break;
+		case TOK_ADD:
+			compiler.EmitOperator(EXPRESSION_OP_ADD, 2);
+			break;
+		default:
+			assert(false);
+		}
+	}
 	operator std::string() override
 	{
 		return OpName(op) + "(" + (std::string)(*lhs) + ", " + (std::string)(*rhs) + ")";
@@ -334,6 +398,20 @@ public:
 	}
 
 	int CountNumControls() override { return inner->CountNumControls(); }
+	void Compile(ExpressionCompiler& compiler) const override
+	{
+		switch (op)
+		{
+		case TOK_NOT:
+			compiler.inverted = !compiler.inverted;
+			inner->Compile(compiler);
+			compiler.inverted = !compiler.inverted;
+			compiler.EmitOperator(EXPRESSION_OP_NOT, 1);
+			break;
+		default:
+			assert(false);
+		}
+	}
 	operator std::string() override { return OpName(op) + "(" + (std::string)(*inner) + ")"; }
 };
 
@@ -497,20 +575,92 @@ private:
 	ExpressionParseStatus Toplevel(ExpressionNode** expr_out) { return Binary(expr_out); }
 };
 
+ControlState Expression::Run(bool gate_on) const
+{
+	ControlState stack[MAX_STACK_DEPTH];
+	int top = -1;
+	for (const ExpressionInstruction& instruction : m_program)
+	{
+		switch (instruction.op)
+		{
+		case EXPRESSION_OP_ZERO:
+			stack[++top] = 0.0;
+			break;
+		case EXPRESSION_OP_INPUT:
+			stack[++top] = gate_on ? instruction.input->GetState() : 0.0;
+			break;
+		case EXPRESSION_OP_AND:
+			--top;
+			stack[top] = std::min(stack[top], stack[top + 1]);
+			break;
+		case EXPRESSION_OP_OR:
+			--top;
+			stack[top] = std::max(stack[top], stack[top + 1]);
+			break;
+		case EXPRESSION_OP_ADD:
+			--top;
+			stack[top] = std::min(stack[top] + stack[top + 1], 1.0);
+			break;
+		case EXPRESSION_OP_NOT:
+			stack[top] = 1.0 - stack[top];
+			break;
+		}
+	}
+	return stack[0];
+}
+
 ControlState Expression::GetValue()
 {
-	return node->GetValue();
+	if (!m_program_valid)
+		return node->GetValue();
+
+	// The gate doesn't depend on the control, so check it once instead of for every input.
+	// All inputs read 0 when it's off, which makes the whole expression a constant.
+	if (!Device::Control::InputGateOn())
+		return m_gated_off_value;
+	if (m_single_input)
+		return m_single_input->GetState();
+	return Run(true);
 }
 
 void Expression::SetValue(ControlState value)
 {
-	node->SetValue(value);
+	if (!m_outputs_valid)
+	{
+		node->SetValue(value);
+		return;
+	}
+
+	if (!Device::Control::InputGateOn())
+		return;
+	for (const ExpressionOutput& output : m_outputs)
+		output.output->SetState(output.inverted ? 1.0 - value : value);
+}
+
+void Expression::Compile()
+{
+	ExpressionCompiler compiler;
+	node->Compile(compiler);
+
+	m_program_valid = compiler.program_valid;
+	if (m_program_valid)
+	{
+		m_program = std::move(compiler.program);
+		if (m_program.size() == 1 && m_program[0].op == EXPRESSION_OP_INPUT)
+			m_single_input = m_program[0].input;
+		m_gated_off_value = Run(false);
+	}
+
+	m_outputs_valid = compiler.outputs_valid;
+	if (m_outputs_valid)
+		m_outputs = std::move(compiler.outputs);
 }
 
 Expression::Expression(ExpressionNode* node_)
 {
 	node = node_;
 	num_controls = node->CountNumControls();
+	Compile();
 }
 
 Expression::~Expression()
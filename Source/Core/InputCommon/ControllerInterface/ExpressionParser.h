@@ -6,6 +6,9 @@
 
 #include <memory>
 #include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
 #include "InputCommon/ControllerInterface/Device.h"
 
 namespace ciface
@@ -46,6 +49,28 @@ private:
 	bool is_input;
 };
 
+enum ExpressionOpcode : u8
+{
+	EXPRESSION_OP_ZERO,
+	EXPRESSION_OP_INPUT,
+	EXPRESSION_OP_AND,
+	EXPRESSION_OP_OR,
+	EXPRESSION_OP_ADD,
+	EXPRESSION_OP_NOT,
+};
+
+struct ExpressionInstruction
+{
+	ExpressionOpcode op;
+	Core::Device::Input* input;
+};
+
+struct ExpressionOutput
+{
+	Core::Device::Output* output;
+	bool inverted;
+};
+
 class ExpressionNode;
 class Expression
 {
@@ -57,6 +82,21 @@ public:
 	void SetValue(ControlState state);
 	int num_controls;
 	ExpressionNode* node;
+
+private:
+	void Compile();
+	ControlState Run(bool gate_on) const;
+
+	// The tree lowered to a stack program for inputs and to the list of outputs it drives,
+	// so polling doesn't go through a virtual call per node. Only used when valid, the tree
+	// is kept as a fallback.
+	std::vector<ExpressionInstruction> m_program;
+	Core::Device::Input* m_single_input = nullptr;
+	ControlState m_gated_off_value = 0;
+	bool m_program_valid = false;
+
+	std::vector<ExpressionOutput> m_outputs;
+	bool m_outputs_valid = false;
 };
 
 enum ExpressionParseStatus
@@ -3,12 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <libusb.h>
 #include <mutex>
 #include <iostream>
 #include <chrono>
-#include <deque>
-#include <numeric>
+#include <cstring>
 #include <fstream>
 #include <time.h>
 
@@ -41,20 +41,42 @@ static u8 s_controller_type[MAX_SI_CHANNELS] = {
 		ControllerTypes::CONTROLLER_NONE, ControllerTypes::CONTROLLER_NONE };
 static u8 s_controller_rumble[4];
 
-static const int adapter_payload_size = 37;
+static const int adapter_payload_size = ADAPTER_PAYLOAD_SIZE;
 
-static std::mutex s_mutex;
-static u8 s_controller_payload[adapter_payload_size];
-static u8 s_controller_payload_swap[adapter_payload_size];
-static u8 default_controller_payload[adapter_payload_size]{};
+// Written by the transfer callbacks only, read without locking by Input
+static AdapterReportRing s_reports;
+static ReportTimingEstimator s_timing_estimator;
 
-static std::atomic<int> s_controller_payload_size = { 0 };
+static std::array<LatencyHistogram, MAX_SI_CHANNELS> s_input_latency;
 
-static std::thread s_adapter_input_thread;
-static std::thread s_adapter_output_thread;
-static Common::Flag s_adapter_thread_running;
+static std::atomic<bool> s_capturing_reports{false};
+static std::mutex s_capture_mutex;
+static AdapterReportStream s_captured_reports;
 
-static Common::Event s_rumble_data_available;
+// Input transfers are kept queued at all times, so there's always one pending when the adapter
+// polls the controllers and none of its 1kHz reports gets skipped. All of them complete on the
+// libusb event thread of s_libusb_context.
+static const int ADAPTER_INPUT_TRANSFERS = 4;
+static const unsigned int ADAPTER_TRANSFER_TIMEOUT_MS = 32;
+
+static std::array<libusb_transfer*, ADAPTER_INPUT_TRANSFERS> s_input_transfers{};
+static u8 s_input_buffers[ADAPTER_INPUT_TRANSFERS][adapter_payload_size];
+static libusb_transfer* s_rumble_transfer = nullptr;
+static u8 s_rumble_buffer[5];
+
+// Guards submitting transfers against cancelling them
+static std::mutex s_transfer_mutex;
+static Common::Flag s_transfers_running;
+static bool s_rumble_in_flight = false;
+static bool s_rumble_pending = false;
+static std::atomic<int> s_transfers_in_flight{0};
+static Common::Event s_transfers_done;
+
+// Only touched by the transfer callbacks
+static std::chrono::high_resolution_clock::time_point s_last_report_timing;
+static u8 s_last_good_payload[adapter_payload_size];
+static int s_last_good_payload_size = 0;
+static bool s_has_last_good_payload = false;
 
 static std::mutex s_init_mutex;
 static std::thread s_adapter_detect_thread;
@@ -84,377 +106,252 @@ static std::atomic<bool> external_thread_should_reset_polling_threads = {false};
 static u64 s_consecutive_adapter_errors = 0;
 static u64 s_consecutive_adapter_errors_limit = 100;
 
-// Schmidtt trigger style, start applying if effective report rate > 290Hz, stop if < 260Hz
-static const int stopApplyingEILVOptimsHz = 260;
-static const int startApplyingEILVOptimsHz = 290;
-volatile static bool applyEILVOptims = false;
-
 bool adapter_error = false;
 
 bool AdapterError()
 {
-	return adapter_error && s_adapter_thread_running.IsSet();
+	return adapter_error && s_transfers_running.IsSet();
 }
 
-struct controller_payload_entry
+void ResetAdapterIfNecessary()
 {
-	std::chrono::high_resolution_clock::time_point raw_timing;
-	std::chrono::high_resolution_clock::time_point estimated_timing;
-	u8 controller_payload[adapter_payload_size];
-	controller_payload_entry(std::chrono::high_resolution_clock::time_point tp, u8 *controller_payload)
-	    : raw_timing{tp}
-	{
-		std::copy(controller_payload, controller_payload + adapter_payload_size, this->controller_payload);
-	}
-};
-
-std::deque<controller_payload_entry> controller_payload_entries;
-int controller_payload_limit = 50;
-
-int usbPollingStabilizationDelay = 200'000;
-bool timingReconstructionUsageHistory[1000]{};
-int truhIndex = 0;
-int truhSum = 0;
-
-bool beenUsingTR() {
-	return truhSum > 500;
+	if (external_thread_should_reset_polling_threads)
+		Reset();
 }
-void feedTruh(bool usedTR) {
-	truhSum -= timingReconstructionUsageHistory[truhIndex] ? 1 : 0;
-	truhSum += usedTR ? 1 : 0;
-	timingReconstructionUsageHistory[truhIndex] = usedTR;
-	truhIndex = (truhIndex + 1) % 1000;
+
+bool IsReadingAtReducedRate()
+{
+	return s_consecutive_slow_transfers > 80;
 }
 
-void judgeEILVOptimsApplicability() {
-	if (controller_payload_entries.size() > 10)
+double ReadRate()
+{
+	if (external_thread_should_reset_polling_threads)
 	{
-		double diff =
-		    (controller_payload_entries.front().raw_timing - controller_payload_entries.back().raw_timing).count() /
-		    1'000'000.;
-		double hz = 1000. / ( diff / controller_payload_entries.size() );
-
-		if (!applyEILVOptims && hz > startApplyingEILVOptimsHz)
-			applyEILVOptims = true;
-		else if (applyEILVOptims && hz < stopApplyingEILVOptimsHz)
-			applyEILVOptims = false;
+		Reset();
+		return 1e10;
 	}
+	return s_read_rate;
 }
 
-static void Feed(std::chrono::high_resolution_clock::time_point tp, u8 *controller_payload)
+// Resetting waits for the transfers to be cancelled, which needs the libusb event thread, so
+// that thread can only ask the scanning thread to do it
+static void RequestReset()
 {
-	const SConfig &sconfig = SConfig::GetInstance();
+	external_thread_should_reset_polling_threads = true;
+	s_hotplug_event.Set();
+}
 
-	controller_payload_entries.push_front(controller_payload_entry(tp, controller_payload));
+static void TransferFinished()
+{
+	if (--s_transfers_in_flight == 0)
+		s_transfers_done.Set();
+}
 
-	controller_payload_entry &newEntry = controller_payload_entries.front();
-	judgeEILVOptimsApplicability();
-	
-	size_t size = controller_payload_entries.size();
+#if defined(_WIN32)
+static std::atomic<bool> s_want_high_priority{false};
+static bool s_event_thread_priority_high = false;
 
-	// Do we use USB Polling Stabilization ?
-	// Once we get to having identified differences, do we use TR ? If so, is TR applicable ?
+static void refreshThreadPriorities(const SConfig &sconfig)
+{
+	s_want_high_priority.store(sconfig.bReduceTimingDispersion);
+}
 
-	if (sconfig.bReduceTimingDispersion)
-	{
-		std::vector<int64_t> measures;
-		std::vector<int64_t> offsetsModulo;
-		measures.reserve(size);
-		offsetsModulo.reserve(size);
+// Called from the libusb event thread, which is the one running the transfer callbacks
+static void ApplyEventThreadPriority()
+{
+	const bool high = s_want_high_priority.load();
+	if (high == s_event_thread_priority_high)
+		return;
+	SetThreadPriority(GetCurrentThread(), high ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_NORMAL);
+	s_event_thread_priority_high = high;
+}
+#endif
+
+static void HandleInputReport(std::chrono::high_resolution_clock::time_point now, const u8 *payload,
+	int payload_size, bool success)
+{
+	const SConfig &sconfig = SConfig::GetInstance();
 
-		int64_t latestMeasure = newEntry.raw_timing.time_since_epoch().count();
+	bool reuseOldInputsEnabled = sconfig.bAdapterWarning;
+	adapter_error = !success && reuseOldInputsEnabled;
 
-		for (const controller_payload_entry &entry : controller_payload_entries)
-		{
-			int64_t measure = entry.raw_timing.time_since_epoch().count(); // difference to the last poll in ns
-			measures.push_back(measure);
-		}
+	// With transfers always queued, the time between two completions is the actual polling period
+	double elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - s_last_report_timing).count() / 1000000.0;
+	s_last_report_timing = now;
 
-		for (int64_t measure : measures)
+	if (adapter_error && !external_thread_should_reset_polling_threads)
+	{
+		s_consecutive_adapter_errors++;
+		if (s_consecutive_adapter_errors >= s_consecutive_adapter_errors_limit)
 		{
-			// measure = 2.4 ; latestMeasure = 3.3 => gets pushed back : 0.1
-			// measure = 2.2 ; latestMeasure = 3.3 => gets pushed back : -0.1
-			// ]-0.5;0.5]
-			offsetsModulo.push_back((int64_t)fmod(measure - latestMeasure - 500'000, 1'000'000) + 500'000);
+			s_consecutive_adapter_errors = 0;
+			RequestReset();
+			return;
 		}
+	}
+	else
+	{
+		s_consecutive_adapter_errors = 0;
+	}
 
-		int64_t mean =
-		    (int64_t)(std::accumulate(offsetsModulo.begin(), offsetsModulo.end(), (int64_t)0) / (int64_t)size);
+	AdapterReport report;
+	report.raw_timing = now;
+	report.payload_size = payload_size;
+	memcpy(report.payload, payload, adapter_payload_size);
 
-		std::vector<int64_t> measuresCorrected;
-		for (int64_t measure : measures)
+	// Store previous input and restore in the case of an adapter error
+	if (reuseOldInputsEnabled)
+	{
+		if (!adapter_error)
 		{
-			// measure is 2.4, latestMeasure is 3.5, mean is .1, meaning that timings should be corrected to .5+.1 = .6
-			// measure - latestMeasure - mean = -1.2
-			// entire division by 1ms then * 1ms : -1
-			// + latestMeasure + mean : 2.6
-			measuresCorrected.push_back((int64_t)(round((measure - latestMeasure - mean) / 1'000'000.0)) * 1'000'000 +
-			                            latestMeasure + mean);
+			memcpy(s_last_good_payload, report.payload, adapter_payload_size);
+			s_last_good_payload_size = payload_size;
+			s_has_last_good_payload = true;
 		}
-
-		// Step 2 : we now have polls whose mutual differences are multiples of 1ms
-		// We will now figure out when polls truly happened
-		// In order to do this we will compute the timing differences and look for differences of 2ms
-		// When there's a difference of 2ms, it means no polling happened during the first 1ms,
-		// and that in turn means that a polling therefore happened during the x+1;x+1.2 period
-		// We will assume the polling happened at x+1.1
-		std::vector<int64_t> differences;
-		for (int64_t i = 0; i < (int64_t)(measuresCorrected.size()) - 1; i++)
+		else if (s_has_last_good_payload)
 		{
-			differences.push_back((measuresCorrected[i] - measuresCorrected[i + 1]) / (int64_t)1'000'000);
+			memcpy(report.payload, s_last_good_payload, adapter_payload_size);
+			report.payload_size = s_last_good_payload_size;
 		}
+	}
 
-		// We consider TR is applicable is we find a 111121111211112 pattern
-		// The idea being that when a realignment due to the real period being 1.19971 and not 1.2 happens, the 50 entries won't be a repeating 11112 pattern
-		// We might also have errors. 2 consecutive 11112 can happen randomly, 3 is less likely
-		// If we could tell the official WUP-028 from its clones we could simply check for which ports are active
-		
-		bool appliedTR = false;
+	if(elapsed > 15.0)
+		s_consecutive_slow_transfers++;
+	else
+		s_consecutive_slow_transfers = 0;
 
-		int64_t index1pattern = -1;
-		int64_t index3patterns = -1;
+	s_read_rate = elapsed;
 
-		for (int64_t i = 0; i < (int64_t)(differences.size()) - 14; i++)
-		{
-			if (differences[i] == 2 && std::all_of(differences.begin() + i + 1, differences.begin() + i + 4 + 1,
-				                                    [](const int64_t &x) { return x == 1; }))
-			{
-				if (index1pattern == -1)
-					index1pattern = i;
-				if (differences[i + 5] == 2 &&
-					std::all_of(differences.begin() + i + 5 + 1, differences.begin() + i + 5 + 4 + 1,
-					            [](const int64_t &x) { return x == 1; }) &&
-					differences[i + 10] == 2 &&
-					std::all_of(differences.begin() + i + 10 + 1, differences.begin() + i + 10 + 4 + 1,
-					            [](const int64_t &x) { return x == 1; }))
-				{
-					index3patterns = i;
-					break;
-				}
-			}
-		}
+	s_timing_estimator.Feed(&report, sconfig.bReduceTimingDispersion);
+	s_reports.Publish(report);
 
-		bool shouldUseTR = index3patterns != -1;
-			
-		feedTruh(shouldUseTR);
+	if (s_capturing_reports.load(std::memory_order_relaxed))
+	{
+		std::lock_guard<std::mutex> lk(s_capture_mutex);
+		s_captured_reports.Append(now, report.payload, report.payload_size);
+	}
+}
 
-		// 3 cases:
-		// A We've been using TR and we should use TR this time => TR algorithm
-		// B We've been using TR but we shouldn't use it this time => mean TR offset
-		// C We haven't been using TR => regardless of whether we concluded that we should use it, don't use it
+static void LIBUSB_CALL InputTransferCallback(libusb_transfer *transfer)
+{
+	const std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
 
-		// If we don't use TR in general, we don't need to apply the TR offset
-		// If we keep switching between TR and not, we're going to switch between adding the offset or not which is terrible
-		// Hence the use of a history of TR use, if we could've used (and perhaps we did) TR for 500 out of the 1000 poll feed,
-		// then we are "using it" overall
+#if defined(_WIN32)
+	ApplyEventThreadPriority();
+#endif
 
-		if (beenUsingTR()) // A or B
-		{
-			if (shouldUseTR) // A
-			{
-				// The poll with a 2ms difference is assumed to have happened 0.9ms on average before the timing we obtained
-				// We remove 0.9ms but we correct that to 0.8ms later to match the end of the 0.2ms wide eligibility window for this poll
-				// This is so that the most recent timing possible (11112 case; 1ms - 4*0.2ms) is "now"
-
-				int64_t latestDiff2Estimation = measuresCorrected[index1pattern] - 800'000;
-
-				// We can't just multiply the index of differences by 1.2 ; we could do that if we were sure there
-				// are only 1s after the 2. But missing polls happen when the CPU is under strain, so we have to
-				// account for that.
-
-				int64_t diff = (int64_t)std::llround(
-					((measuresCorrected[0] - 300'000.) - latestDiff2Estimation) /
-					1'200'000.);
-				int64_t newPollEstimation = diff * 1'200'000 + latestDiff2Estimation;
-				newEntry.estimated_timing =
-					std::chrono::high_resolution_clock::time_point(std::chrono::nanoseconds(newPollEstimation));
-
-				// Full example scenario:
-				// Measures corrected:         9         8         7         6         5         4         3         1      (i.e, a poll
-				// came in at t=10ms, t=8ms, etc) Note that here the 8 is unexpected
-				// measuresCorrected[index1pattern] : 3
-				// latestDiff2Estimation : 2.2 (upper extremity of the [2.2;2.0] range the poll belongs to
-				// Measures corrected -0.3:    8.7       7.7       6.7       5.7       4.7       3.7       2.7
-				// Minus latestDiffEstimation: 6.5       5.5       4.5       3.5       2.5       1.5       0.5
-				// Associated 1.2 range:       [6.6;5.4] [6.6;5.4] [5.4;4.2] [4.2;3]   [3;1.8]   [1.8;0.6] [0.6;-0.6]
-				// Diff:                       5         5         4         3         2         1         0
-				// newPollEstimation:          8.2       8.2(yes)  7         5.8       4.6       3.4       2.2
-				// The rationale behind estimating 8 to 8.2 is that it is probably a correction from the fact the real polling period is 1.19971ms
-				// and not 1.2ms: the next poll come in 2ms later (example is for demonstration purpose, you should never have both the 8 and 9 here)
-				// and we will estimate the incoming 10 as 9.2 from now on (the 8 would therefore have been 8) 8.2 is closer to 8 than 7
-			}
-			else // B
-			{
-				newEntry.estimated_timing = newEntry.raw_timing - std::chrono::nanoseconds(400'000);
-				// On average, it's -0.4
-				// Reason is simple: in a proper cycle of 5, we correct the entry after a 2ms silence by -0.8
-				// Then the 4 subsequent entries by -0.6 -0.4 -0.2 0
-				// We correct entries by -0.4 on average, what matters is what happens to the entries
-				// There is no "weighting" to do based on how much time an entry is the last available
-			}
+	if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE)
+		RequestReset();
+	else if (transfer->status != LIBUSB_TRANSFER_CANCELLED && s_transfers_running.IsSet())
+		HandleInputReport(now, transfer->buffer, transfer->actual_length,
+			transfer->status == LIBUSB_TRANSFER_COMPLETED);
 
-			appliedTR = true;
-		}
-		if (!appliedTR) // C
+	{
+		std::lock_guard<std::mutex> lk(s_transfer_mutex);
+		if (s_transfers_running.IsSet() && !external_thread_should_reset_polling_threads &&
+			transfer->status != LIBUSB_TRANSFER_NO_DEVICE && libusb_submit_transfer(transfer) == LIBUSB_SUCCESS)
 		{
-			int64_t mean =
-			    (int64_t)(std::accumulate(offsetsModulo.begin(), offsetsModulo.end(), (int64_t)0) / (int64_t)size);
-
-			int64_t newEntryEstimatedTiming = latestMeasure + mean;
-			newEntry.estimated_timing =
-			    std::chrono::high_resolution_clock::time_point(std::chrono::nanoseconds(newEntryEstimatedTiming));
+			return;
 		}
 	}
-	else
-	{
-		newEntry.estimated_timing = newEntry.raw_timing; // Will be used if ES is used, otherwise not used. We fill it either way
-	}
-
-	if (controller_payload_entries.size() > controller_payload_limit)
-		controller_payload_entries.pop_back();
+	TransferFinished();
 }
 
-const u8 *Fetch(std::chrono::high_resolution_clock::time_point *tp)
+static void LIBUSB_CALL RumbleTransferCallback(libusb_transfer *transfer);
+
+// Needs s_transfer_mutex
+static void SubmitRumbleLocked()
 {
-	const SConfig &sconfig = SConfig::GetInstance();
+	if (!s_transfers_running.IsSet() || s_rumble_transfer == nullptr)
+		return;
 
-	if (applyEILVOptims && sconfig.bReduceTimingDispersion && tp != nullptr)
+	// Only one rumble transfer at a time, the latest state gets sent once it completes
+	if (s_rumble_in_flight)
 	{
-		for (auto entry = controller_payload_entries.begin(); entry != controller_payload_entries.end(); entry++)
-		{
-			// We also have to account for small variations in reception time, plus processing time, hence the offset.
-			// Our estimation assumes the initial "2ms difference" true poll timing is at the end of the 0.2ms wide window.
-			// *tp - offset > x <=> *tp > x + offset
-			// The more you pretend things haven't happened yet when they have, the more room you have to work with.
-			// Finally, we are, under normal circumstances, reconstructing timings between 0 and 0.8ms ago.
-			// So we need to delay the timings by 0.8ms, otherwise, we would be writing the past.
-			// Plus some offset to account for the 1000Hz alignment of controller timings done in the process.
-
-			if (*tp > (beenUsingTR()
-			               ? entry->estimated_timing + std::chrono::nanoseconds(usbPollingStabilizationDelay)
-			                         + std::chrono::nanoseconds(800'000)
-			               : entry->estimated_timing + std::chrono::nanoseconds(usbPollingStabilizationDelay)))
-			{ // tp is the time queried for, if it is more recent than the one
-				// stored and we've got to this point, we should return
-				return entry->controller_payload;
-			}
-		}
+		s_rumble_pending = true;
+		return;
 	}
-	if (controller_payload_entries.size() == 0)
+
+	s_rumble_buffer[0] = 0x11;
+	std::copy(std::begin(s_controller_rumble), std::end(s_controller_rumble), s_rumble_buffer + 1);
+	libusb_fill_interrupt_transfer(s_rumble_transfer, s_handle, s_endpoint_out, s_rumble_buffer,
+		sizeof(s_rumble_buffer), RumbleTransferCallback, nullptr, ADAPTER_TRANSFER_TIMEOUT_MS);
+	if (libusb_submit_transfer(s_rumble_transfer) == LIBUSB_SUCCESS)
 	{
-		return default_controller_payload;
+		s_rumble_in_flight = true;
+		s_transfers_in_flight++;
 	}
-	return controller_payload_entries.front().controller_payload;
 }
 
-void ResetAdapterIfNecessary()
+static void SubmitRumble()
 {
-	if (external_thread_should_reset_polling_threads)
-		Reset();
+	std::lock_guard<std::mutex> lk(s_transfer_mutex);
+	SubmitRumbleLocked();
 }
 
-bool IsReadingAtReducedRate()
+static void LIBUSB_CALL RumbleTransferCallback(libusb_transfer *transfer)
 {
-	return s_consecutive_slow_transfers > 80;
-}
-
-double ReadRate()
-{
-	if (external_thread_should_reset_polling_threads)
 	{
-		Reset();
-		return 1e10;
+		std::lock_guard<std::mutex> lk(s_transfer_mutex);
+		s_rumble_in_flight = false;
+		if (s_rumble_pending && transfer->status != LIBUSB_TRANSFER_NO_DEVICE)
+			SubmitRumbleLocked();
+		s_rumble_pending = false;
 	}
-	return s_read_rate;
+	TransferFinished();
 }
 
-static void Read()
+static void StartTransfers()
 {
-	const SConfig &sconfig = SConfig::GetInstance();
-	
 	s_consecutive_slow_transfers = 0;
+	s_consecutive_adapter_errors = 0;
 	adapter_error = false;
-
-	u8 bkp_payload_swap[adapter_payload_size];
-	int bkp_payload_size = 0;
-	bool has_prev_input = false;
 	s_read_rate = 0.0;
+	s_has_last_good_payload = false;
+	s_last_report_timing = std::chrono::high_resolution_clock::now();
 
-	int payload_size = 0;
-	while (s_adapter_thread_running.IsSet())
-	{
-		bool reuseOldInputsEnabled = SConfig::GetInstance().bAdapterWarning;
-		std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
-		adapter_error = libusb_interrupt_transfer(s_handle, s_endpoint_in, s_controller_payload_swap,
-			sizeof(s_controller_payload_swap), &payload_size, 32) != LIBUSB_SUCCESS && reuseOldInputsEnabled;
-		std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
-
-		double elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count() / 1000000.0;
-
-		if (adapter_error && !external_thread_should_reset_polling_threads)
-		{
-			s_consecutive_adapter_errors++;
-			if (s_consecutive_adapter_errors >= s_consecutive_adapter_errors_limit)
-			{
-				s_consecutive_adapter_errors = 0;
-				external_thread_should_reset_polling_threads = true;
-				return;
-			}
-		}
-		else
-		{
-			s_consecutive_adapter_errors = 0;
-		}
-		// Store previous input and restore in the case of an adapter error
-		if (reuseOldInputsEnabled)
-		{
-			if (!adapter_error)
-			{
-				memcpy(bkp_payload_swap, s_controller_payload_swap, adapter_payload_size);
-				bkp_payload_size = payload_size;
-				has_prev_input = true;
-			}
-			else if (has_prev_input)
-			{
-				memcpy(s_controller_payload_swap, bkp_payload_swap, adapter_payload_size);
-				payload_size = bkp_payload_size;
-			}
-		}
+	std::lock_guard<std::mutex> lk(s_transfer_mutex);
+	s_transfers_running.Set(true);
 
-		if(elapsed > 15.0)
-			s_consecutive_slow_transfers++;
+	for (int i = 0; i < ADAPTER_INPUT_TRANSFERS; i++)
+	{
+		s_input_transfers[i] = libusb_alloc_transfer(0);
+		libusb_fill_interrupt_transfer(s_input_transfers[i], s_handle, s_endpoint_in, s_input_buffers[i],
+			adapter_payload_size, InputTransferCallback, nullptr, ADAPTER_TRANSFER_TIMEOUT_MS);
+		int ret = libusb_submit_transfer(s_input_transfers[i]);
+		if (ret == LIBUSB_SUCCESS)
+			s_transfers_in_flight++;
 		else
-			s_consecutive_slow_transfers = 0;
-
-		s_read_rate = elapsed;
-		
-		{
-			std::lock_guard<std::mutex> lk(s_mutex);
-			Feed(now,
-			      s_controller_payload_swap); // TODO Clean usage of payload swap since we don't use it anymore. Also rn
-			                                  // we get old input from s_controller_payload_swap which would be empty
-			// Reading the last available input is implemented naturally in the input queue, do it this way
-			s_controller_payload_size.store(payload_size);
-		}
-
-		Common::YieldCPU();
+			ERROR_LOG(SERIALINTERFACE, "libusb_submit_transfer failed with error: %d", ret);
 	}
+	s_rumble_transfer = libusb_alloc_transfer(0);
 }
 
-static void Write()
+static void StopTransfers()
 {
-	int size = 0;
-	while (s_adapter_thread_running.IsSet())
 	{
-		if (s_rumble_data_available.WaitFor(std::chrono::milliseconds(100)))
-		{
-			unsigned char rumble[5] = {0x11, s_controller_rumble[0], s_controller_rumble[1], s_controller_rumble[2],
-			                           s_controller_rumble[3]};
-			libusb_interrupt_transfer(s_handle, s_endpoint_out, rumble, sizeof(rumble), &size, 32);
-		}
+		std::lock_guard<std::mutex> lk(s_transfer_mutex);
+		s_transfers_running.Clear();
+		// Transfers whose callback is running right now won't be found, but they won't be
+		// submitted again either
+		for (libusb_transfer *transfer : s_input_transfers)
+			libusb_cancel_transfer(transfer);
+		if (s_rumble_in_flight)
+			libusb_cancel_transfer(s_rumble_transfer);
 	}
 
-	s_rumble_data_available.Reset();
+	while (s_transfers_in_flight.load() != 0)
+		s_transfers_done.WaitFor(std::chrono::milliseconds(100));
+
+	for (libusb_transfer *&transfer : s_input_transfers)
+	{
+		libusb_free_transfer(transfer);
+		transfer = nullptr;
+	}
+	libusb_free_transfer(s_rumble_transfer);
+	s_rumble_transfer = nullptr;
+	s_rumble_pending = false;
 }
 
 #if defined(LIBUSB_API_VERSION) && LIBUSB_API_VERSION >= 0x01000102
@@ -469,7 +366,7 @@ static int HotplugCallback(libusb_context* ctx, libusb_device* dev, libusb_hotpl
 	else if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT)
 	{
 		if (s_handle != nullptr && libusb_get_device(s_handle) == dev)
-			Reset();
+			RequestReset();
 	}
 	return 0;
 }
@@ -497,6 +394,9 @@ static void ScanThreadFunc()
 
 	while (s_adapter_detect_thread_running.IsSet())
 	{
+		if (external_thread_should_reset_polling_threads)
+			Reset();
+
 		if (s_handle == nullptr)
 		{
 			std::lock_guard<std::mutex> lk(s_init_mutex);
@@ -653,25 +553,6 @@ static bool CheckDeviceAccess(libusb_device* device)
 	return false;
 }
 
-#if defined(_WIN32)
-bool threadPrioritiesAreHigh = false;
-static void refreshThreadPriorities(const SConfig &sconfig)
-{
-	if (sconfig.bReduceTimingDispersion && !threadPrioritiesAreHigh)
-	{
-		SetThreadPriority(s_adapter_input_thread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL);
-		SetThreadPriority(s_adapter_output_thread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL);
-		threadPrioritiesAreHigh = true;
-	}
-	else if ((!sconfig.bReduceTimingDispersion) && threadPrioritiesAreHigh)
-	{
-		SetThreadPriority(s_adapter_input_thread.native_handle(), THREAD_PRIORITY_NORMAL);
-		SetThreadPriority(s_adapter_output_thread.native_handle(), THREAD_PRIORITY_NORMAL);
-		threadPrioritiesAreHigh = false;
-	}
-}
-#endif
-
 static void AddGCAdapter(libusb_device *device)
 {
 	libusb_config_descriptor *config = nullptr;
@@ -697,23 +578,13 @@ static void AddGCAdapter(libusb_device *device)
 	unsigned char payload = 0x13;
 	libusb_interrupt_transfer(s_handle, s_endpoint_out, &payload, sizeof(payload), &tmp, 32);
 
-	s_adapter_thread_running.Set(true);
-
-	const SConfig &sconfig = SConfig::GetInstance();
-
-	s_adapter_input_thread = std::thread(Read);
-	s_adapter_output_thread = std::thread(Write);
-
 	#if defined(_WIN32)
 	SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
-	if (sconfig.bReduceTimingDispersion)
-	{
-		threadPrioritiesAreHigh = true;
-		SetThreadPriority(s_adapter_input_thread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL);
-		SetThreadPriority(s_adapter_output_thread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL);
-	}
+	refreshThreadPriorities(SConfig::GetInstance());
 	#endif
 
+	StartTransfers();
+
 	s_detected = true;
 	if (s_detect_callback != nullptr)
 		s_detect_callback();
@@ -742,17 +613,26 @@ static void Reset()
 
 	external_thread_should_reset_polling_threads = false;
 	
-	if (s_adapter_thread_running.TestAndClear())
-	{
-		s_adapter_input_thread.join();
-		s_adapter_output_thread.join();
-	}
+	if (s_transfers_running.IsSet())
+		StopTransfers();
 
 	for (int i = 0; i < MAX_SI_CHANNELS; i++)
 		s_controller_type[i] = ControllerTypes::CONTROLLER_NONE;
 
 	s_detected = false;
 
+	for (int i = 0; i < MAX_SI_CHANNELS; i++)
+	{
+		const LatencyStats stats = s_input_latency[i].GetStats();
+		if (stats.count == 0)
+			continue;
+		NOTICE_LOG(SERIALINTERFACE,
+			"GC Adapter port %d input latency over %llu polls: min %.2fms, mean %.2fms, p50 %.2fms, "
+			"p95 %.2fms, p99 %.2fms, max %.2fms",
+			i + 1, (unsigned long long)stats.count, stats.min_ns / 1e6, stats.mean_ns / 1e6,
+			stats.p50_ns / 1e6, stats.p95_ns / 1e6, stats.p99_ns / 1e6, stats.max_ns / 1e6);
+	}
+
 	if (s_handle)
 	{
 		libusb_release_interface(s_handle, 0);
@@ -764,7 +644,7 @@ static void Reset()
 	NOTICE_LOG(SERIALINTERFACE, "GC Adapter detached");
 }
 
-GCPadStatus Input(int chan, std::chrono::high_resolution_clock::time_point *tp)
+GCPadStatus Input(int chan, std::chrono::high_resolution_clock::time_point *tp, bool record_latency)
 {
 	if (!UseAdapter())
 		return{};
@@ -784,18 +664,17 @@ GCPadStatus Input(int chan, std::chrono::high_resolution_clock::time_point *tp)
 		return{};
 	}
 
-	int payload_size = 0;
-	u8 controller_payload_copy[adapter_payload_size];
-
+	AdapterReport report;
+	if (FetchReport(s_reports, tp, sconfig.bReduceTimingDispersion, &report) && record_latency)
 	{
-		std::lock_guard<std::mutex> lk(s_mutex);
-		const u8 *controller_payload = Fetch(tp);
-		std::copy(controller_payload, controller_payload + adapter_payload_size, controller_payload_copy);
-		payload_size = s_controller_payload_size.load();
+		s_input_latency[chan].Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::high_resolution_clock::now() - report.raw_timing).count());
 	}
+	const int payload_size = report.payload_size;
+	const u8* controller_payload_copy = report.payload;
 
 	GCPadStatus pad = {};
-	if (payload_size != sizeof(controller_payload_copy) ||
+	if (payload_size != adapter_payload_size ||
 		controller_payload_copy[0] != LIBUSB_DT_HID)
 	{
 		// This can occur for a few frames on initialization.
@@ -872,6 +751,35 @@ GCPadStatus Input(int chan, std::chrono::high_resolution_clock::time_point *tp)
 	return pad;
 }
 
+LatencyStats GetInputLatency(int chan)
+{
+	return s_input_latency[chan].GetStats();
+}
+
+void ResetInputLatency()
+{
+	for (LatencyHistogram& histogram : s_input_latency)
+		histogram.Reset();
+}
+
+void StartReportCapture()
+{
+	std::lock_guard<std::mutex> lk(s_capture_mutex);
+	s_captured_reports.Clear();
+	s_capturing_reports.store(true);
+}
+
+bool StopReportCapture(const std::string& filename)
+{
+	std::lock_guard<std::mutex> lk(s_capture_mutex);
+	s_capturing_reports.store(false);
+	bool saved = s_captured_reports.Save(filename);
+	s_captured_reports.Clear();
+	if (!saved)
+		ERROR_LOG(SERIALINTERFACE, "Failed to save GC Adapter reports to %s", filename.c_str());
+	return saved;
+}
+
 bool DeviceConnected(int chan)
 {
 	return s_controller_type[chan] != ControllerTypes::CONTROLLER_NONE;
@@ -904,7 +812,7 @@ static void ResetRumbleLockNeeded()
 
 	std::fill(std::begin(s_controller_rumble), std::end(s_controller_rumble), 0);
 
-	s_rumble_data_available.Set();
+	SubmitRumble();
 }
 
 void Output(int chan, u8 rumble_command)
@@ -917,7 +825,7 @@ void Output(int chan, u8 rumble_command)
 		s_controller_type[chan] != ControllerTypes::CONTROLLER_WIRELESS)
 	{
 		s_controller_rumble[chan] = rumble_command;
-		s_rumble_data_available.Set();
+		SubmitRumble();
 	}
 }
 
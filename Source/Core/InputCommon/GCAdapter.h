@@ -4,9 +4,12 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
+#include <string>
 
 #include "Common/CommonTypes.h"
+#include "InputCommon/GCAdapterReports.h"
 
 struct GCPadStatus;
 
@@ -29,8 +32,17 @@ void Shutdown();
 void SetAdapterCallback(std::function<void(void)> func);
 void StartScanThread();
 void StopScanThread();
-GCPadStatus Input(int chan, std::chrono::high_resolution_clock::time_point *tp=nullptr);
+// record_latency is false for reads that don't feed the emulated pad
+GCPadStatus Input(int chan, std::chrono::high_resolution_clock::time_point *tp=nullptr,
+	bool record_latency=true);
 void Output(int chan, u8 rumble_command);
+// Delay between a report being read from USB and it being polled by SI, for each port
+LatencyStats GetInputLatency(int chan);
+void ResetInputLatency();
+// Records every report read from the adapter until StopReportCapture, which saves them in
+// a stream that AdapterReportStream can load and replay
+void StartReportCapture();
+bool StopReportCapture(const std::string& filename);
 bool IsDetected();
 bool IsDriverDetected();
 bool DeviceConnected(int chan);
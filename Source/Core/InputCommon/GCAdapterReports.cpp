@@ -0,0 +1,419 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Common/FileUtil.h"
+#include "InputCommon/GCAdapterReports.h"
+
+namespace GCAdapter
+{
+// How many reports back FetchReport looks for one that matches the poll timing
+static const u32 FETCH_HISTORY = 50;
+static const s64 USB_POLLING_STABILIZATION_DELAY_NS = 200'000;
+
+static const u32 STREAM_MAGIC = 0x52414347;  // "GCAR"
+static const u32 STREAM_VERSION = 1;
+
+static s64 ToNanoseconds(time_point tp)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+static time_point FromNanoseconds(s64 ns)
+{
+	return time_point(std::chrono::duration_cast<time_point::duration>(std::chrono::nanoseconds(ns)));
+}
+
+void AdapterReportRing::Publish(const AdapterReport& report)
+{
+	const u32 n = m_published.load(std::memory_order_relaxed);
+	Slot& slot = m_slots[n & (CAPACITY - 1)];
+
+	slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.report = report;
+	slot.sequence.store(2 * n + 2, std::memory_order_release);
+
+	m_published.store(n + 1, std::memory_order_release);
+}
+
+bool AdapterReportRing::Read(u32 n, AdapterReport* report) const
+{
+	const Slot& slot = m_slots[n & (CAPACITY - 1)];
+	const u32 sequence = 2 * n + 2;
+
+	if (slot.sequence.load(std::memory_order_acquire) != sequence)
+		return false;
+	*report = slot.report;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+void AdapterReportRing::Reset()
+{
+	for (Slot& slot : m_slots)
+		slot.sequence.store(0, std::memory_order_relaxed);
+	m_published.store(0, std::memory_order_release);
+}
+
+s64 ReportTimingEstimator::Measure(u32 age) const
+{
+	return m_history[(m_newest + HISTORY_SIZE - age) % HISTORY_SIZE];
+}
+
+void ReportTimingEstimator::FeedTRUsage(bool used_tr)
+{
+	m_tr_usage_sum -= m_tr_usage[m_tr_usage_index] ? 1 : 0;
+	m_tr_usage_sum += used_tr ? 1 : 0;
+	m_tr_usage[m_tr_usage_index] = used_tr;
+	m_tr_usage_index = (m_tr_usage_index + 1) % m_tr_usage.size();
+}
+
+void ReportTimingEstimator::JudgeEILVOptimsApplicability()
+{
+	if (m_count > 10)
+	{
+		double diff = (Measure(0) - Measure(m_count - 1)) / 1'000'000.;
+		double hz = 1000. / (diff / m_count);
+
+		if (!m_eilv_optims && hz > 290)
+			m_eilv_optims = true;
+		else if (m_eilv_optims && hz < 260)
+			m_eilv_optims = false;
+	}
+}
+
+void ReportTimingEstimator::Feed(AdapterReport* report, bool reduce_timing_dispersion)
+{
+	m_newest = (m_newest + 1) % HISTORY_SIZE;
+	m_history[m_newest] = ToNanoseconds(report->raw_timing);
+	m_count = std::min<u32>(m_count + 1, HISTORY_SIZE);
+
+	JudgeEILVOptimsApplicability();
+	report->eilv_optims = m_eilv_optims;
+
+	if (!reduce_timing_dispersion)
+	{
+		// Will be used if ES is used, otherwise not used. We fill it either way
+		report->estimated_timing = report->raw_timing;
+		report->timing_reconstruction = BeenUsingTR();
+		return;
+	}
+
+	// Do we use USB Polling Stabilization ?
+	// Once we get to having identified differences, do we use TR ? If so, is TR applicable ?
+
+	const u32 size = m_count;
+	const s64 latest_measure = Measure(0);
+
+	s64 offsets_sum = 0;
+	for (u32 i = 0; i < size; i++)
+	{
+		// measure = 2.4 ; latestMeasure = 3.3 => gets pushed back : 0.1
+		// measure = 2.2 ; latestMeasure = 3.3 => gets pushed back : -0.1
+		// ]-0.5;0.5]
+		offsets_sum +=
+		    (s64)fmod((double)(Measure(i) - latest_measure - 500'000), 1'000'000.) + 500'000;
+	}
+	const s64 mean = offsets_sum / (s64)size;
+
+	std::array<s64, HISTORY_SIZE> measures_corrected;
+	for (u32 i = 0; i < size; i++)
+	{
+		// measure is 2.4, latestMeasure is 3.5, mean is .1, meaning that timings should be corrected to .5+.1 = .6
+		// measure - latestMeasure - mean = -1.2
+		// entire division by 1ms then * 1ms : -1
+		// + latestMeasure + mean : 2.6
+		measures_corrected[i] =
+		    (s64)(round((Measure(i) - latest_measure - mean) / 1'000'000.0)) * 1'000'000 +
+		    latest_measure + mean;
+	}
+
+	// Step 2 : we now have polls whose mutual differences are multiples of 1ms
+	// We will now figure out when polls truly happened
+	// In order to do this we will compute the timing differences and look for differences of 2ms
+	// When there's a difference of 2ms, it means no polling happened during the first 1ms,
+	// and that in turn means that a polling therefore happened during the x+1;x+1.2 period
+	// We will assume the polling happened at x+1.1
+	std::array<s64, HISTORY_SIZE - 1> differences;
+	const s64 num_differences = (s64)size - 1;
+	for (s64 i = 0; i < num_differences; i++)
+		differences[i] = (measures_corrected[i] - measures_corrected[i + 1]) / 1'000'000;
+
+	// We consider TR is applicable is we find a 111121111211112 pattern
+	// The idea being that when a realignment due to the real period being 1.19971 and not 1.2 happens, the 50 entries won't be a repeating 11112 pattern
+	// We might also have errors. 2 consecutive 11112 can happen randomly, 3 is less likely
+	// If we could tell the official WUP-028 from its clones we could simply check for which ports are active
+	auto is_cycle = [&differences](s64 i) {
+		return differences[i] == 2 && differences[i + 1] == 1 && differences[i + 2] == 1 &&
+		       differences[i + 3] == 1 && differences[i + 4] == 1;
+	};
+
+	s64 index1pattern = -1;
+	s64 index3patterns = -1;
+	for (s64 i = 0; i < num_differences - 14; i++)
+	{
+		if (is_cycle(i))
+		{
+			if (index1pattern == -1)
+				index1pattern = i;
+			if (is_cycle(i + 5) && is_cycle(i + 10))
+			{
+				index3patterns = i;
+				break;
+			}
+		}
+	}
+
+	bool should_use_tr = index3patterns != -1;
+	FeedTRUsage(should_use_tr);
+	report->timing_reconstruction = BeenUsingTR();
+
+	// 3 cases:
+	// A We've been using TR and we should use TR this time => TR algorithm
+	// B We've been using TR but we shouldn't use it this time => mean TR offset
+	// C We haven't been using TR => regardless of whether we concluded that we should use it, don't use it
+
+	// If we don't use TR in general, we don't need to apply the TR offset
+	// If we keep switching between TR and not, we're going to switch between adding the offset or not which is terrible
+	// Hence the use of a history of TR use, if we could've used (and perhaps we did) TR for 500 out of the 1000 poll feed,
+	// then we are "using it" overall
+
+	if (!BeenUsingTR())  // C
+	{
+		report->estimated_timing = FromNanoseconds(latest_measure + mean);
+	}
+	else if (should_use_tr)  // A
+	{
+		// The poll with a 2ms difference is assumed to have happened 0.9ms on average before the timing we obtained
+		// We remove 0.9ms but we correct that to 0.8ms later to match the end of the 0.2ms wide eligibility window for this poll
+		// This is so that the most recent timing possible (11112 case; 1ms - 4*0.2ms) is "now"
+		s64 latest_diff2_estimation = measures_corrected[index1pattern] - 800'000;
+
+		// We can't just multiply the index of differences by 1.2 ; we could do that if we were sure there
+		// are only 1s after the 2. But missing polls happen when the CPU is under strain, so we have to
+		// account for that.
+		s64 diff = (s64)std::llround(
+		    ((measures_corrected[0] - 300'000.) - latest_diff2_estimation) / 1'200'000.);
+		report->estimated_timing = FromNanoseconds(diff * 1'200'000 + latest_diff2_estimation);
+
+		// Full example scenario:
+		// Measures corrected:         9         8         7         6         5         4         3         1      (i.e, a poll
+		// came in at t=10ms, t=8ms, etc) Note that here the 8 is unexpected
+		// measuresCorrected[index1pattern] : 3
+		// latestDiff2Estimation : 2.2 (upper extremity of the [2.2;2.0] range the poll belongs to
+		// Measures corrected -0.3:    8.7       7.7       6.7       5.7       4.7       3.7       2.7
+		// Minus latestDiffEstimation: 6.5       5.5       4.5       3.5       2.5       1.5       0.5
+		// Associated 1.2 range:       [6.6;5.4] [6.6;5.4] [5.4;4.2] [4.2;3]   [3;1.8]   [1.8;0.6] [0.6;-0.6]
+		// Diff:                       5         5         4         3         2         1         0
+		// newPollEstimation:          8.2       8.2(yes)  7         5.8       4.6       3.4       2.2
+		// The rationale behind estimating 8 to 8.2 is that it is probably a correction from the fact the real polling period is 1.19971ms
+		// and not 1.2ms: the next poll come in 2ms later (example is for demonstration purpose, you should never have both the 8 and 9 here)
+		// and we will estimate the incoming 10 as 9.2 from now on (the 8 would therefore have been 8) 8.2 is closer to 8 than 7
+	}
+	else  // B
+	{
+		// On average, it's -0.4
+		// Reason is simple: in a proper cycle of 5, we correct the entry after a 2ms silence by -0.8
+		// Then the 4 subsequent entries by -0.6 -0.4 -0.2 0
+		// We correct entries by -0.4 on average, what matters is what happens to the entries
+		// There is no "weighting" to do based on how much time an entry is the last available
+		report->estimated_timing = report->raw_timing - std::chrono::nanoseconds(400'000);
+	}
+}
+
+bool FetchReport(const AdapterReportRing& ring, const time_point* tp, bool reduce_timing_dispersion,
+	AdapterReport* report)
+{
+	// The latest report can only be overwritten if the writer lapped the whole ring while we were
+	// copying it, just try again with the new latest one
+	u32 published;
+	do
+	{
+		published = ring.Published();
+		if (published == 0)
+			return false;
+	} while (!ring.Read(published - 1, report));
+
+	if (!report->eilv_optims || !reduce_timing_dispersion || tp == nullptr)
+		return true;
+
+	// We also have to account for small variations in reception time, plus processing time, hence the offset.
+	// Our estimation assumes the initial "2ms difference" true poll timing is at the end of the 0.2ms wide window.
+	// *tp - offset > x <=> *tp > x + offset
+	// The more you pretend things haven't happened yet when they have, the more room you have to work with.
+	// Finally, we are, under normal circumstances, reconstructing timings between 0 and 0.8ms ago.
+	// So we need to delay the timings by 0.8ms, otherwise, we would be writing the past.
+	// Plus some offset to account for the 1000Hz alignment of controller timings done in the process.
+	const std::chrono::nanoseconds delay(USB_POLLING_STABILIZATION_DELAY_NS +
+		(report->timing_reconstruction ? 800'000 : 0));
+
+	if (*tp > report->estimated_timing + delay)
+		return true;
+
+	const u32 depth = std::min(published, FETCH_HISTORY);
+	AdapterReport candidate;
+	for (u32 age = 1; age < depth; age++)
+	{
+		// Overwritten, everything older is gone too
+		if (!ring.Read(published - 1 - age, &candidate))
+			break;
+		// tp is the time queried for, if it is more recent than the one
+		// stored and we've got to this point, we should return
+		if (*tp > candidate.estimated_timing + delay)
+		{
+			*report = candidate;
+			return true;
+		}
+	}
+
+	// Nothing old enough, keep the latest report
+	return true;
+}
+
+void LatencyHistogram::Record(s64 latency_ns)
+{
+	const u64 ns = std::max<s64>(latency_ns, 0);
+	const u64 bucket = std::min<u64>(ns / BUCKET_WIDTH_NS, NUM_BUCKETS - 1);
+
+	m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	m_sum_ns.fetch_add(ns, std::memory_order_relaxed);
+	m_count.fetch_add(1, std::memory_order_relaxed);
+
+	u64 min = m_min_ns.load(std::memory_order_relaxed);
+	while (ns < min && !m_min_ns.compare_exchange_weak(min, ns, std::memory_order_relaxed))
+	{
+	}
+	u64 max = m_max_ns.load(std::memory_order_relaxed);
+	while (ns > max && !m_max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+	{
+	}
+}
+
+LatencyStats LatencyHistogram::GetStats() const
+{
+	LatencyStats stats{};
+	std::array<u32, NUM_BUCKETS> buckets;
+	u64 total = 0;
+	for (size_t i = 0; i < buckets.size(); i++)
+	{
+		buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+		total += buckets[i];
+	}
+	if (total == 0)
+		return stats;
+
+	stats.count = m_count.load(std::memory_order_relaxed);
+	stats.min_ns = m_min_ns.load(std::memory_order_relaxed);
+	stats.max_ns = m_max_ns.load(std::memory_order_relaxed);
+	stats.mean_ns = m_sum_ns.load(std::memory_order_relaxed) / std::max<u64>(stats.count, 1);
+
+	// Percentiles are the upper bound of the bucket they fall in
+	auto percentile = [&](u64 permille) {
+		const u64 rank = std::max<u64>((total * permille + 999) / 1000, 1);
+		u64 seen = 0;
+		for (size_t i = 0; i < buckets.size(); i++)
+		{
+			seen += buckets[i];
+			if (seen >= rank)
+				return std::min<u64>((i + 1) * BUCKET_WIDTH_NS, stats.max_ns);
+		}
+		return stats.max_ns;
+	};
+	stats.p50_ns = percentile(500);
+	stats.p95_ns = percentile(950);
+	stats.p99_ns = percentile(990);
+	return stats;
+}
+
+void LatencyHistogram::Reset()
+{
+	for (auto& bucket : m_buckets)
+		bucket.store(0, std::memory_order_relaxed);
+	m_count.store(0, std::memory_order_relaxed);
+	m_sum_ns.store(0, std::memory_order_relaxed);
+	m_min_ns.store(UINT64_MAX, std::memory_order_relaxed);
+	m_max_ns.store(0, std::memory_order_relaxed);
+}
+
+void AdapterReportStream::Append(time_point raw_timing, const u8* payload, int payload_size)
+{
+	if (m_entries.empty())
+		m_start = raw_timing;
+
+	Entry entry;
+	entry.offset_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(raw_timing - m_start).count();
+	entry.payload_size = std::min<int>(payload_size, ADAPTER_PAYLOAD_SIZE);
+	memcpy(entry.payload, payload, ADAPTER_PAYLOAD_SIZE);
+	m_entries.push_back(entry);
+}
+
+void AdapterReportStream::Clear()
+{
+	m_entries.clear();
+}
+
+bool AdapterReportStream::Save(const std::string& filename) const
+{
+	File::IOFile file(filename, "wb");
+	if (!file)
+		return false;
+
+	const u32 header[3] = {STREAM_MAGIC, STREAM_VERSION, (u32)m_entries.size()};
+	if (!file.WriteArray(header, 3))
+		return false;
+
+	for (const Entry& entry : m_entries)
+	{
+		const u8 payload_size = (u8)entry.payload_size;
+		if (!file.WriteArray(&entry.offset_ns, 1) || !file.WriteArray(&payload_size, 1) ||
+			!file.WriteArray(entry.payload, ADAPTER_PAYLOAD_SIZE))
+			return false;
+	}
+	return true;
+}
+
+bool AdapterReportStream::Load(const std::string& filename)
+{
+	m_entries.clear();
+
+	File::IOFile file(filename, "rb");
+	u32 header[3];
+	if (!file.ReadArray(header, 3) || header[0] != STREAM_MAGIC || header[1] != STREAM_VERSION)
+		return false;
+
+	m_entries.resize(header[2]);
+	for (Entry& entry : m_entries)
+	{
+		u8 payload_size;
+		if (!file.ReadArray(&entry.offset_ns, 1) || !file.ReadArray(&payload_size, 1) ||
+			!file.ReadArray(entry.payload, ADAPTER_PAYLOAD_SIZE))
+		{
+			m_entries.clear();
+			return false;
+		}
+		entry.payload_size = payload_size;
+	}
+	return true;
+}
+
+void AdapterReportStream::Replay(time_point start, bool reduce_timing_dispersion,
+	ReportTimingEstimator* estimator, AdapterReportRing* ring) const
+{
+	for (const Entry& entry : m_entries)
+	{
+		AdapterReport report;
+		report.raw_timing =
+		    start + std::chrono::duration_cast<time_point::duration>(std::chrono::nanoseconds(entry.offset_ns));
+		report.payload_size = entry.payload_size;
+		memcpy(report.payload, entry.payload, ADAPTER_PAYLOAD_SIZE);
+
+		estimator->Feed(&report, reduce_timing_dispersion);
+		ring->Publish(report);
+	}
+}
+}  // namespace GCAdapter
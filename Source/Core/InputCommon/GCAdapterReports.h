@@ -0,0 +1,174 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace GCAdapter
+{
+using time_point = std::chrono::high_resolution_clock::time_point;
+
+enum
+{
+	ADAPTER_PAYLOAD_SIZE = 37
+};
+
+// One interrupt transfer from the adapter, stamped when the transfer completed
+struct AdapterReport
+{
+	time_point raw_timing;
+	// raw_timing realigned on the adapter's polling period, see ReportTimingEstimator
+	time_point estimated_timing;
+	// state of the estimator when this report was fed, used when fetching
+	bool eilv_optims = false;
+	bool timing_reconstruction = false;
+	int payload_size = 0;
+	u8 payload[ADAPTER_PAYLOAD_SIZE]{};
+};
+
+// Lock-free history of the latest adapter reports.
+// There is a single writer (the adapter read thread) and any number of readers. Each slot
+// carries a sequence number which is odd while the writer fills the slot, readers copy the
+// report out and retry or skip it if the sequence changed in the meantime. Nothing blocks,
+// so a reader never delays the next USB transfer and the other way around.
+class AdapterReportRing
+{
+public:
+	enum
+	{
+		CAPACITY = 64
+	};
+
+	// called from the writer
+	void Publish(const AdapterReport& report);
+
+	// Number of reports published so far. Report n (0 based) can be read while n is one of the
+	// last CAPACITY reports.
+	u32 Published() const { return m_published.load(std::memory_order_acquire); }
+	// Returns false if report n was not published yet or got overwritten.
+	bool Read(u32 n, AdapterReport* report) const;
+
+	// Must not race with Publish
+	void Reset();
+
+private:
+	struct Slot
+	{
+		std::atomic<u32> sequence{0};
+		AdapterReport report;
+	};
+
+	std::array<Slot, CAPACITY> m_slots;
+	std::atomic<u32> m_published{0};
+};
+
+// Estimates when the adapter actually polled the controllers from the time we received each
+// report (Reduce Timing Dispersion). Only the writer uses it, so it isn't synchronized.
+class ReportTimingEstimator
+{
+public:
+	// number of raw timings taken into account
+	enum
+	{
+		HISTORY_SIZE = 51
+	};
+
+	// Fills the estimated timing and estimator state of a newly received report
+	void Feed(AdapterReport* report, bool reduce_timing_dispersion);
+
+private:
+	s64 Measure(u32 age) const;
+	bool BeenUsingTR() const { return m_tr_usage_sum > 500; }
+	void FeedTRUsage(bool used_tr);
+	void JudgeEILVOptimsApplicability();
+
+	// raw timings in ns, m_history[m_newest] being the latest one
+	std::array<s64, HISTORY_SIZE> m_history{};
+	u32 m_newest = 0;
+	u32 m_count = 0;
+
+	std::array<bool, 1000> m_tr_usage{};
+	u32 m_tr_usage_index = 0;
+	int m_tr_usage_sum = 0;
+
+	// Schmidtt trigger style, start applying if effective report rate > 290Hz, stop if < 260Hz
+	bool m_eilv_optims = false;
+};
+
+// Copies the report that should be used for a poll happening at *tp, or the latest one when
+// tp is null or the timings can't be trusted. Returns false if no report was published yet.
+bool FetchReport(const AdapterReportRing& ring, const time_point* tp, bool reduce_timing_dispersion,
+	AdapterReport* report);
+
+struct LatencyStats
+{
+	u64 count;
+	u64 min_ns;
+	u64 mean_ns;
+	u64 p50_ns;
+	u64 p95_ns;
+	u64 p99_ns;
+	u64 max_ns;
+};
+
+// Distribution of the delay between a report being read from USB and it being polled by SI.
+// Samples can be recorded from any thread.
+class LatencyHistogram
+{
+public:
+	// 50us wide buckets up to 25.6ms, everything above lands in the last one
+	enum
+	{
+		BUCKET_WIDTH_NS = 50000,
+		NUM_BUCKETS = 513
+	};
+
+	void Record(s64 latency_ns);
+	LatencyStats GetStats() const;
+	void Reset();
+
+private:
+	std::array<std::atomic<u32>, NUM_BUCKETS> m_buckets{};
+	std::atomic<u64> m_count{0};
+	std::atomic<u64> m_sum_ns{0};
+	std::atomic<u64> m_min_ns{UINT64_MAX};
+	std::atomic<u64> m_max_ns{0};
+};
+
+// Recorded adapter reports with their relative timings. Lets captures of real hardware be
+// replayed through the same ring and estimator as live input.
+class AdapterReportStream
+{
+public:
+	struct Entry
+	{
+		u64 offset_ns;
+		int payload_size;
+		u8 payload[ADAPTER_PAYLOAD_SIZE];
+	};
+
+	void Append(time_point raw_timing, const u8* payload, int payload_size);
+	void Clear();
+	const std::vector<Entry>& GetEntries() const { return m_entries; }
+
+	bool Save(const std::string& filename) const;
+	bool Load(const std::string& filename);
+
+	// Publishes every report as if the first one had been received at <start>
+	void Replay(time_point start, bool reduce_timing_dispersion, ReportTimingEstimator* estimator,
+		AdapterReportRing* ring) const;
+
+private:
+	std::vector<Entry> m_entries;
+	time_point m_start;
+};
+}  // namespace GCAdapter
@@ -7,20 +7,10 @@
 using time_point = std::chrono::high_resolution_clock::time_point;
 
 InputStabilizer::InputStabilizer(size_t sizeLimit, int64_t delay, int64_t leniency)
-    : pollTimings{std::list<time_point>()}
+    : offsetsSum{0}
     , sizeLimit{sizeLimit}
     , delay{delay}
     , leniency{leniency}
-    , offsetsSum{0}
-{
-}
-
-InputStabilizer::InputStabilizer(const InputStabilizer& target)
-	: pollTimings{target.pollTimings}
-    , sizeLimit{target.sizeLimit}
-    , delay{target.delay}
-    , leniency{target.leniency}
-    , offsetsSum{target.offsetsSum}
 {
 }
 
@@ -30,8 +20,9 @@ InputStabilizer::InputStabilizer(const InputStabilizer& target)
  * feedPollTiming is used to feed the poll timing that would've been used were we not using the stabilizer.
  *
  * The unit is the nanosecond.
- * The history stores at most @sizeLimit entries. The period is either 1/59.94s or 1/60s depending on the
- * relevant setting of SConfig.
+ * The history counts at most @sizeLimit entries. The period is either 1/59.94s or 1/60s depending on the
+ * relevant setting of SConfig. Only the latest entry is kept, older ones are only ever used through
+ * @offsetsSum (see below) so the stabilizer has a fixed size and never allocates.
  * When the difference between the new entry and the previous one is farther than @leniency from the computed,
  * timing, it is considered that some exceptional event occured (ex. frame drop) and this invalidates all
  * previous data, resulting in clearing the history and starting over.
@@ -73,7 +64,7 @@ void InputStabilizer::feedPollTiming(std::chrono::high_resolution_clock::time_po
 	const SConfig& sconfig = SConfig::GetInstance();
 	double period = 1'000'000'000 / 59.94;
 
-	if (pollTimings.size() == sizeLimit)
+	if (pollTimingsCount == sizeLimit)
 	{
 		// If we are in steady state, the fed timing is ignored except for error checking
 		// It is supposed that feed is called before compute, and incrementsSinceOrigin is
@@ -81,27 +72,28 @@ void InputStabilizer::feedPollTiming(std::chrono::high_resolution_clock::time_po
 		if (std::abs((tp - steadyStateOrigin).count() - (int64_t)(incrementsSinceOrigin * period)  ) > leniency)
 		{
 			offsetsSum = 0;
-			pollTimings.clear();
-			pollTimings.push_front(tp);
+			latestPollTiming = tp;
+			pollTimingsCount = 1;
 		}
 		return;
 	}
-	if (pollTimings.size())
+	if (pollTimingsCount)
 	{
-		if (std::chrono::duration_cast<std::chrono::nanoseconds>(tp - pollTimings.front()).count() >
+		if (std::chrono::duration_cast<std::chrono::nanoseconds>(tp - latestPollTiming).count() >
 			period + leniency ||
-			std::chrono::duration_cast<std::chrono::nanoseconds>(tp - pollTimings.front()).count() < period - leniency)
+			std::chrono::duration_cast<std::chrono::nanoseconds>(tp - latestPollTiming).count() < period - leniency)
 		{ // Too high a mistake, reset
 			offsetsSum = 0;
-			pollTimings.clear();
+			pollTimingsCount = 0;
 		}
 		else
 		{
-			offsetsSum -= pollTimings.size() * (tp - pollTimings.front()).count(); // sets reference to tp
+			offsetsSum -= pollTimingsCount * (tp - latestPollTiming).count(); // sets reference to tp
 		}
 	}
-	pollTimings.push_front(tp);
-	if (pollTimings.size() == sizeLimit) // Initialize steady state algorithm
+	latestPollTiming = tp;
+	pollTimingsCount++;
+	if (pollTimingsCount == sizeLimit) // Initialize steady state algorithm
 	{
 		incrementsSinceOrigin = 0;
 		steadyStateOrigin = computeNextPollTiming(true) + std::chrono::nanoseconds(delay);
@@ -114,7 +106,7 @@ time_point InputStabilizer::computeNextPollTiming(bool init)
 	const SConfig& sconfig = SConfig::GetInstance();
 	double period = 1'000'000'000 / 59.94;
 
-	size_t size = pollTimings.size();
+	size_t size = pollTimingsCount;
 
 	if (!size)
 		return std::chrono::high_resolution_clock::now() - std::chrono::nanoseconds(delay);
@@ -126,7 +118,7 @@ time_point InputStabilizer::computeNextPollTiming(bool init)
 		return result;
 	}
 
-	std::chrono::high_resolution_clock::time_point ref = pollTimings.front();
+	std::chrono::high_resolution_clock::time_point ref = latestPollTiming;
 	int64_t actualization = (int64_t)((size) * (size - 1) / 2 * period);
 	int64_t actualizedOffsetsMean = (offsetsSum + actualization) / (int64_t)size;
 	return ref + std::chrono::nanoseconds(actualizedOffsetsMean - delay);
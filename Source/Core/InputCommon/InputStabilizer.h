@@ -1,8 +1,8 @@
 #pragma once
 
 #include <chrono>
-#include <list>
-#include <mutex>
+#include <cstddef>
+#include <cstdint>
 
 class InputStabilizer
 {
@@ -10,7 +10,9 @@ class InputStabilizer
 	using time_point = std::chrono::high_resolution_clock::time_point;
 
   private:
-	std::list<time_point> pollTimings;
+	// Only the latest timing is needed, older ones only matter through offsetsSum
+	time_point latestPollTiming;
+	size_t pollTimingsCount = 0;
 	int64_t offsetsSum;
 	const size_t sizeLimit;
 	const int64_t delay;
@@ -21,7 +23,6 @@ class InputStabilizer
 
   public:
 	InputStabilizer(size_t sizeLimit=100, int64_t delay=1'400'000, int64_t leniency=3'333'333);
-	InputStabilizer(const InputStabilizer &);
 	void feedPollTiming(time_point tp);
 	time_point computeNextPollTiming(bool init=false);
 };
\ No newline at end of file
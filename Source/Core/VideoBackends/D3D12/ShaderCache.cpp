@@ -800,7 +800,7 @@ void ShaderCache::InsertDSByteCode(const TessellationShaderUid & uid, D3DBlob *
 {
 	s_shader_blob_list.push_back(bytecode_blob);
 	s_shaders_lock.lock();
-	ByteCodeCacheEntry* entry = &ts_bytecode_cache->GetOrAdd(uid).first;
+	ByteCodeCacheEntry* entry = &ts_bytecode_cache->GetOrAdd(uid, false).first;
 	s_shaders_lock.unlock();
 	entry->m_shader_bytecode.pShaderBytecode = bytecode_blob->Data();
 	entry->m_shader_bytecode.BytecodeLength = bytecode_blob->Size();
@@ -812,7 +812,7 @@ void ShaderCache::InsertHSByteCode(const TessellationShaderUid & uid, D3DBlob *
 {
 	s_shader_blob_list.push_back(bytecode_blob);
 	s_shaders_lock.lock();
-	ByteCodeCacheEntry* entry = &ts_bytecode_cache->GetOrAdd(uid).second;
+	ByteCodeCacheEntry* entry = &ts_bytecode_cache->GetOrAdd(uid, false).second;
 	s_shaders_lock.unlock();
 	entry->m_shader_bytecode.pShaderBytecode = bytecode_blob->Data();
 	entry->m_shader_bytecode.BytecodeLength = bytecode_blob->Size();
@@ -825,7 +825,7 @@ void ShaderCache::InsertByteCode(const UidType& uid, ShaderCacheType* shader_cac
 {
 	s_shader_blob_list.push_back(bytecode_blob);
 	s_shaders_lock.lock();
-	ByteCodeCacheEntry* entry = entry = &shader_cache->GetOrAdd(uid);
+	ByteCodeCacheEntry* entry = entry = &shader_cache->GetOrAdd(uid, false);
 	s_shaders_lock.unlock();
 	entry->m_shader_bytecode.pShaderBytecode = bytecode_blob->Data();
 	entry->m_shader_bytecode.BytecodeLength = bytecode_blob->Size();
@@ -385,7 +385,7 @@ void GeometryShaderCache::PushByteCode(const void* bytecode, unsigned int byteco
 
 void GeometryShaderCache::InsertByteCode(const GeometryShaderUid &uid, const void* bytecode, u32 bytecodelen)
 {
-	GSCacheEntry* entry = &s_geometry_shaders->GetOrAdd(uid);
+	GSCacheEntry* entry = &s_geometry_shaders->GetOrAdd(uid, false);
 	entry->initialized.test_and_set();
 	PushByteCode(bytecode, bytecodelen, entry);
 }
@@ -367,7 +367,7 @@ void HullDomainShaderCache::PushByteCode(const void* bytecode, unsigned int byte
 
 void HullDomainShaderCache::InsertByteCode(const TessellationShaderUid &uid, const void* bytecode, u32 bytecodelen, bool isdomain)
 {
-	HDCacheEntry* entry = &s_hulldomain_shaders->GetOrAdd(uid);
+	HDCacheEntry* entry = &s_hulldomain_shaders->GetOrAdd(uid, false);
 	entry->initialized.test_and_set();
 	PushByteCode(bytecode, bytecodelen, entry, isdomain);
 }
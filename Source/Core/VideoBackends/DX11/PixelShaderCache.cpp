@@ -720,7 +720,7 @@ void PixelShaderCache::PushByteCode(const void* bytecode, u32 bytecodelen, Pixel
 
 void PixelShaderCache::InsertByteCode(const PixelShaderUid &uid, const void* bytecode, u32 bytecodelen)
 {
-	PSCacheEntry* entry = &s_pixel_shaders->GetOrAdd(uid);
+	PSCacheEntry* entry = &s_pixel_shaders->GetOrAdd(uid, false);
 	entry->initialized.test_and_set();
 	PushByteCode(bytecode, bytecodelen, entry);
 }
@@ -366,7 +366,7 @@ void VertexShaderCache::PushByteCode(D3DBlob&& bcodeblob, VSCacheEntry* entry)
 
 void VertexShaderCache::InsertByteCode(const VertexShaderUid &uid, D3DBlob&& bcodeblob)
 {
-	VSCacheEntry* entry = &s_vshaders->GetOrAdd(uid);
+	VSCacheEntry* entry = &s_vshaders->GetOrAdd(uid, false);
 	entry->initialized.test_and_set();
 	PushByteCode(std::move(bcodeblob), entry);
 }
@@ -536,7 +536,7 @@ void PixelShaderCache::PushByteCode(const PixelShaderUid &uid, const u8 *bytecod
 
 void PixelShaderCache::InsertByteCode(const PixelShaderUid &uid, const u8 *bytecode, int bytecodelen)
 {
-	PixelShaderCache::PSCacheEntry *entry = &s_pshaders->GetOrAdd(uid);
+	PixelShaderCache::PSCacheEntry *entry = &s_pshaders->GetOrAdd(uid, false);
 	entry->initialized.test_and_set();
 	PushByteCode(uid, bytecode, bytecodelen, entry);
 }
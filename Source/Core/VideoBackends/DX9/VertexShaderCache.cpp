@@ -320,7 +320,7 @@ void VertexShaderCache::PushByteCode(const VertexShaderUid &uid, const u8 *bytec
 
 void VertexShaderCache::InsertByteCode(const VertexShaderUid &uid, const u8 *bytecode, int bytecodelen)
 {
-	VSCacheEntry *entry = &s_vshaders->GetOrAdd(uid);
+	VSCacheEntry *entry = &s_vshaders->GetOrAdd(uid, false);
 	entry->initialized.test_and_set();
 	PushByteCode(uid, bytecode, bytecodelen, entry);
 }
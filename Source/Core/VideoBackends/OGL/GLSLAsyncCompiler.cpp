@@ -0,0 +1,172 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/Logging/Log.h"
+#include "Common/Thread.h"
+#include "Common/ThreadPool.h"
+
+#include "VideoBackends/OGL/GLSLAsyncCompiler.h"
+#include "VideoBackends/OGL/Render.h"
+
+namespace OGL
+{
+GLSLAsyncCompiler::~GLSLAsyncCompiler()
+{
+	Shutdown();
+}
+
+bool GLSLAsyncCompiler::Init(u32 num_workers)
+{
+	for (u32 i = 0; i < num_workers; i++)
+	{
+		// The worker owns the context from here, so it's made current and destroyed on it
+		std::unique_ptr<cInterfaceBase> context = GLInterface->CreateSharedContext();
+		if (!context)
+		{
+			WARN_LOG(VIDEO, "Unable to create a shared GL context, shaders will be compiled on the GPU thread");
+			Shutdown();
+			return false;
+		}
+		std::promise<bool> started;
+		std::future<bool> result = started.get_future();
+		m_workers.emplace_back(&GLSLAsyncCompiler::WorkerThread, this, context.get(), &started);
+		m_contexts.push_back(std::move(context));
+		if (!result.get())
+		{
+			WARN_LOG(VIDEO, "Unable to use a shared GL context, shaders will be compiled on the GPU thread");
+			Shutdown();
+			return false;
+		}
+	}
+	return true;
+}
+
+void GLSLAsyncCompiler::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_input_lock);
+		m_exit = true;
+		m_input.clear();
+	}
+	m_input_cv.notify_all();
+	for (std::thread& worker : m_workers)
+		worker.join();
+	m_workers.clear();
+	m_contexts.clear();
+	m_exit = false;
+	ProcCompilationResults();
+}
+
+void GLSLAsyncCompiler::CompileProgramAsync(std::unique_ptr<ProgramCompilerWorkUnit> unit)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_input_lock);
+		m_input.push_back(std::move(unit));
+	}
+	m_input_cv.notify_one();
+}
+
+void GLSLAsyncCompiler::ProcCompilationResults()
+{
+	if (m_output_count.load(std::memory_order_acquire) == 0)
+		return;
+	std::vector<std::unique_ptr<ProgramCompilerWorkUnit>> results;
+	{
+		std::lock_guard<std::mutex> lock(m_output_lock);
+		results.swap(m_output);
+		m_output_count.store(0, std::memory_order_relaxed);
+	}
+	for (std::unique_ptr<ProgramCompilerWorkUnit>& unit : results)
+		unit->ResultHandler(unit.get());
+}
+
+bool GLSLAsyncCompiler::CompilationFinished()
+{
+	std::lock_guard<std::mutex> lock(m_input_lock);
+	return m_input.empty() && m_busy_workers == 0;
+}
+
+void GLSLAsyncCompiler::WaitForFinish()
+{
+	u32 loopcount = 0;
+	while (!CompilationFinished())
+	{
+		Common::cYield(loopcount++);
+	}
+	ProcCompilationResults();
+}
+
+void GLSLAsyncCompiler::WorkerThread(cInterfaceBase* context, std::promise<bool>* started)
+{
+	Common::SetCurrentThreadName("GLSL compiler");
+	if (!context->MakeCurrent())
+	{
+		context->Shutdown();
+		started->set_value(false);
+		return;
+	}
+	started->set_value(true);
+
+	while (true)
+	{
+		std::unique_ptr<ProgramCompilerWorkUnit> unit;
+		{
+			std::unique_lock<std::mutex> lock(m_input_lock);
+			m_input_cv.wait(lock, [this] { return m_exit || !m_input.empty(); });
+			if (m_exit)
+				break;
+			unit = std::move(m_input.front());
+			m_input.pop_front();
+			m_busy_workers++;
+		}
+
+		CompileUnit(unit.get());
+
+		{
+			std::lock_guard<std::mutex> lock(m_output_lock);
+			m_output.push_back(std::move(unit));
+			m_output_count.store(static_cast<u32>(m_output.size()), std::memory_order_release);
+		}
+		std::lock_guard<std::mutex> lock(m_input_lock);
+		m_busy_workers--;
+	}
+
+	context->ClearCurrent();
+	context->Shutdown();
+}
+
+void GLSLAsyncCompiler::CompileUnit(ProgramCompilerWorkUnit* unit)
+{
+	if (unit->GenerateCodeHandler)
+		unit->GenerateCodeHandler(unit);
+
+	const ProgramShaderCode& code = unit->code;
+	if (!ProgramShaderCache::LinkProgram(unit->shader, code.vcode.c_str(), code.pcode.c_str(),
+		code.gcode.empty() ? nullptr : code.gcode.c_str()))
+	{
+		return;
+	}
+
+	if (g_ogl_config.bSupportsGLSLCache)
+	{
+		// Clear any prior error code
+		glGetError();
+
+		GLint binary_size = 0;
+		glGetProgramiv(unit->shader.glprogid, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+		if (binary_size > 0)
+		{
+			unit->binary.resize(sizeof(GLenum) + binary_size);
+			glGetProgramBinary(unit->shader.glprogid, binary_size, nullptr,
+				reinterpret_cast<GLenum*>(unit->binary.data()), unit->binary.data() + sizeof(GLenum));
+			if (glGetError() != GL_NO_ERROR)
+				unit->binary.clear();
+		}
+	}
+
+	// The program has to be complete before the GPU thread's context uses it
+	glFinish();
+}
+
+}  // namespace OGL
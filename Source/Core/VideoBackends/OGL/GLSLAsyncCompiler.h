@@ -0,0 +1,82 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/GL/GLInterfaceBase.h"
+#include "VideoBackends/OGL/ProgramShaderCache.h"
+
+namespace OGL
+{
+struct ProgramShaderCode
+{
+	std::string vcode;
+	std::string pcode;
+	// empty when the program has no geometry shader
+	std::string gcode;
+};
+
+struct ProgramCompilerWorkUnit
+{
+	// Called on the worker before compiling, fills the code if it wasn't generated yet
+	std::function<void(ProgramCompilerWorkUnit*)> GenerateCodeHandler;
+	// Called on the GPU thread from ProcCompilationResults
+	std::function<void(ProgramCompilerWorkUnit*)> ResultHandler;
+	ProgramShaderCode code;
+	// glprogid is 0 if compiling or linking failed
+	SHADER shader;
+	// GLenum format followed by the glGetProgramBinary output, empty if not available
+	std::vector<u8> binary;
+};
+
+// Compiles and links programs in the background, the OGL counterpart of HLSLAsyncCompiler.
+// Each worker thread owns a GL context shared with the main one, the linked programs are
+// handed back to the GPU thread from ProcCompilationResults.
+class GLSLAsyncCompiler
+{
+public:
+	~GLSLAsyncCompiler();
+
+	// Returns false if the GL interface can't provide a shared context for every worker
+	bool Init(u32 num_workers);
+	// Drops the queued units, waits for the ones being compiled and processes their results
+	void Shutdown();
+
+	void CompileProgramAsync(std::unique_ptr<ProgramCompilerWorkUnit> unit);
+	void ProcCompilationResults();
+	bool CompilationFinished();
+	void WaitForFinish();
+
+private:
+	void WorkerThread(cInterfaceBase* context, std::promise<bool>* started);
+	static void CompileUnit(ProgramCompilerWorkUnit* unit);
+
+	std::vector<std::unique_ptr<cInterfaceBase>> m_contexts;
+	std::vector<std::thread> m_workers;
+
+	std::mutex m_input_lock;
+	std::condition_variable m_input_cv;
+	std::deque<std::unique_ptr<ProgramCompilerWorkUnit>> m_input;
+	u32 m_busy_workers = 0;
+	bool m_exit = false;
+
+	std::mutex m_output_lock;
+	std::vector<std::unique_ptr<ProgramCompilerWorkUnit>> m_output;
+	// Lets ProcCompilationResults skip the lock, it's called for every shader change
+	std::atomic<u32> m_output_count{0};
+};
+
+}  // namespace OGL
@@ -2,7 +2,12 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "Common/Align.h"
 #include "Common/Common.h"
@@ -12,6 +17,7 @@
 #include "Core/Host.h"
 #include "Core/ConfigManager.h"
 
+#include "VideoBackends/OGL/GLSLAsyncCompiler.h"
 #include "VideoBackends/OGL/ProgramShaderCache.h"
 #include "VideoBackends/OGL/Render.h"
 #include "VideoBackends/OGL/StreamBuffer.h"
@@ -21,6 +27,7 @@
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/ShaderPrecompiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexShaderManager.h"
 
@@ -33,7 +40,8 @@ u32 ProgramShaderCache::s_g_ubo_buffer_size;
 s32 ProgramShaderCache::s_ubo_align;
 
 static std::unique_ptr<StreamBuffer> s_buffer;
-static int num_failures = 0;
+// Shaders can fail to compile on the async compiler's workers too
+static std::atomic<int> num_failures{0};
 
 static LinearDiskCache<SHADERUID, u8> g_program_disk_cache;
 static GLuint CurrentProgram = 0;
@@ -43,6 +51,62 @@ std::array<SHADERUID, PIXEL_SHADER_RENDER_MODE::PSRM_DEPTH_ONLY + 1> ProgramShad
 
 static char s_glsl_header[2048] = "";
 
+// Time spent compiling precompiled shaders on each frame
+static const std::chrono::microseconds PRECOMPILE_FRAME_BUDGET(2000);
+static std::unique_ptr<ShaderPrecompiler<SHADERUID, ProgramShaderCode>> s_precompiler;
+
+// Each worker owns a shared context, a few are enough to keep up with a game
+static const u32 ASYNC_COMPILER_MAX_WORKERS = 4;
+static std::unique_ptr<GLSLAsyncCompiler> s_async_compiler;
+
+// Frame dumps must not miss any geometry, so shaders are waited for while dumping
+static bool UseAsyncCompilation()
+{
+	return s_async_compiler && g_ActiveConfig.bFullAsyncShaderCompilation &&
+		!SConfig::GetInstance().m_DumpFrames;
+}
+
+// Thread safe, unlike the generators' default buffers
+static bool GenerateProgramShaderCode(const SHADERUID& uid, ProgramShaderCode& code)
+{
+	std::vector<char> buffer(std::max({ VERTEXSHADERGEN_BUFFERSIZE, PIXELSHADERGEN_BUFFERSIZE, GEOMETRYSHADERGEN_BUFFERSIZE }));
+	ShaderCode shader_code;
+
+	shader_code.SetBuffer(buffer.data());
+	GenerateVertexShaderCodeGL(shader_code, uid.vuid.GetUidData());
+	code.vcode.assign(buffer.data(), shader_code.BufferSize());
+
+	shader_code.SetBuffer(buffer.data());
+	GeneratePixelShaderCodeGL(shader_code, uid.puid.GetUidData());
+	code.pcode.assign(buffer.data(), shader_code.BufferSize());
+
+	if (g_ActiveConfig.backend_info.bSupportsGeometryShaders && !uid.guid.GetUidData().IsPassthrough())
+	{
+		shader_code.SetBuffer(buffer.data());
+		GenerateGeometryShaderCode(shader_code, uid.guid.GetUidData(), API_OPENGL);
+		code.gcode.assign(buffer.data(), shader_code.BufferSize());
+	}
+
+#if defined(_DEBUG) || defined(DEBUGFAST)
+	if (g_ActiveConfig.iLog & CONF_SAVESHADERS)
+	{
+		static std::atomic<int> counter{0};
+		std::string filename = StringFromFormat("%svs_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(), counter++);
+		SaveData(filename, code.vcode.c_str());
+
+		filename = StringFromFormat("%sps_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(), counter++);
+		SaveData(filename, code.pcode.c_str());
+
+		if (!code.gcode.empty())
+		{
+			filename = StringFromFormat("%sgs_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(), counter++);
+			SaveData(filename, code.gcode.c_str());
+		}
+	}
+#endif
+	return true;
+}
+
 static std::string GetGLSLVersionString()
 {
 	GLSL_VERSION v = g_ogl_config.eSupportedGLSLVersion;
@@ -219,57 +283,90 @@ SHADER* ProgramShaderCache::CompileShader(const SHADERUID& uid)
 	PIXEL_SHADER_RENDER_MODE render_mode = (PIXEL_SHADER_RENDER_MODE)uid.puid.GetUidData().render_mode;
 	// Check if shader is already in cache
 	PCacheEntry& newentry = pshaders->GetOrAdd(uid);
-	if (newentry.shader.glprogid)
+	last_entry[render_mode] = &newentry;
+	// Async compilation was turned off while this one was queued
+	if (newentry.pending && !UseAsyncCompilation())
+		s_async_compiler->WaitForFinish();
+	if (!newentry.compiled && !newentry.pending)
 	{
-		last_entry[render_mode] = &newentry;
-		GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
-		return &last_entry[render_mode]->shader;
+		newentry.in_cache = 0;
+		CompileEntry(uid, newentry, nullptr);
 	}
-	// Make an entry in the table
-	last_entry[render_mode] = &newentry;
-	newentry.in_cache = 0;
-
-	ShaderCode vcode;
-	ShaderCode pcode;
-	ShaderCode gcode;
-	GenerateVertexShaderCodeGL(vcode, uid.vuid.GetUidData());
-	GeneratePixelShaderCodeGL(pcode, uid.puid.GetUidData());
-	if (g_ActiveConfig.backend_info.bSupportsGeometryShaders && !uid.guid.GetUidData().IsPassthrough())
-		GenerateGeometryShaderCode(gcode, uid.guid.GetUidData(), API_OPENGL);
+	GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
+	// glprogid is 0 while the program is compiled in the background, or if it failed
+	return &newentry.shader;
+}
 
-#if defined(_DEBUG) || defined(DEBUGFAST)
-	if (g_ActiveConfig.iLog & CONF_SAVESHADERS)
+void ProgramShaderCache::CompileEntry(const SHADERUID& uid, PCacheEntry& entry, ProgramShaderCode* code)
+{
+	if (UseAsyncCompilation())
 	{
-		static int counter = 0;
-		std::string filename = StringFromFormat("%svs_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(), counter++);
-		SaveData(filename, vcode.GetBuffer());
-
-		filename = StringFromFormat("%sps_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(), counter++);
-		SaveData(filename, pcode.GetBuffer());
-
-		if (gcode.GetBuffer() != nullptr)
+		std::unique_ptr<ProgramCompilerWorkUnit> unit = std::make_unique<ProgramCompilerWorkUnit>();
+		if (code)
 		{
-			filename = StringFromFormat("%sgs_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(), counter++);
-			SaveData(filename, gcode.GetBuffer());
+			unit->code = std::move(*code);
 		}
+		else
+		{
+			unit->GenerateCodeHandler = [uid](ProgramCompilerWorkUnit* work_unit)
+			{
+				GenerateProgramShaderCode(uid, work_unit->code);
+			};
+		}
+		PCacheEntry* entry_ptr = &entry;
+		unit->ResultHandler = [uid, entry_ptr](ProgramCompilerWorkUnit* work_unit)
+		{
+			InsertCompiledProgram(uid, *entry_ptr, work_unit);
+		};
+		entry.pending = true;
+		s_async_compiler->CompileProgramAsync(std::move(unit));
+		return;
 	}
-#endif
 
-	if (!CompileShader(newentry.shader, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer()))
+	ProgramShaderCode generated_code;
+	if (!code)
+	{
+		GenerateProgramShaderCode(uid, generated_code);
+		code = &generated_code;
+	}
+	entry.compiled = true;
+	if (!CompileShader(entry.shader, code->vcode.c_str(), code->pcode.c_str(), code->gcode.empty() ? nullptr : code->gcode.c_str()))
 	{
 		GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
-		return nullptr;
+		return;
 	}
 
 	INCSTAT(stats.numPixelShadersCreated);
 	SETSTAT(stats.numPixelShadersAlive, static_cast<int>(pshaders->size()));
-	GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
+}
+
+void ProgramShaderCache::InsertCompiledProgram(const SHADERUID& uid, PCacheEntry& entry, ProgramCompilerWorkUnit* unit)
+{
+	entry.pending = false;
+	entry.compiled = true;
+	entry.shader.glprogid = unit->shader.glprogid;
+	if (!entry.shader.glprogid)
+	{
+		GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
+		return;
+	}
+
+	// The worker already retrieved the binary, no need to do it again on shutdown
+	if (!unit->binary.empty())
+	{
+		g_program_disk_cache.Append(uid, unit->binary.data(), static_cast<u32>(unit->binary.size()));
+		entry.in_cache = 1;
+	}
 
-	return &last_entry[render_mode]->shader;
+	INCSTAT(stats.numPixelShadersCreated);
+	SETSTAT(stats.numPixelShadersAlive, static_cast<int>(pshaders->size()));
 }
 
 SHADER* ProgramShaderCache::SetShader(PIXEL_SHADER_RENDER_MODE render_mode, u32 components, u32 primitive_type)
 {
+	if (s_async_compiler)
+		s_async_compiler->ProcCompilationResults();
+
 	SHADERUID uid;
 	GetShaderId(&uid, render_mode, components, primitive_type);
 	uid.CalculateHash();
@@ -288,6 +385,16 @@ SHADER* ProgramShaderCache::SetShader(PIXEL_SHADER_RENDER_MODE render_mode, u32
 }
 
 bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const char* pcode, const char* gcode, const char **macros, const u32 macro_count)
+{
+	if (!LinkProgram(shader, vcode, pcode, gcode, macros, macro_count))
+		return false;
+
+	shader.SetProgramVariables();
+
+	return true;
+}
+
+bool ProgramShaderCache::LinkProgram(SHADER& shader, const char* vcode, const char* pcode, const char* gcode, const char **macros, const u32 macro_count)
 {
 	GLuint vsid = CompileSingleShader(GL_VERTEX_SHADER, vcode, macros, macro_count);
 	GLuint psid = CompileSingleShader(GL_FRAGMENT_SHADER, pcode, macros, macro_count);
@@ -359,11 +466,10 @@ bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const
 
 		// Don't try to use this shader
 		glDeleteProgram(pid);
+		shader.glprogid = 0;
 		return false;
 	}
 
-	shader.SetProgramVariables();
-
 	return true;
 }
 
@@ -568,11 +674,23 @@ void ProgramShaderCache::Init()
 
 	CreateHeader();
 
+	// Opt-in until the shared contexts got more testing across drivers
+	if (g_ActiveConfig.bGLSLAsyncShaderCompilation)
+	{
+		s_async_compiler = std::make_unique<GLSLAsyncCompiler>();
+		u32 workers = std::min<u32>(std::max(cpu_info.logical_cpu_count / 2, 1), ASYNC_COMPILER_MAX_WORKERS);
+		if (!s_async_compiler->Init(workers))
+			s_async_compiler.reset();
+	}
+
 	CurrentProgram = 0;
 	last_entry.fill(nullptr);
 	if (g_ActiveConfig.bCompileShaderOnStartup)
 	{
-		size_t shader_count = 0;
+		// Only what this game used in previous runs, most used first. They are compiled a few
+		// per frame by ProcessPrecompiledShaders so the boot isn't blocked, anything the game
+		// asks for earlier is compiled on demand.
+		std::vector<SHADERUID> uids;
 		pshaders->ForEachMostUsedByCategory(gameid,
 			[&](const SHADERUID& it, size_t total)
 		{
@@ -580,24 +698,59 @@ void ProgramShaderCache::Init()
 			item.puid.ClearHASH();
 			item.puid.CalculateUIDHash();
 			const pixel_shader_uid_data& uid_data = item.puid.GetUidData();
-			shader_count++;
 			if ((!uid_data.stereo || g_ActiveConfig.backend_info.bSupportsGeometryShaders)
 				&& (!uid_data.bounding_box || g_ActiveConfig.backend_info.bSupportsBBox))
 			{
-				Host_UpdateTitle(StringFromFormat("Compiling Shaders %zu %% (%zu/%zu)", (shader_count * 100) / total, shader_count, total));
-				CompileShader(item);
+				uids.push_back(item);
 			}
 		},
 			[](PCacheEntry& entry)
 		{
 			return !entry.shader.glprogid;
+		});
+		if (!uids.empty())
+		{
+			s_precompiler = std::make_unique<ShaderPrecompiler<SHADERUID, ProgramShaderCode>>(
+				uids, GenerateProgramShaderCode,
+				[](const SHADERUID& uid, ProgramShaderCode& code)
+			{
+				PCacheEntry& entry = pshaders->GetOrAdd(uid, false);
+				if (entry.compiled || entry.pending)
+					return;
+				entry.in_cache = 0;
+				CompileEntry(uid, entry, &code);
+			});
 		}
-		, true);
+	}
+}
+
+void ProgramShaderCache::ProcessPrecompiledShaders()
+{
+	if (s_async_compiler)
+		s_async_compiler->ProcCompilationResults();
+	if (!s_precompiler)
+		return;
+	// Queuing is cheap, only hand more shaders to the workers once they caught up
+	if (UseAsyncCompilation() && !s_async_compiler->CompilationFinished())
+		return;
+	if (s_precompiler->Process(PRECOMPILE_FRAME_BUDGET))
+	{
+		INFO_LOG(VIDEO, "Precompiled %zu of %zu shaders from the usage profile",
+			s_precompiler->GetCompiledCount(), s_precompiler->GetTotalCount());
+		s_precompiler.reset();
 	}
 }
 
 void ProgramShaderCache::Shutdown()
 {
+	s_precompiler.reset();
+	// Hands the programs being compiled to their entries before they get stored
+	if (s_async_compiler)
+	{
+		s_async_compiler->Shutdown();
+		s_async_compiler.reset();
+	}
+
 	// store all shaders in cache on disk
 	if (g_ogl_config.bSupportsGLSLCache)
 	{
@@ -795,8 +948,9 @@ void ProgramShaderCache::ProgramShaderCacheInserter::Read(const SHADERUID& key,
 	GLenum *prog_format = (GLenum*)value;
 	GLint binary_size = value_size - sizeof(GLenum);
 
-	PCacheEntry& entry = pshaders->GetOrAdd(key);
+	PCacheEntry& entry = pshaders->GetOrAdd(key, false);
 	entry.in_cache = 1;
+	entry.compiled = true;
 	entry.shader.glprogid = glCreateProgram();
 	glProgramBinary(entry.shader.glprogid, *prog_format, binary, binary_size);
 
@@ -811,6 +965,7 @@ void ProgramShaderCache::ProgramShaderCacheInserter::Read(const SHADERUID& key,
 	{
 		glDeleteProgram(entry.shader.glprogid);
 		entry.shader.glprogid = 0;
+		entry.compiled = false;
 	}
 }
 
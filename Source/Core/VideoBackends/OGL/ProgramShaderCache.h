@@ -84,6 +84,9 @@ struct SHADER
 	void Bind();
 };
 
+struct ProgramShaderCode;
+struct ProgramCompilerWorkUnit;
+
 class ProgramShaderCache
 {
 public:
@@ -91,7 +94,11 @@ public:
 	struct PCacheEntry
 	{
 		SHADER shader;
-		bool in_cache;
+		bool in_cache = false;
+		// Set once the program went through the compiler, even if it failed
+		bool compiled = false;
+		// Queued on the async compiler, shader.glprogid is 0 until the result is processed
+		bool pending = false;
 
 		void Destroy()
 		{
@@ -107,12 +114,16 @@ public:
 	static void GetShaderId(SHADERUID *uid, PIXEL_SHADER_RENDER_MODE render_mode, u32 components, u32 primitive_type);
 
 	static bool CompileShader(SHADER &shader, const char* vcode, const char* pcode, const char* gcode = nullptr, const char **macros = nullptr, const u32 macro_count = 0);
+	// Same as CompileShader without setting the program variables, safe on a shared context
+	static bool LinkProgram(SHADER &shader, const char* vcode, const char* pcode, const char* gcode = nullptr, const char **macros = nullptr, const u32 macro_count = 0);
 	static bool CompileComputeShader(SHADER& shader, const std::string& code);
 	static GLuint CompileSingleShader(GLuint type, const char *code, const char **macros = nullptr, const u32 count = 0);
 	static void UploadConstants();
 
 	static void Init();
 	static void Shutdown();
+	// Called once per frame, compiles part of the shaders queued at startup
+	static void ProcessPrecompiledShaders();
 	static void CreateHeader();
 
 	static u32 GetUniformBufferAlignment();
@@ -124,6 +135,9 @@ private:
 		void Read(const SHADERUID &key, const u8 *value, u32 value_size) override;
 	};
 
+	static void CompileEntry(const SHADERUID& uid, PCacheEntry& entry, ProgramShaderCode* code);
+	static void InsertCompiledProgram(const SHADERUID& uid, PCacheEntry& entry, ProgramCompilerWorkUnit* unit);
+
 	static PCache* pshaders;
 	static std::array<PCacheEntry*, PIXEL_SHADER_RENDER_MODE::PSRM_DEPTH_ONLY + 1> last_entry;
 	static std::array<SHADERUID, PIXEL_SHADER_RENDER_MODE::PSRM_DEPTH_ONLY + 1>  last_uid;
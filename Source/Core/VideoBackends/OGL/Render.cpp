@@ -742,7 +742,6 @@ Renderer::Renderer()
 Renderer::~Renderer()
 {
 	FlushFrameDump();
-	FinishFrameData();
 	DestroyFrameDumpResources();
 }
 
@@ -1567,6 +1566,9 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight,
 	// Clean out old stuff from caches. It's not worth it to clean out the shader caches.
 	g_texture_cache->Cleanup(frameCount);
 
+	// Compile some of the shaders the game is expected to use, see ProgramShaderCache::Init
+	ProgramShaderCache::ProcessPrecompiledShaders();
+
 	// Render to the framebuffer.
 	FramebufferManager::SetFramebuffer(0);
 
@@ -1715,7 +1717,6 @@ void Renderer::FlushFrameDump()
 	if (!m_last_frame_exported)
 		return;
 
-	FinishFrameData();
 	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_frame_dumping_pbo[0]);
 	m_frame_pbo_is_mapped[0] = true;
 	void* data = glMapBufferRange(
@@ -164,6 +164,13 @@ void VertexManager::vFlush(bool useDstAlpha)
 	{
 		active_shader = ProgramShaderCache::SetShader(PSRM_DEFAULT, VertexLoaderManager::g_current_components, m_current_primitive_type);
 	}
+	// Still being compiled in the background (or failed), skip the draw as D3D does
+	if (!active_shader->glprogid)
+	{
+		g_Config.iSaveTargetId++;
+		ClearEFBCache();
+		return;
+	}
 	active_shader->Bind();
 	g_renderer->ApplyState(false);
 	Draw(stride);
@@ -176,9 +183,11 @@ void VertexManager::vFlush(bool useDstAlpha)
 	const bool logic_op_enabled = bpmem.blendmode.logicopenable && bpmem.blendmode.logicmode != BlendMode::LogicOp::COPY && !bpmem.blendmode.blendenable;
 	// run through vertex groups again to set alpha
 	if (useDstAlpha && (!dualSourcePossible || logic_op_enabled))
-	{
 		active_shader = ProgramShaderCache::SetShader(PSRM_ALPHA_PASS, VertexLoaderManager::g_current_components, m_current_primitive_type);
-
+	else
+		active_shader = nullptr;
+	if (active_shader && active_shader->glprogid)
+	{
 		// only update alpha
 		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_TRUE);
 
@@ -26,7 +26,6 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/FramebufferManagerBase.h"
-#include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/PixelEngine.h"
@@ -257,7 +256,6 @@ void VideoSoftware::Video_Prepare()
 	g_perf_query = std::make_unique<PerfQuery>();
 	Fifo::Init(); // must be done before OpcodeDecoder_Init()
 	OpcodeDecoder::Init();
-	IndexGenerator::Init();
 	VertexShaderManager::Init();
 	PixelShaderManager::Init(true);
 	g_texture_cache = std::make_unique<TextureCache>();
@@ -569,7 +569,7 @@ struct ShaderCacheReader : public LinearDiskCacheReader<Uid, u32>
 		if (module == VK_NULL_HANDLE)
 			return;
 
-		ObjectCache::vkShaderItem& it = m_shader_map->GetOrAdd(key);
+		ObjectCache::vkShaderItem& it = m_shader_map->GetOrAdd(key, false);
 		it.initialized.test_and_set();
 		it.compiled = true;
 		it.module = module;
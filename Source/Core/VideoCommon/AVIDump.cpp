@@ -6,22 +6,35 @@
 #define __STDC_CONSTANT_MACROS 1
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <vector>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
 #include <libavutil/mathematics.h>
 #include <libswscale/swscale.h>
 }
 
+#include "Common/CommonFuncs.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
 
+#include "AudioCommon/AudioCommon.h"
+
 #include "Core/ConfigManager.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/AudioInterface.h"
 #include "Core/HW/SystemTimers.h"
 #include "Core/HW/VideoInterface.h"  //for TargetRefreshRate
 #include "Core/Movie.h"
@@ -59,6 +72,38 @@ static int s_file_index = 0;
 static int s_savestate_index = 0;
 static int s_last_savestate_index = 0;
 
+// Audio muxed into the frame dump (bDumpAudioInVideo). Samples arrive on the CPU thread, which
+// only queues them with their emulated time. They are encoded and muxed with the video on the
+// frame dumping thread, which may be several frames behind, once the first video frame of the
+// file decided where the audio starts.
+struct PendingAudio
+{
+	u64 ticks;
+	u32 sample_rate;
+	std::vector<s16> samples;
+};
+
+// Guards the muxer and the encoders, never taken by the CPU thread.
+static std::mutex s_mux_lock;
+static AVStream* s_audio_stream = nullptr;
+static AVCodecContext* s_audio_codec_context = nullptr;
+static AVFrame* s_audio_frame = nullptr;
+static int s_audio_frame_size;
+static std::atomic<bool> s_audio_started{false};
+static u64 s_audio_start_ticks;
+static u64 s_audio_start_pts_ticks;
+static u32 s_audio_ticks_per_second;
+static s64 s_audio_next_pts;
+static u64 s_audio_resample_remainder;
+static std::vector<s16> s_audio_fifo;
+
+// Guards the samples queued by the CPU thread.
+static std::mutex s_pending_audio_lock;
+static std::deque<PendingAudio> s_pending_audio;
+static u32 s_pending_audio_samples;
+
+static void AddSoundSamples(const s16* samples, u32 num_samples, u32 sample_rate);
+
 static void InitAVCodec()
 {
 	static bool first_run = true;
@@ -93,6 +138,8 @@ bool AVIDump::Start(int w, int h, bool fromBGRA)
 	    g_replayComm->current.endFrame <= g_playbackStatus->currentPlaybackFrame)
 		return false;
 #endif
+	std::lock_guard<std::mutex> lk(s_mux_lock);
+
 	s_pix_fmt = fromBGRA ? AV_PIX_FMT_BGRA : AV_PIX_FMT_RGBA;
 
 	s_width = w;
@@ -100,6 +147,10 @@ bool AVIDump::Start(int w, int h, bool fromBGRA)
 
 	s_last_frame_is_valid = false;
 	s_last_pts = 0;
+	s_audio_started = false;
+	s_audio_next_pts = -1;
+	s_audio_resample_remainder = 0;
+	s_audio_fifo.clear();
 
 	InitAVCodec();
 	bool success = CreateVideoFile();
@@ -108,6 +159,10 @@ bool AVIDump::Start(int w, int h, bool fromBGRA)
 		CloseVideoFile();
 		OSD::AddMessage("AVIDump Start failed");
 	}
+	else if (s_audio_stream)
+	{
+		AudioCommon::SetSoundDumpCallback(AddSoundSamples);
+	}
 	return success;
 }
 
@@ -149,6 +204,117 @@ static std::string GetDumpPath(const std::string& format)
 	return s_dump_path;
 }
 
+static bool IsSupportedSampleFormat(AVSampleFormat format)
+{
+	return format == AV_SAMPLE_FMT_S16 || format == AV_SAMPLE_FMT_S16P ||
+		format == AV_SAMPLE_FMT_FLT || format == AV_SAMPLE_FMT_FLTP;
+}
+
+static void CloseAudioStream()
+{
+	av_frame_free(&s_audio_frame);
+	avcodec_free_context(&s_audio_codec_context);
+	// The stream itself belongs to the format context.
+	s_audio_stream = nullptr;
+}
+
+// Must be called with s_mux_lock held, before the header is written.
+static bool CreateAudioStream(AVCodecID default_codec_id)
+{
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 37, 100)
+	WARN_LOG(VIDEO, "Dumping audio into the video file needs a newer libavcodec");
+	return false;
+#else
+	AVCodecID codec_id = default_codec_id;
+	if (!g_Config.sDumpAudioCodec.empty())
+	{
+		const AVCodecDescriptor* codec_desc =
+			avcodec_descriptor_get_by_name(g_Config.sDumpAudioCodec.c_str());
+		if (codec_desc)
+			codec_id = codec_desc->id;
+		else
+			WARN_LOG(VIDEO, "Invalid audio codec %s", g_Config.sDumpAudioCodec.c_str());
+	}
+
+	const AVCodec* codec = avcodec_find_encoder(codec_id);
+	if (codec_id == AV_CODEC_ID_NONE || !codec)
+		return false;
+
+	// Samples are converted by hand, which covers what the common encoders take.
+	AVSampleFormat sample_fmt = codec->sample_fmts ? AV_SAMPLE_FMT_NONE : AV_SAMPLE_FMT_S16;
+	for (const AVSampleFormat* fmt = codec->sample_fmts; fmt && *fmt != AV_SAMPLE_FMT_NONE; ++fmt)
+	{
+		if (IsSupportedSampleFormat(*fmt))
+		{
+			sample_fmt = *fmt;
+			break;
+		}
+	}
+	if (sample_fmt == AV_SAMPLE_FMT_NONE)
+		return false;
+
+	// Use the rate the DSP currently runs at, chunks at another rate are resampled to it.
+	int sample_rate = (int)AudioInterface::GetAIDSampleRate();
+	if (codec->supported_samplerates)
+	{
+		// Otherwise the closest supported one
+		int best_rate = 0;
+		for (const int* rate = codec->supported_samplerates; *rate; ++rate)
+		{
+			if (!best_rate || std::abs(*rate - sample_rate) < std::abs(best_rate - sample_rate))
+				best_rate = *rate;
+		}
+		if (!best_rate)
+			return false;
+		sample_rate = best_rate;
+	}
+
+	if (!(s_audio_codec_context = avcodec_alloc_context3(codec)))
+		return false;
+
+	s_audio_codec_context->codec_type = AVMEDIA_TYPE_AUDIO;
+	s_audio_codec_context->sample_fmt = sample_fmt;
+	s_audio_codec_context->sample_rate = sample_rate;
+	s_audio_codec_context->time_base.num = 1;
+	s_audio_codec_context->time_base.den = sample_rate;
+	s_audio_codec_context->bit_rate = 192000;
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 28, 100)
+	av_channel_layout_default(&s_audio_codec_context->ch_layout, 2);
+#else
+	s_audio_codec_context->channels = 2;
+	s_audio_codec_context->channel_layout = AV_CH_LAYOUT_STEREO;
+#endif
+	if (s_format_context->oformat->flags & AVFMT_GLOBALHEADER)
+		s_audio_codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+	if (avcodec_open2(s_audio_codec_context, codec, nullptr) < 0)
+		return false;
+
+	s_audio_frame_size = s_audio_codec_context->frame_size ? s_audio_codec_context->frame_size : 1024;
+	if (!(s_audio_frame = av_frame_alloc()))
+		return false;
+	s_audio_frame->format = sample_fmt;
+	s_audio_frame->sample_rate = sample_rate;
+	s_audio_frame->nb_samples = s_audio_frame_size;
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 28, 100)
+	av_channel_layout_copy(&s_audio_frame->ch_layout, &s_audio_codec_context->ch_layout);
+#else
+	s_audio_frame->channels = 2;
+	s_audio_frame->channel_layout = AV_CH_LAYOUT_STEREO;
+#endif
+	if (av_frame_get_buffer(s_audio_frame, 0) < 0)
+		return false;
+
+	if (!(s_audio_stream = avformat_new_stream(s_format_context, codec)) ||
+		!AVStreamCopyContext(s_audio_stream, s_audio_codec_context))
+	{
+		return false;
+	}
+
+	return true;
+#endif
+}
+
 bool AVIDump::CreateVideoFile()
 {
 	const std::string& s_format = g_Config.sDumpFormat;
@@ -174,7 +340,38 @@ bool AVIDump::CreateVideoFile()
 		return false;
 	}
 
-	const std::string& codec_name = g_Config.bUseFFV1 ? "ffv1" : g_Config.sDumpCodec;
+	// Presets pick a codec and sensible options, DumpCodecOptions can still override them.
+	const std::string& preset = g_Config.sDumpEncoderPreset;
+	const bool use_ffv1 = g_Config.bUseFFV1 || preset == "ffv1";
+	AVDictionary* codec_options = nullptr;
+	std::string codec_name = use_ffv1 ? "ffv1" : g_Config.sDumpCodec;
+	// The encoder is looked up by name when the codec has several (x264 isn't the only h264 one).
+	const char* encoder_name = nullptr;
+	bool use_preset = false;
+	if (preset == "x264")
+	{
+		codec_name = "h264";
+		encoder_name = "libx264";
+		use_preset = true;
+		av_dict_set(&codec_options, "preset", "veryfast", 0);
+		av_dict_set(&codec_options, "crf", "18", 0);
+	}
+	else if (preset == "ffv1")
+	{
+		use_preset = true;
+		// Version 3 supports slices, which is what lets FFV1 use more than one thread.
+		av_dict_set(&codec_options, "level", "3", 0);
+		av_dict_set(&codec_options, "slicecrc", "1", 0);
+	}
+	else if (!preset.empty())
+	{
+		WARN_LOG(VIDEO, "Unknown frame dump preset %s", preset.c_str());
+	}
+	if (!g_Config.sDumpCodecOptions.empty() &&
+		av_dict_parse_string(&codec_options, g_Config.sDumpCodecOptions.c_str(), "=", ":", 0) < 0)
+	{
+		WARN_LOG(VIDEO, "Invalid codec options %s", g_Config.sDumpCodecOptions.c_str());
+	}
 
 	AVCodecID codec_id = output_format->video_codec;
 
@@ -188,11 +385,14 @@ bool AVIDump::CreateVideoFile()
 	}
 
 	const AVCodec* codec = nullptr;
+	if (encoder_name && !(codec = avcodec_find_encoder_by_name(encoder_name)))
+		WARN_LOG(VIDEO, "Encoder %s not found, using the default one", encoder_name);
 
-	if (!(codec = avcodec_find_encoder(codec_id)) ||
+	if (!(codec || (codec = avcodec_find_encoder(codec_id))) ||
 		!(s_codec_context = avcodec_alloc_context3(codec)))
 	{
 		ERROR_LOG(VIDEO, "Could not find encoder or allocate codec context");
+		av_dict_free(&codec_options);
 		return false;
 	}
 
@@ -201,18 +401,31 @@ bool AVIDump::CreateVideoFile()
 		s_codec_context->codec_tag = MKTAG('X', 'V', 'I', 'D');
 
 	s_codec_context->codec_type = AVMEDIA_TYPE_VIDEO;
-	s_codec_context->bit_rate = g_Config.iBitrateKbps * 1000;
 	s_codec_context->width = s_width;
 	s_codec_context->height = s_height;
 	s_codec_context->time_base.num = 1;
 	s_codec_context->time_base.den = VideoInterface::GetTargetRefreshRate();
-	s_codec_context->gop_size = 12;
-	s_codec_context->pix_fmt = g_Config.bUseFFV1 ? AV_PIX_FMT_BGRA : AV_PIX_FMT_YUV420P;
+	// Presets leave rate control and keyframes to the encoder
+	if (!use_preset)
+	{
+		s_codec_context->bit_rate = g_Config.iBitrateKbps * 1000;
+		s_codec_context->gop_size = 12;
+	}
+	s_codec_context->pix_fmt = use_ffv1 ? AV_PIX_FMT_BGRA : AV_PIX_FMT_YUV420P;
+	// 0 lets libavcodec use one thread per core.
+	s_codec_context->thread_count = g_Config.iDumpThreads;
+	s_codec_context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
 
 	if (output_format->flags & AVFMT_GLOBALHEADER)
 		s_codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
-	if (avcodec_open2(s_codec_context, codec, nullptr) < 0)
+	int open_result = avcodec_open2(s_codec_context, codec, &codec_options);
+	// Whatever is left wasn't understood by the encoder
+	AVDictionaryEntry* unused_option = nullptr;
+	while ((unused_option = av_dict_get(codec_options, "", unused_option, AV_DICT_IGNORE_SUFFIX)))
+		WARN_LOG(VIDEO, "Unused codec option %s=%s", unused_option->key, unused_option->value);
+	av_dict_free(&codec_options);
+	if (open_result < 0)
 	{
 		ERROR_LOG(VIDEO, "Could not open codec");
 		return false;
@@ -240,6 +453,12 @@ bool AVIDump::CreateVideoFile()
 		return false;
 	}
 
+	if (g_Config.bDumpAudioInVideo && !CreateAudioStream(output_format->audio_codec))
+	{
+		WARN_LOG(VIDEO, "Could not set up audio for the frame dump, dumping video only");
+		CloseAudioStream();
+	}
+
 	NOTICE_LOG(VIDEO, "Opening file %s for dumping", s_dump_path.c_str());
 	if (avio_open(&s_format_context->pb, s_dump_path.c_str(), AVIO_FLAG_WRITE) < 0 ||
 		avformat_write_header(s_format_context, nullptr))
@@ -270,7 +489,7 @@ static int ReceivePacket(AVCodecContext* avctx, AVPacket* pkt, int* got_packet)
 	int error = avcodec_receive_packet(avctx, pkt);
 	if (!error)
 		*got_packet = 1;
-	if (error == AVERROR(EAGAIN))
+	if (error == AVERROR(EAGAIN) || error == AVERROR_EOF)
 		return 0;
 
 	return error;
@@ -292,25 +511,213 @@ static int SendFrameAndReceivePacket(AVCodecContext* avctx, AVPacket* pkt, AVFra
 #endif
 }
 
-static void WritePacket(AVPacket& pkt)
+// Must be called with s_mux_lock held.
+static void WritePacket(AVPacket& pkt, AVCodecContext* codec_context, AVStream* stream)
 {
 	// Write the compressed frame in the media file.
 	if (pkt.pts != (s64)AV_NOPTS_VALUE)
 	{
-		pkt.pts = av_rescale_q(pkt.pts, s_codec_context->time_base, s_stream->time_base);
+		pkt.pts = av_rescale_q(pkt.pts, codec_context->time_base, stream->time_base);
 	}
 	if (pkt.dts != (s64)AV_NOPTS_VALUE)
 	{
-		pkt.dts = av_rescale_q(pkt.dts, s_codec_context->time_base, s_stream->time_base);
+		pkt.dts = av_rescale_q(pkt.dts, codec_context->time_base, stream->time_base);
 	}
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(56, 60, 100)
-	if (s_codec_context->coded_frame->key_frame)
+	if (codec_context->coded_frame->key_frame)
 		pkt.flags |= AV_PKT_FLAG_KEY;
 #endif
-	pkt.stream_index = s_stream->index;
+	pkt.stream_index = stream->index;
 	av_interleaved_write_frame(s_format_context, &pkt);
 }
 
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 37, 100)
+// Encodes <count> interleaved stereo samples, or drains the encoder if <samples> is null.
+// Must be called with s_mux_lock held.
+static void EncodeAudio(const s16* samples, int count)
+{
+	AVFrame* frame = nullptr;
+	if (samples)
+	{
+		frame = s_audio_frame;
+		if (av_frame_make_writable(frame) < 0)
+			return;
+		frame->nb_samples = count;
+
+		switch (s_audio_codec_context->sample_fmt)
+		{
+		case AV_SAMPLE_FMT_S16:
+			memcpy(frame->data[0], samples, count * 2 * sizeof(s16));
+			break;
+		case AV_SAMPLE_FMT_S16P:
+			for (int i = 0; i < count; ++i)
+			{
+				reinterpret_cast<s16*>(frame->data[0])[i] = samples[i * 2];
+				reinterpret_cast<s16*>(frame->data[1])[i] = samples[i * 2 + 1];
+			}
+			break;
+		case AV_SAMPLE_FMT_FLT:
+			for (int i = 0; i < count * 2; ++i)
+				reinterpret_cast<float*>(frame->data[0])[i] = samples[i] / 32768.0f;
+			break;
+		case AV_SAMPLE_FMT_FLTP:
+			for (int i = 0; i < count; ++i)
+			{
+				reinterpret_cast<float*>(frame->data[0])[i] = samples[i * 2] / 32768.0f;
+				reinterpret_cast<float*>(frame->data[1])[i] = samples[i * 2 + 1] / 32768.0f;
+			}
+			break;
+		default:
+			return;
+		}
+
+		frame->pts = s_audio_next_pts;
+		s_audio_next_pts += count;
+	}
+
+	int error = avcodec_send_frame(s_audio_codec_context, frame);
+	while (!error)
+	{
+		AVPacket pkt;
+		PreparePacket(&pkt);
+		error = avcodec_receive_packet(s_audio_codec_context, &pkt);
+		if (!error)
+			WritePacket(pkt, s_audio_codec_context, s_audio_stream);
+	}
+	if (error != AVERROR(EAGAIN) && error != AVERROR_EOF)
+		ERROR_LOG(VIDEO, "Error while encoding audio: %d", error);
+}
+
+// Linear resampling for chunks which don't match the stream rate (the DSP rate changed, or the
+// encoder doesn't support it). The fraction is carried over so consecutive chunks don't drift.
+static std::vector<s16> ResampleAudio(const std::vector<s16>& samples, u32 src_rate, u32 dst_rate)
+{
+	const u64 src_count = samples.size() / 2;
+	const u64 scaled = src_count * dst_rate + s_audio_resample_remainder;
+	const u64 dst_count = scaled / src_rate;
+	s_audio_resample_remainder = scaled % src_rate;
+
+	std::vector<s16> resampled(dst_count * 2);
+	for (u64 i = 0; i < dst_count; ++i)
+	{
+		const double pos = (double)i * src_rate / dst_rate;
+		const u64 index = std::min((u64)pos, src_count - 1);
+		const u64 next = std::min(index + 1, src_count - 1);
+		const double frac = pos - (double)index;
+		for (int channel = 0; channel < 2; ++channel)
+		{
+			const double a = samples[index * 2 + channel];
+			const double b = samples[next * 2 + channel];
+			resampled[i * 2 + channel] = (s16)(a + (b - a) * frac);
+		}
+	}
+	return resampled;
+}
+
+// Must be called with s_mux_lock held, once the audio start has been decided.
+static void AddAudioToFifo(const PendingAudio& chunk)
+{
+	const u32 sample_rate = s_audio_codec_context->sample_rate;
+	std::vector<s16> resampled;
+	const std::vector<s16>* chunk_samples = &chunk.samples;
+	if (chunk.sample_rate != sample_rate)
+	{
+		resampled = ResampleAudio(chunk.samples, chunk.sample_rate, sample_rate);
+		chunk_samples = &resampled;
+	}
+
+	const s16* samples = chunk_samples->data();
+	s64 count = chunk_samples->size() / 2;
+	if (!count)
+		return;
+
+	// Place the first chunk by its emulated time, everything after follows on without gaps.
+	if (s_audio_next_pts < 0)
+	{
+		const s64 start_ticks =
+			(s64)chunk.ticks - count * s_audio_ticks_per_second / sample_rate;
+		s64 pts = ((s64)s_audio_start_pts_ticks + start_ticks - (s64)s_audio_start_ticks) *
+			(s64)sample_rate / s_audio_ticks_per_second;
+		if (pts + count <= 0)
+			return;
+		if (pts < 0)
+		{
+			samples -= pts * 2;
+			count += pts;
+			pts = 0;
+		}
+		s_audio_next_pts = pts;
+	}
+
+	s_audio_fifo.insert(s_audio_fifo.end(), samples, samples + count * 2);
+
+	size_t offset = 0;
+	while (s_audio_fifo.size() - offset >= (size_t)s_audio_frame_size * 2)
+	{
+		EncodeAudio(s_audio_fifo.data() + offset, s_audio_frame_size);
+		offset += s_audio_frame_size * 2;
+	}
+	s_audio_fifo.erase(s_audio_fifo.begin(), s_audio_fifo.begin() + offset);
+}
+#endif
+
+// Called from the CPU thread through the mixer, only queues the samples.
+static void AddSoundSamples(const s16* samples, u32 num_samples, u32 sample_rate)
+{
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 37, 100)
+	if (!g_Config.bDumpAudioInVideo || !SConfig::GetInstance().m_DumpFrames || !num_samples)
+		return;
+
+	PendingAudio chunk;
+	chunk.ticks = CoreTiming::GetTicks();
+	chunk.sample_rate = sample_rate;
+	chunk.samples.resize(num_samples * 2);
+	for (u32 i = 0; i < num_samples * 2; ++i)
+		chunk.samples[i] = Common::swap16(samples[i]);
+
+	std::lock_guard<std::mutex> lk(s_pending_audio_lock);
+	s_pending_audio_samples += num_samples;
+	s_pending_audio.push_back(std::move(chunk));
+	// Until the first video frame, keep up to two seconds for the frame dumping thread to catch up.
+	if (s_audio_started.load())
+		return;
+	while (s_pending_audio_samples > sample_rate * 2)
+	{
+		s_pending_audio_samples -= (u32)s_pending_audio.front().samples.size() / 2;
+		s_pending_audio.pop_front();
+	}
+#endif
+}
+
+// Must be called with s_mux_lock held, encodes what the CPU thread queued so far.
+static void FlushPendingAudio()
+{
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 37, 100)
+	if (!s_audio_stream || !s_audio_started.load())
+		return;
+
+	std::deque<PendingAudio> pending;
+	{
+		std::lock_guard<std::mutex> lk(s_pending_audio_lock);
+		pending.swap(s_pending_audio);
+		s_pending_audio_samples = 0;
+	}
+	for (const PendingAudio& chunk : pending)
+		AddAudioToFifo(chunk);
+#endif
+}
+
+// Must be called with s_mux_lock held.
+static void StartAudio(u64 ticks, u64 pts_in_ticks, u32 ticks_per_second)
+{
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 37, 100)
+	s_audio_start_ticks = ticks;
+	s_audio_start_pts_ticks = pts_in_ticks;
+	s_audio_ticks_per_second = ticks_per_second;
+	s_audio_started = true;
+#endif
+}
+
 void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const Frame& state)
 {
 #ifdef IS_PLAYBACK
@@ -378,18 +785,38 @@ void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const
 		s_last_pts = pts_in_ticks;
 		error = SendFrameAndReceivePacket(s_codec_context, &pkt, s_scaled_frame, &got_packet);
 	}
+
+	std::lock_guard<std::mutex> lk(s_mux_lock);
+	if (s_audio_stream && !s_audio_started.load())
+		StartAudio(state.ticks, pts_in_ticks, state.ticks_per_second);
 	if (!error && got_packet)
 	{
-		WritePacket(pkt);
+		WritePacket(pkt, s_codec_context, s_stream);
 	}
+	FlushPendingAudio();
 	if (error)
 		ERROR_LOG(VIDEO, "Error while encoding video: %d", error);
 }
 
+// Must be called with s_mux_lock held.
 static void HandleDelayedPackets()
 {
 	AVPacket pkt;
 
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 37, 100)
+	// Frame threaded encoders hold on to several frames until they are told to drain.
+	avcodec_send_frame(s_codec_context, nullptr);
+
+	if (s_audio_stream)
+	{
+		FlushPendingAudio();
+		if (!s_audio_fifo.empty())
+			EncodeAudio(s_audio_fifo.data(), (int)s_audio_fifo.size() / 2);
+		s_audio_fifo.clear();
+		EncodeAudio(nullptr, 0);
+	}
+#endif
+
 	while (true)
 	{
 		PreparePacket(&pkt);
@@ -404,12 +831,14 @@ static void HandleDelayedPackets()
 		if (!got_packet)
 			break;
 
-		WritePacket(pkt);
+		WritePacket(pkt, s_codec_context, s_stream);
 	}
 }
 
 void AVIDump::Stop()
 {
+	AudioCommon::SetSoundDumpCallback(nullptr);
+	std::lock_guard<std::mutex> lk(s_mux_lock);
 	HandleDelayedPackets();
 	av_write_trailer(s_format_context);
 	CloseVideoFile();
@@ -420,6 +849,9 @@ void AVIDump::Stop()
 
 void AVIDump::CloseVideoFile()
 {
+	CloseAudioStream();
+	s_audio_started = false;
+
 	av_frame_free(&s_src_frame);
 	av_frame_free(&s_scaled_frame);
 
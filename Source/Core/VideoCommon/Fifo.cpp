@@ -243,6 +243,38 @@ static void ReadDataFromFifo(u32 readPtr)
 	s_video_buffer_write_ptr += len;
 }
 
+// Runs every command completed by the 32 byte block at readPtr. In dual core and single core
+// without the deterministic gpu thread, the block is decoded straight from emulated RAM while
+// the video buffer is empty. Returns whether all the data read so far was consumed.
+static bool RunFifoBlock(u32 readPtr, u32* cycles)
+{
+	// Only MEM1, so that SIMD overreads in the vertex loader stay in the allocation
+	if (s_video_buffer_read_ptr != s_video_buffer_write_ptr ||
+		(readPtr & 0x3FFFFFFF) >= Memory::REALRAM_SIZE)
+	{
+		ReadDataFromFifo(readPtr);
+		u8* write_ptr = s_video_buffer_write_ptr;
+		g_VideoData.SetReadPosition(s_video_buffer_read_ptr, write_ptr);
+		s_video_buffer_read_ptr = OpcodeDecoder::Run(g_VideoData, cycles);
+		return s_video_buffer_read_ptr == write_ptr;
+	}
+
+	u8* block = Memory::GetPointer(readPtr);
+	u8* block_end = block + 32;
+	g_VideoData.SetReadPosition(block, block_end);
+	u8* read_ptr = OpcodeDecoder::Run(g_VideoData, cycles);
+	if (read_ptr == block_end)
+		return true;
+
+	// The CPU is free to overwrite the block once it is retired, so the incomplete command is
+	// copied to the video buffer right away and the next blocks are appended to it.
+	size_t len = block_end - read_ptr;
+	memcpy(s_video_buffer, read_ptr, len);
+	s_video_buffer_read_ptr = s_video_buffer;
+	s_video_buffer_write_ptr = s_video_buffer + len;
+	return false;
+}
+
 // The deterministic_gpu_thread version.
 static void ReadDataFromFifoOnCPU(u32 readPtr)
 {
@@ -338,7 +370,7 @@ void RunGpuLoop()
 
 				u32 cyclesExecuted = 0;
 				u32 readPtr = fifo.CPReadPointer;
-				ReadDataFromFifo(readPtr);
+				bool consumed = RunFifoBlock(readPtr, &cyclesExecuted);
 
 				if (readPtr == fifo.CPEnd)
 					readPtr = fifo.CPBase;
@@ -350,13 +382,9 @@ void RunGpuLoop()
 					"instability in the game. Please report it.",
 					fifo.CPReadWriteDistance - 32);
 
-				u8* write_ptr = s_video_buffer_write_ptr;
-				g_VideoData.SetReadPosition(s_video_buffer_read_ptr, write_ptr);
-				s_video_buffer_read_ptr = OpcodeDecoder::Run(g_VideoData, &cyclesExecuted);
-
 				Common::AtomicStore(fifo.CPReadPointer, readPtr);
 				Common::AtomicAdd(fifo.CPReadWriteDistance, -32);
-				if ((write_ptr - s_video_buffer_read_ptr) == 0)
+				if (consumed)
 					Common::AtomicStore(fifo.SafeCPReadPointer, fifo.CPReadPointer);
 
 				CommandProcessor::SetCPStatusFromGPU();
@@ -460,10 +488,8 @@ static int RunGpuOnCpu(int ticks)
 				FPURoundMode::LoadDefaultSIMDState();
 				reset_simd_state = true;
 			}
-			ReadDataFromFifo(fifo.CPReadPointer);
 			u32 cycles = 0;
-			g_VideoData.SetReadPosition(s_video_buffer_read_ptr, s_video_buffer_write_ptr);
-				s_video_buffer_read_ptr = OpcodeDecoder::Run(g_VideoData, &cycles);
+			RunFifoBlock(fifo.CPReadPointer, &cycles);
 			available_ticks -= cycles;
 		}
 
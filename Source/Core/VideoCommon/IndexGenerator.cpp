@@ -5,6 +5,7 @@
 #include <cstddef>
 
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OpcodeDecoding.h"
@@ -15,22 +16,84 @@ u16 *IndexGenerator::index_buffer_current;
 u16 *IndexGenerator::BASEIptr;
 u32 IndexGenerator::base_index;
 
-static void(*primitive_table[8])(u32);
+#ifdef _M_X86_64
+// Large batches are written 8 indices per store. Every primitive type boils down to a
+// pattern of indices which repeats with each index moved by a constant step, so the
+// kernels only add the steps to a few registers between stores. The scalar loops then finish
+// whatever doesn't fill a whole pattern.
 
-void IndexGenerator::Init()
+// Writes consecutive indices starting at <first> in groups of 8, at most <count> of them.
+// Returns how many were written.
+static u32 WriteSequentialIndices(u16* ptr, u32 first, u32 count)
 {
-	primitive_table[GX_DRAW_QUADS] = IndexGenerator::AddQuads;
+	const __m128i step = _mm_set1_epi16(8);
+	__m128i indices = _mm_add_epi16(_mm_set1_epi16((s16)first), _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7));
+	u32 written = 0;
+	for (; written + 8 <= count; written += 8)
+	{
+		_mm_storeu_si128((__m128i*)(ptr + written), indices);
+		indices = _mm_add_epi16(indices, step);
+	}
+	return written;
+}
+
+// Writes <iterations> times 24 indices, each lane of <pattern> moving by the matching lane of
+// <step> every time
+static u16* WriteIndexPattern(u16* ptr, __m128i (&pattern)[3], const __m128i (&step)[3], u32 iterations)
+{
+	for (u32 i = 0; i < iterations; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			_mm_storeu_si128((__m128i*)(ptr + j * 8), pattern[j]);
+			pattern[j] = _mm_add_epi16(pattern[j], step[j]);
+		}
+		ptr += 24;
+	}
+	return ptr;
+}
+
+static __m128i ShiftIndices(u32 offset, __m128i indices)
+{
+	return _mm_add_epi16(_mm_set1_epi16((s16)offset), indices);
+}
+#endif
+
+void IndexGenerator::AddIndices(int primitive, u32 numVerts)
+{
+	// A switch lets the compiler inline the generators instead of calling through a table
+	switch (primitive)
+	{
+	case GX_DRAW_QUADS:
+		AddQuads(numVerts);
+		break;
+	case GX_DRAW_QUADS_2:
 #if defined(_DEBUG) || defined(DEBUGFAST)
-	primitive_table[GX_DRAW_QUADS_2] = IndexGenerator::AddQuads_nonstandard;
+		AddQuads_nonstandard(numVerts);
 #else
-	primitive_table[GX_DRAW_QUADS_2] = IndexGenerator::AddQuads;
+		AddQuads(numVerts);
 #endif
-	primitive_table[GX_DRAW_TRIANGLES] = IndexGenerator::AddList;
-	primitive_table[GX_DRAW_TRIANGLE_STRIP] = IndexGenerator::AddStrip;
-	primitive_table[GX_DRAW_TRIANGLE_FAN] = IndexGenerator::AddFan;
-	primitive_table[GX_DRAW_LINES] = &IndexGenerator::AddLineList;
-	primitive_table[GX_DRAW_LINE_STRIP] = &IndexGenerator::AddLineStrip;
-	primitive_table[GX_DRAW_POINTS] = &IndexGenerator::AddPoints;
+		break;
+	case GX_DRAW_TRIANGLES:
+		AddList(numVerts);
+		break;
+	case GX_DRAW_TRIANGLE_STRIP:
+		AddStrip(numVerts);
+		break;
+	case GX_DRAW_TRIANGLE_FAN:
+		AddFan(numVerts);
+		break;
+	case GX_DRAW_LINES:
+		AddLineList(numVerts);
+		break;
+	case GX_DRAW_LINE_STRIP:
+		AddLineStrip(numVerts);
+		break;
+	case GX_DRAW_POINTS:
+		AddPoints(numVerts);
+		break;
+	}
+	base_index += numVerts;
 }
 
 void IndexGenerator::Start(u16* Indexptr)
@@ -40,12 +103,6 @@ void IndexGenerator::Start(u16* Indexptr)
 	base_index = 0;
 }
 
-void IndexGenerator::AddIndices(int primitive, u32 numVerts)
-{
-	primitive_table[primitive](numVerts);
-	base_index += numVerts;
-}
-
 // Triangles
 __forceinline u16* IndexGenerator::WriteTriangle(u16* ptr, u32 index1, u32 index2, u32 index3)
 {
@@ -60,6 +117,12 @@ void IndexGenerator::AddList(u32 const numVerts)
 	u32 i = base_index + 2;
 	u32 top = (base_index + numVerts);
 	u16* ptr = index_buffer_current;
+#ifdef _M_X86_64
+	// a list of triangles is just every index in order, 8 whole triangles at a time
+	u32 written = WriteSequentialIndices(ptr, base_index, numVerts / 24 * 24);
+	ptr += written;
+	i += written;
+#endif
 	while (i < top)
 	{
 		ptr = WriteTriangle(ptr, i - 2, i - 1, i);
@@ -75,6 +138,23 @@ void IndexGenerator::AddStrip(u32 const numVerts)
 	u32 a = base_index;
 	u32 i = a + 2;
 	u32 wind = 1;
+#ifdef _M_X86_64
+	// 8 triangles at a time, alternating the winding like below. Each pattern holds an even
+	// number of triangles, so the winding of the scalar tail isn't affected.
+	if (numVerts >= 10)
+	{
+		u32 iterations = (numVerts - 2) / 8;
+		__m128i pattern[3] = {
+			ShiftIndices(a, _mm_setr_epi16(0, 1, 2, 1, 3, 2, 2, 3)),
+			ShiftIndices(a, _mm_setr_epi16(4, 3, 5, 4, 4, 5, 6, 5)),
+			ShiftIndices(a, _mm_setr_epi16(7, 6, 6, 7, 8, 7, 9, 8))
+		};
+		const __m128i step = _mm_set1_epi16(8);
+		ptr = WriteIndexPattern(ptr, pattern, { step, step, step }, iterations);
+		a += iterations * 8;
+		i += iterations * 8;
+	}
+#endif
 	while (i < top)
 	{
 		u32 b = i - wind;
@@ -116,6 +196,26 @@ void IndexGenerator::AddFan(u32 numVerts)
 	u32 top = (base_index + numVerts);
 	u16* ptr = index_buffer_current;
 
+#ifdef _M_X86_64
+	// 8 triangles at a time, the lanes holding the center vertex don't move
+	if (numVerts >= 10)
+	{
+		u32 iterations = (numVerts - 2) / 8;
+		const s16 c = (s16)(base_index - (i - 1));
+		__m128i pattern[3] = {
+			ShiftIndices(i - 1, _mm_setr_epi16(c, 0, 1, c, 1, 2, c, 2)),
+			ShiftIndices(i - 1, _mm_setr_epi16(3, c, 3, 4, c, 4, 5, c)),
+			ShiftIndices(i - 1, _mm_setr_epi16(5, 6, c, 6, 7, c, 7, 8))
+		};
+		const __m128i step[3] = {
+			_mm_setr_epi16(0, 8, 8, 0, 8, 8, 0, 8),
+			_mm_setr_epi16(8, 0, 8, 8, 0, 8, 8, 0),
+			_mm_setr_epi16(8, 8, 0, 8, 8, 0, 8, 8)
+		};
+		ptr = WriteIndexPattern(ptr, pattern, step, iterations);
+		i += iterations * 8;
+	}
+#endif
 	while (i < top)
 	{
 		ptr = WriteTriangle(ptr, base_index, i - 1, i);
@@ -146,6 +246,21 @@ void IndexGenerator::AddQuads(u32 numVerts)
 	u32 i = base_index + 3;
 	u32 top = (base_index + numVerts);
 	u16* ptr = index_buffer_current;
+#ifdef _M_X86_64
+	// 4 quads at a time
+	u32 iterations = numVerts / 16;
+	if (iterations)
+	{
+		__m128i pattern[3] = {
+			ShiftIndices(base_index, _mm_setr_epi16(0, 1, 2, 0, 2, 3, 4, 5)),
+			ShiftIndices(base_index, _mm_setr_epi16(6, 4, 6, 7, 8, 9, 10, 8)),
+			ShiftIndices(base_index, _mm_setr_epi16(10, 11, 12, 13, 14, 12, 14, 15))
+		};
+		const __m128i step = _mm_set1_epi16(16);
+		ptr = WriteIndexPattern(ptr, pattern, { step, step, step }, iterations);
+		i += iterations * 16;
+	}
+#endif
 	while (i < top)
 	{
 		ptr = WriteTriangle(ptr, i - 3, i - 2, i - 1);
@@ -173,6 +288,11 @@ void IndexGenerator::AddLineList(u32 numVerts)
 	u32 i = base_index + 1;
 	u32 top = (base_index + numVerts);
 	u16* ptr = index_buffer_current;
+#ifdef _M_X86_64
+	u32 written = WriteSequentialIndices(ptr, base_index, numVerts / 2 * 2);
+	ptr += written;
+	i += written;
+#endif
 	while (i < top)
 	{
 		*ptr++ = i - 1;
@@ -189,6 +309,21 @@ void IndexGenerator::AddLineStrip(u32 numVerts)
 	u32 i = base_index + 1;
 	u32 top = (base_index + numVerts);
 	u16* ptr = index_buffer_current;
+#ifdef _M_X86_64
+	// 12 lines at a time
+	if (numVerts >= 13)
+	{
+		u32 iterations = (numVerts - 1) / 12;
+		__m128i pattern[3] = {
+			ShiftIndices(base_index, _mm_setr_epi16(0, 1, 1, 2, 2, 3, 3, 4)),
+			ShiftIndices(base_index, _mm_setr_epi16(4, 5, 5, 6, 6, 7, 7, 8)),
+			ShiftIndices(base_index, _mm_setr_epi16(8, 9, 9, 10, 10, 11, 11, 12))
+		};
+		const __m128i step = _mm_set1_epi16(12);
+		ptr = WriteIndexPattern(ptr, pattern, { step, step, step }, iterations);
+		i += iterations * 12;
+	}
+#endif
 	while (i < top)
 	{
 		*ptr++ = i - 1;
@@ -204,6 +339,11 @@ void IndexGenerator::AddPoints(u32 numVerts)
 	u32 i = base_index;
 	u32 top = (base_index + numVerts);
 	u16 *ptr = index_buffer_current;
+#ifdef _M_X86_64
+	u32 written = WriteSequentialIndices(ptr, base_index, numVerts);
+	ptr += written;
+	i += written;
+#endif
 	while (i < top)
 	{
 		*ptr++ = i;
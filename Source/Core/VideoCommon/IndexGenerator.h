@@ -8,8 +8,6 @@
 class IndexGenerator
 {
 public:
-	// Init
-	static void Init();
 	static void Start(u16 *Indexptr);
 
 	static void AddIndices(int primitive, u32 numVertices);
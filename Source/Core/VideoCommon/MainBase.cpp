@@ -18,7 +18,6 @@
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/TessellationShaderManager.h"
-#include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/PixelEngine.h"
@@ -220,7 +219,6 @@ void VideoBackendBase::InitializeShared()
 	PixelEngine::Init();
 	BPInit();
 	VertexLoaderManager::Init();
-	IndexGenerator::Init();
 	VertexShaderManager::Init();
 	GeometryShaderManager::Init();
 	PixelShaderManager::Init(!(g_ActiveConfig.backend_info.APIType & API_D3D9));
@@ -72,11 +72,13 @@ public:
 		m_category_mask = pKey_t(1) << (m_category_id % (sizeof(pKey_t) * 8));
 	}
 
-	TInfo& GetOrAdd(const Tobj& obj)
+	// track_usage is false for lookups that don't come from the game, like loading
+	// the shader cache or precompiling, so they don't skew the profile
+	TInfo& GetOrAdd(const Tobj& obj, bool track_usage = true)
 	{
 		ObjectMetadata& item = m_objects[obj];
 
-		if (item.usage_count < LLONG_MAX)
+		if (track_usage && item.usage_count < LLONG_MAX)
 		{
 			item.usage_count++;
 		}
@@ -88,7 +90,7 @@ public:
 		{
 			item.category_mask.resize(m_max_category_index);
 		}
-		if ((item.category_mask[m_category_index] & m_category_mask) == 0)
+		if (track_usage && (item.category_mask[m_category_index] & m_category_mask) == 0)
 		{
 			item.category_mask[m_category_index] |= m_category_mask;
 			if (item.category_count < LLONG_MAX)
@@ -235,25 +237,31 @@ public:
 				bwrite(out, item.second);
 			}
 		}
-		size_t object_count = 0;
-		if (allcategories || m_categories.size() == 1)
+		// Objects that were only looked up without tracking are not part of the profile
+		auto persisted = [&](const ObjectMetadata& item)
 		{
-			object_count = m_objects.size();
-		}
-		else
+			if (allcategories)
+			{
+				return true;
+			}
+			if (item.usage_count == 0)
+			{
+				return false;
+			}
+			return m_categories.size() == 1 || (item.category_mask[m_category_index] & m_category_mask) != 0;
+		};
+		size_t object_count = 0;
+		for (auto& item : m_objects)
 		{
-			for (auto& item : m_objects)
+			if (persisted(item.second))
 			{
-				if ((item.second.category_mask[m_category_index] & m_category_mask) != 0)
-				{
-					object_count++;
-				}
+				object_count++;
 			}
 		}
 		bwrite(out, object_count);
 		for (auto& item : m_objects)
 		{
-			if (allcategories || m_categories.size() == 1 || (item.second.category_mask[m_category_index] & m_category_mask) != 0)
+			if (persisted(item.second))
 			{
 				bwrite(out, item.first);
 				if (allcategories)
@@ -901,17 +901,16 @@ void Renderer::ShutdownFrameDumping()
 	if (!m_frame_dump_thread_running.IsSet())
 		return;
 
-	FinishFrameData();
-	m_frame_dump_thread_running.Clear();
-	m_frame_dump_start.Set();
+	// The dumping thread writes out whatever is still queued before it exits.
+	{
+		std::lock_guard<std::mutex> lk(m_frame_dump_queue_lock);
+		m_frame_dump_thread_running.Clear();
+	}
+	m_frame_dump_queue_not_empty.notify_one();
 }
 
 void Renderer::DumpFrameData(const u8* data, int w, int h, int stride, const AVIDump::Frame& state, bool swap_upside_down, bool bgra)
 {
-	FinishFrameData();
-
-	m_frame_dump_config = FrameDumpConfig{ data, w, h, stride, swap_upside_down, bgra, state };
-
 	if (!m_frame_dump_thread_running.IsSet())
 	{
 		if (m_frame_dump_thread.joinable())
@@ -920,17 +919,48 @@ void Renderer::DumpFrameData(const u8* data, int w, int h, int stride, const AVI
 		m_frame_dump_thread = std::thread(&Renderer::RunFrameDumps, this);
 	}
 
-	m_frame_dump_start.Set();
-	m_frame_dump_frame_running = true;
+	FrameDumpConfig config{ nullptr, w, h, stride, swap_upside_down, bgra, state };
+	config.screenshot = m_screenshot_request.TestAndClear();
+	if (m_frame_dump_new_file.TestAndClear())
+	{
+		std::lock_guard<std::mutex> lk(m_frame_dump_new_file_lock);
+		config.new_file = true;
+		config.new_directory = m_frame_dump_new_directory;
+		config.new_filename_base = m_frame_dump_new_filename_base;
+	}
+
+	{
+		// Only block the GPU thread when the encoder has fallen too far behind.
+		std::unique_lock<std::mutex> lk(m_frame_dump_queue_lock);
+		m_frame_dump_queue_not_full.wait(lk, [this] {
+			return m_frame_dump_queue.size() < MAX_QUEUED_FRAME_DUMPS;
+		});
+
+		if (!m_frame_dump_free_buffers.empty())
+		{
+			config.buffer = std::move(m_frame_dump_free_buffers.back());
+			m_frame_dump_free_buffers.pop_back();
+		}
+	}
+
+	// The caller's buffer is only valid during this call, so copy the frame into our own.
+	config.buffer.resize(static_cast<size_t>(h) * stride);
+	memcpy(config.buffer.data(), data, config.buffer.size());
+	config.data = config.buffer.data();
+
+	{
+		std::lock_guard<std::mutex> lk(m_frame_dump_queue_lock);
+		m_frame_dump_queue.push_back(std::move(config));
+	}
+	m_frame_dump_queue_not_empty.notify_one();
 }
 
-void Renderer::FinishFrameData()
+void Renderer::StartNewFrameDumpFile(const std::string& directory, const std::string& filename_base)
 {
-	if (!m_frame_dump_frame_running)
-		return;
-
-	m_frame_dump_done.Wait();
-	m_frame_dump_frame_running = false;
+	std::lock_guard<std::mutex> lk(m_frame_dump_new_file_lock);
+	m_frame_dump_new_directory = directory;
+	m_frame_dump_new_filename_base = filename_base;
+	m_frame_dump_new_file.Set();
 }
 
 void Renderer::RunFrameDumps()
@@ -951,11 +981,18 @@ void Renderer::RunFrameDumps()
 
 	while (true)
 	{
-		m_frame_dump_start.Wait();
-		if (!m_frame_dump_thread_running.IsSet())
-			break;
-
-		auto config = m_frame_dump_config;
+		FrameDumpConfig config;
+		{
+			std::unique_lock<std::mutex> lk(m_frame_dump_queue_lock);
+			m_frame_dump_queue_not_empty.wait(lk, [this] {
+				return !m_frame_dump_queue.empty() || !m_frame_dump_thread_running.IsSet();
+			});
+			if (m_frame_dump_queue.empty())
+				break;
+
+			config = std::move(m_frame_dump_queue.front());
+			m_frame_dump_queue.pop_front();
+		}
 
 		if (config.upside_down)
 		{
@@ -964,7 +1001,7 @@ void Renderer::RunFrameDumps()
 		}
 
 		// Save screenshot
-		if (m_screenshot_request.TestAndClear())
+		if (config.screenshot)
 		{
 			std::lock_guard<std::mutex> lk(m_screenshot_lock);
 
@@ -977,6 +1014,17 @@ void Renderer::RunFrameDumps()
 			m_screenshot_completed.Set();
 		}
 
+		if (config.new_file)
+		{
+			if (frame_dump_started && dump_to_avi)
+				StopFrameDumpToAVI();
+			frame_dump_started = false;
+
+			// The dump file names are only read when starting a dump, which happens on this thread.
+			SConfig::GetInstance().m_strOutputDirectory = config.new_directory;
+			SConfig::GetInstance().m_strOutputFilenameBase = config.new_filename_base;
+		}
+
 		if (SConfig::GetInstance().m_DumpFrames)
 		{
 			if (!frame_dump_started)
@@ -1003,7 +1051,11 @@ void Renderer::RunFrameDumps()
 			}
 		}
 
-		m_frame_dump_done.Set();
+		{
+			std::lock_guard<std::mutex> lk(m_frame_dump_queue_lock);
+			m_frame_dump_free_buffers.push_back(std::move(config.buffer));
+		}
+		m_frame_dump_queue_not_full.notify_one();
 	}
 
 	if (frame_dump_started)
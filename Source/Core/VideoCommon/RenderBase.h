@@ -14,6 +14,7 @@
 
 #pragma once
 #include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -109,6 +110,10 @@ public:
 	TargetRectangle CalculateFrameDumpDrawRectangle();
 	void UpdateDrawRectangle();
 
+	// Closes the current frame dump and continues dumping to <directory><filename_base>.
+	// Takes effect from the next frame handed to the frame dumping thread.
+	void StartNewFrameDumpFile(const std::string& directory, const std::string& filename_base);
+
 
 
 	// Use this to convert a single target rectangle to two stereo rectangles
@@ -159,8 +164,9 @@ protected:
 	static void RecordVideoMemory();
 
 	bool IsFrameDumping();
+	// Copies the frame and queues it for the frame dumping thread, so <data> may be reused as soon
+	// as this returns. Only blocks when MAX_QUEUED_FRAME_DUMPS frames are already waiting.
 	void DumpFrameData(const u8* data, int w, int h, int stride, const AVIDump::Frame& state, bool swap_upside_down = false, bool bgra = false);
-	void FinishFrameData();
 
 	Common::Flag m_screenshot_request;
 	Common::Event m_screenshot_completed;
@@ -205,12 +211,15 @@ private:
 	int m_last_window_request_height = 0;
 
 	// frame dumping
+	static const size_t MAX_QUEUED_FRAME_DUMPS = 4;
+
 	std::thread m_frame_dump_thread;
-	Common::Event m_frame_dump_start;
-	Common::Event m_frame_dump_done;
 	Common::Flag m_frame_dump_thread_running;
 	u32 m_frame_dump_image_counter = 0;
-	bool m_frame_dump_frame_running = false;
+	Common::Flag m_frame_dump_new_file;
+	std::mutex m_frame_dump_new_file_lock;
+	std::string m_frame_dump_new_directory;
+	std::string m_frame_dump_new_filename_base;
 
 	struct FrameDumpConfig
 	{
@@ -221,7 +230,21 @@ private:
 		bool upside_down;
 		bool bgra;
 		AVIDump::Frame state;
-	} m_frame_dump_config;
+
+		// Requests are tied to the frame they were made on, however far behind the dumping thread is.
+		bool screenshot = false;
+		bool new_file = false;
+		std::string new_directory;
+		std::string new_filename_base;
+
+		std::vector<u8> buffer;
+	};
+
+	std::mutex m_frame_dump_queue_lock;
+	std::condition_variable m_frame_dump_queue_not_empty;
+	std::condition_variable m_frame_dump_queue_not_full;
+	std::deque<FrameDumpConfig> m_frame_dump_queue;
+	std::vector<std::vector<u8>> m_frame_dump_free_buffers;
 
 	// NOTE: The methods below are called on the framedumping thread.
 	bool StartFrameDumpToAVI(const FrameDumpConfig& config);
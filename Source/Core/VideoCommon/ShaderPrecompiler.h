@@ -0,0 +1,161 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/CPUDetect.h"
+#include "Common/ThreadPool.h"
+
+// Compiles the shaders a game used the most in previous runs without blocking the boot.
+// The uids are taken in the order given (most used first, see ObjectUsageProfiler). Their code
+// is generated on the thread pool a few shaders ahead, the part that needs the graphics API
+// is done from the GPU thread by Process(), strictly in order and within a time budget.
+// Shaders requested before their turn keep being compiled on demand by the backend, the
+// compile handler is expected to skip them.
+template <typename Tuid, typename Tcode>
+class ShaderPrecompiler
+{
+public:
+	// Called from the thread pool, returns false to skip the shader
+	using GenerateHandler = std::function<bool(const Tuid&, Tcode&)>;
+	// Called from the GPU thread, in order
+	using CompileHandler = std::function<void(const Tuid&, Tcode&)>;
+
+	// Limits the memory used by generated code waiting to be compiled
+	static const size_t GENERATE_AHEAD = 64;
+
+	ShaderPrecompiler(const std::vector<Tuid>& uids, GenerateHandler generate, CompileHandler compile)
+		: m_state(std::make_shared<State>(uids.size())), m_compile(std::move(compile))
+	{
+		for (size_t i = 0; i < uids.size(); i++)
+			m_state->items[i].uid = uids[i];
+		m_state->generate = std::move(generate);
+		// Leave some of the pool to the other workers
+		m_max_tasks = std::max(1, (cpu_info.logical_cpu_count - 1) / 2);
+		ScheduleTasks();
+	}
+
+	~ShaderPrecompiler()
+	{
+		// Running tasks hold their own reference to the state and stop at the next shader
+		m_state->cancelled.store(true);
+	}
+
+	// Compiles every shader which is ready, in order, until <budget> is spent. At least one
+	// shader is compiled if possible. Returns true once every shader went through.
+	bool Process(std::chrono::microseconds budget)
+	{
+		const auto deadline = std::chrono::steady_clock::now() + budget;
+		std::vector<Item>& items = m_state->items;
+		size_t next = m_state->next_compile.load(std::memory_order_relaxed);
+		while (next < items.size())
+		{
+			Item& item = items[next];
+			u32 status = item.status.load(std::memory_order_acquire);
+			if (status == STATUS_PENDING)
+				break;
+			if (status == STATUS_READY)
+			{
+				m_compile(item.uid, item.code);
+				m_compiled++;
+			}
+			item.code = Tcode();
+			m_state->next_compile.store(++next, std::memory_order_release);
+			if (std::chrono::steady_clock::now() >= deadline)
+				break;
+		}
+		ScheduleTasks();
+		return next == items.size();
+	}
+
+	bool IsDone() const
+	{
+		return m_state->next_compile.load(std::memory_order_relaxed) == m_state->items.size();
+	}
+
+	size_t GetTotalCount() const
+	{
+		return m_state->items.size();
+	}
+
+	size_t GetCompiledCount() const
+	{
+		return m_compiled;
+	}
+
+private:
+	enum : u32
+	{
+		STATUS_PENDING,
+		STATUS_READY,
+		STATUS_SKIPPED,
+	};
+
+	struct Item
+	{
+		Tuid uid;
+		Tcode code;
+		std::atomic<u32> status{STATUS_PENDING};
+	};
+
+	struct State
+	{
+		explicit State(size_t count) : items(count)
+		{}
+		std::vector<Item> items;
+		GenerateHandler generate;
+		std::atomic<size_t> next_generate{0};
+		std::atomic<size_t> next_compile{0};
+		std::atomic<s32> running_tasks{0};
+		std::atomic<bool> cancelled{false};
+	};
+
+	static void GenerateTask(const std::shared_ptr<State>& state)
+	{
+		std::vector<Item>& items = state->items;
+		while (!state->cancelled.load(std::memory_order_relaxed))
+		{
+			size_t index = state->next_generate.load();
+			if (index >= items.size() ||
+				index >= state->next_compile.load(std::memory_order_acquire) + GENERATE_AHEAD)
+			{
+				break;
+			}
+			if (!state->next_generate.compare_exchange_weak(index, index + 1))
+				continue;
+			Item& item = items[index];
+			bool generated = state->generate(item.uid, item.code);
+			item.status.store(generated ? STATUS_READY : STATUS_SKIPPED, std::memory_order_release);
+		}
+		state->running_tasks.fetch_sub(1);
+	}
+
+	// Tasks stop once they get too far ahead of the GPU thread, so they are restarted from here
+	void ScheduleTasks()
+	{
+		size_t pending = std::min(m_state->items.size(),
+			m_state->next_compile.load(std::memory_order_relaxed) + GENERATE_AHEAD) -
+			std::min(m_state->items.size(), m_state->next_generate.load());
+		s32 wanted = static_cast<s32>(std::min<size_t>(pending, m_max_tasks));
+		while (m_state->running_tasks.load() < wanted)
+		{
+			m_state->running_tasks.fetch_add(1);
+			std::shared_ptr<State> state = m_state;
+			Common::AsyncWorker::ExecuteAsync([state]() { GenerateTask(state); });
+		}
+	}
+
+	std::shared_ptr<State> m_state;
+	CompileHandler m_compile;
+	s32 m_max_tasks;
+	size_t m_compiled = 0;
+};
@@ -3,9 +3,13 @@
 // Refer to the license.txt file included.
 // Modified for Ishiiruka by Tino
 
+#include <cstring>
 #include <map>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <xxhash.h>
 
 
 #include "Core/ConfigManager.h"
@@ -14,7 +18,9 @@
 #include "Common/ThreadPool.h"
 #include "Common/StringUtil.h"
 
+#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
@@ -33,6 +39,107 @@ static VertexLoaderMap s_vertex_loader_map;
 static NativeVertexFormatMap s_native_vertex_map;
 static NativeVertexFormat* s_current_vtx_fmt;
 u32 g_current_components;
+
+// Converted vertices of draws submitted again and again with the same bytes (static geometry
+// resent every frame from display lists or main ram). Only draws without indexed attributes
+// are considered, their output then only depends on the source bytes, the loader and the
+// matrix indices.
+namespace
+{
+enum
+{
+	// smaller draws are cheaper to convert than to hash
+	MIN_CACHED_READ_SIZE = 512,
+	MAX_CACHED_BYTES = 32 * 1024 * 1024,
+	// entries not used for that many frames get dropped
+	MAX_CACHED_AGE = 120,
+	CACHE_SWEEP_INTERVAL = 16,
+	// dynamic geometry produces new keys every frame, they must not pile up
+	MAX_FIRST_SIGHTINGS = 4096
+};
+
+struct ConvertedVerticesKey
+{
+	u64 hash;
+	const VertexLoaderBase* loader;
+	u32 matrix_index_a;
+	u32 matrix_index_b;
+	u32 count;
+	u32 primitive;
+
+	bool operator==(const ConvertedVerticesKey& other) const
+	{
+		return hash == other.hash && loader == other.loader &&
+			matrix_index_a == other.matrix_index_a && matrix_index_b == other.matrix_index_b &&
+			count == other.count && primitive == other.primitive;
+	}
+};
+
+struct ConvertedVerticesKeyHasher
+{
+	size_t operator()(const ConvertedVerticesKey& key) const
+	{
+		return static_cast<size_t>(key.hash ^ (key.count * 0x9E3779B97F4A7C15ULL));
+	}
+};
+
+struct ConvertedVertices
+{
+	std::vector<u8> data;
+	s32 count;
+	int last_used;
+};
+}
+
+static std::unordered_map<ConvertedVerticesKey, ConvertedVertices, ConvertedVerticesKeyHasher> s_converted_vertices;
+// Draws seen once, they are only stored when seen again before the next sweep. Static
+// geometry comes back every frame, so this doesn't need to remember much.
+static std::unordered_set<ConvertedVerticesKey, ConvertedVerticesKeyHasher> s_first_sightings;
+static size_t s_converted_vertices_size;
+static int s_converted_vertices_sweep_frame;
+
+static void ClearConvertedVertices()
+{
+	s_converted_vertices.clear();
+	s_first_sightings.clear();
+	s_converted_vertices_size = 0;
+	s_converted_vertices_sweep_frame = frameCount;
+}
+
+static void SweepConvertedVertices()
+{
+	if (frameCount - s_converted_vertices_sweep_frame < CACHE_SWEEP_INTERVAL)
+		return;
+	s_converted_vertices_sweep_frame = frameCount;
+	s_first_sightings.clear();
+	for (auto it = s_converted_vertices.begin(); it != s_converted_vertices.end();)
+	{
+		if (frameCount - it->second.last_used > MAX_CACHED_AGE)
+		{
+			s_converted_vertices_size -= it->second.data.size();
+			it = s_converted_vertices.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+static bool CanCacheConvertedVertices(const VertexLoaderParameters& parameters, u32 readsize)
+{
+	if (!g_ActiveConfig.bCacheConvertedVertices || readsize < MIN_CACHED_READ_SIZE)
+		return false;
+	// the cpu bounding box is computed while converting
+	if (g_ActiveConfig.iBBoxMode == BBoxCPU && BoundingBox::active)
+		return false;
+	for (int i = 0; i < 12; i++)
+	{
+		if (parameters.VtxDesc->GetVertexArrayStatus(i) >= 0x2)
+			return false;
+	}
+	return true;
+}
 // TODO - change into array of pointers. Keep a map of all seen so far.
 // Used in D3D12 backend, to populate input layouts used by cached-to-disk PSOs.
 NativeVertexFormatMap* GetNativeVertexFormatMap()
@@ -190,12 +297,14 @@ void Init()
 	for (VertexLoaderBase*& vertexLoader : g_main_cp_state.vertex_loaders)
 		vertexLoader = nullptr;
 	last_game_code = SConfig::GetInstance().m_strGameID;
+	ClearConvertedVertices();
 }
 
 void Shutdown()
 {
 	if (s_vertex_loader_map.size() > 0 && g_ActiveConfig.bDumpVertexLoaders)
 		DumpLoadersCode();
+	ClearConvertedVertices();
 	s_vertex_loader_map.clear();
 	s_native_vertex_map.clear();
 }
@@ -305,7 +414,51 @@ bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &wri
 	g_current_components = loader->m_native_components;
 	g_vertex_manager->PrepareForAdditionalData(parameters.primitive, parameters.count, loader->m_native_stride);
 	parameters.destination = g_vertex_manager->GetCurrentBufferPointer();
-	s32 finalcount = loader->RunVertices(parameters);
+	s32 finalcount;
+	if (CanCacheConvertedVertices(parameters, readsize))
+	{
+		SweepConvertedVertices();
+		ConvertedVerticesKey key;
+		key.hash = XXH64(parameters.source, readsize);
+		key.loader = loader;
+		key.matrix_index_a = g_main_cp_state.matrix_index_a.Hex;
+		key.matrix_index_b = g_main_cp_state.matrix_index_b.Hex;
+		key.count = parameters.count;
+		key.primitive = parameters.primitive;
+		auto cached = s_converted_vertices.find(key);
+		if (cached != s_converted_vertices.end())
+		{
+			cached->second.last_used = frameCount;
+			finalcount = cached->second.count;
+			memcpy(parameters.destination, cached->second.data.data(), cached->second.data.size());
+			loader->m_numLoadedVertices += parameters.count;
+		}
+		else
+		{
+			finalcount = loader->RunVertices(parameters);
+			const size_t size = loader->m_native_stride * finalcount;
+			// one-off draws are never stored, the first sighting only remembers the key
+			if (s_first_sightings.erase(key))
+			{
+				if (s_converted_vertices_size + size <= MAX_CACHED_BYTES)
+				{
+					ConvertedVertices& entry = s_converted_vertices[key];
+					entry.data.assign(parameters.destination, parameters.destination + size);
+					entry.count = finalcount;
+					entry.last_used = frameCount;
+					s_converted_vertices_size += size;
+				}
+			}
+			else if (s_first_sightings.size() < MAX_FIRST_SIGHTINGS)
+			{
+				s_first_sightings.insert(key);
+			}
+		}
+	}
+	else
+	{
+		finalcount = loader->RunVertices(parameters);
+	}
 	writesize = loader->m_native_stride * finalcount;
 	IndexGenerator::AddIndices(parameters.primitive, finalcount);
 	ADDSTAT(stats.thisFrame.numPrims, finalcount);
@@ -33,28 +33,70 @@ static OpArg MPIC(const void* ptr)
 	return MDisp(base_reg, PtrOffset(ptr, memory_base_ptr));
 }
 
-static __m128 scale_factors[13] = {
-	_mm_set_ps1(0.0f),
-	_mm_set_ps1(fractionTable[7]),
-	_mm_set_ps1(fractionTable[6]),
-	_mm_set_ps1(fractionTable[15]),
-	_mm_set_ps1(fractionTable[14]),
-	_mm_set_ps1(0.0f),
-	_mm_set_ps1(0.0f),
-	_mm_set_ps1(0.0f),
-	_mm_set_ps1(0.0f),
-	_mm_set_ps1(0.0f),
-	_mm_set_ps1(0.0f),
-	_mm_set_ps1(0.0f),
-	_mm_set_ps1(0.0f)
+// Wide enough for the paired loop, the single vertex loop only uses the lower half
+struct alignas(32) ScaleFactor
+{
+	float f[8];
+};
+
+static ScaleFactor MakeScaleFactor(float f)
+{
+	return { { f, f, f, f, f, f, f, f } };
+}
+
+static ScaleFactor scale_factors[13] = {
+	MakeScaleFactor(0.0f),
+	MakeScaleFactor(fractionTable[7]),
+	MakeScaleFactor(fractionTable[6]),
+	MakeScaleFactor(fractionTable[15]),
+	MakeScaleFactor(fractionTable[14]),
+	MakeScaleFactor(0.0f),
+	MakeScaleFactor(0.0f),
+	MakeScaleFactor(0.0f),
+	MakeScaleFactor(0.0f),
+	MakeScaleFactor(0.0f),
+	MakeScaleFactor(0.0f),
+	MakeScaleFactor(0.0f),
+	MakeScaleFactor(0.0f)
+};
+
+// Each mask is repeated in both 128-bit lanes for the paired loop
+struct alignas(32) ShuffleMask
+{
+	__m128i lanes[2];
+};
+
+#define SHUFFLE_MASK(a, b, c, d) { { _mm_set_epi32(a, b, c, d), _mm_set_epi32(a, b, c, d) } }
+
+static const ShuffleMask shuffle_lut[5][3] = {
+	{ SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF00L),  // 1x u8
+	SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF01L, 0xFFFFFF00L),  // 2x u8
+	SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFF02L, 0xFFFFFF01L, 0xFFFFFF00L) }, // 3x u8
+	{ SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00FFFFFFL),  // 1x s8
+	SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL),  // 2x s8
+	SHUFFLE_MASK(0xFFFFFFFFL, 0x02FFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL) }, // 3x s8
+	{ SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0001L),  // 1x u16
+	SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0203L, 0xFFFF0001L),  // 2x u16
+	SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFF0405L, 0xFFFF0203L, 0xFFFF0001L) }, // 3x u16
+	{ SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x0001FFFFL),  // 1x s16
+	SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0x0203FFFFL, 0x0001FFFFL),  // 2x s16
+	SHUFFLE_MASK(0xFFFFFFFFL, 0x0405FFFFL, 0x0203FFFFL, 0x0001FFFFL) }, // 3x s16
+	{ SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00010203L),  // 1x float
+	SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0x04050607L, 0x00010203L),  // 2x float
+	SHUFFLE_MASK(0xFFFFFFFFL, 0x08090A0BL, 0x04050607L, 0x00010203L) }, // 3x float
 };
 
+#undef SHUFFLE_MASK
+
 VertexLoaderX64::VertexLoaderX64(const TVtxDesc& vtx_desc, const VAT& vtx_att) : VertexLoaderBase(vtx_desc, vtx_att)
 {
 	if (!IsInitialized())
 		return;
 
-	AllocCodeSpace(1024, false);
+	// Loaders with AVX2 also convert two vertices per iteration, see GeneratePairedLoop
+	m_paired_loop = cpu_info.bAVX2;
+
+	AllocCodeSpace(m_paired_loop ? 4096 : 1024, false);
 	ClearCodeSpace();
 	GenerateVertexLoader();
 	WriteProtect();
@@ -69,6 +111,7 @@ OpArg VertexLoaderX64::GetVertexAddr(int array, u64 attribute)
 	if (attribute & MASKINDEXED)
 	{
 		int bits = attribute == INDEX8 ? 8 : 16;
+		m_source = { true, array, bits, m_src_ofs, 0 };
 		LoadAndSwap(bits, scratch1, data);
 		m_src_ofs += bits / 8;
 		if (array == ARRAY_POSITION)
@@ -83,30 +126,27 @@ OpArg VertexLoaderX64::GetVertexAddr(int array, u64 attribute)
 	}
 	else
 	{
+		m_source = { false, array, 0, m_src_ofs, 0 };
 		return data;
 	}
 }
 
-int VertexLoaderX64::ReadVertex(OpArg data, u64 attribute, int format, int count_in, int count_out, bool dequantize, AttributeFormat* native_format, X64Reg scaling_register)
+OpArg VertexLoaderX64::GetPairedVertexAddr(const AttributeSource& source, int vertex)
 {
-	static const __m128i shuffle_lut[5][3] = {
-		{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF00L),  // 1x u8
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF01L, 0xFFFFFF00L),  // 2x u8
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFF02L, 0xFFFFFF01L, 0xFFFFFF00L) }, // 3x u8
-		{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00FFFFFFL),  // 1x s8
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL),  // 2x s8
-		_mm_set_epi32(0xFFFFFFFFL, 0x02FFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL) }, // 3x s8
-		{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0001L),  // 1x u16
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0203L, 0xFFFF0001L),  // 2x u16
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFF0405L, 0xFFFF0203L, 0xFFFF0001L) }, // 3x u16
-		{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x0001FFFFL),  // 1x s16
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x0203FFFFL, 0x0001FFFFL),  // 2x s16
-		_mm_set_epi32(0xFFFFFFFFL, 0x0405FFFFL, 0x0203FFFFL, 0x0001FFFFL) }, // 3x s16
-		{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00010203L),  // 1x float
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x04050607L, 0x00010203L),  // 2x float
-		_mm_set_epi32(0xFFFFFFFFL, 0x08090A0BL, 0x04050607L, 0x00010203L) }, // 3x float
-	};
+	u32 vertex_ofs = vertex * m_VertexSize;
+	if (!source.indexed)
+		return MDisp(src_reg, vertex_ofs + source.src_ofs + source.offset);
+
+	LoadAndSwap(source.index_bits, scratch1, MDisp(src_reg, vertex_ofs + source.src_ofs));
+	IMUL(32, scratch1, MPIC(&g_main_cp_state.array_strides[source.array]));
+	MOV(64, R(scratch2), MPIC(&cached_arraybases[source.array]));
+	OpArg data = MRegSum(scratch1, scratch2);
+	data.AddMemOffset(source.offset);
+	return data;
+}
 
+int VertexLoaderX64::ReadVertex(OpArg data, u64 attribute, int format, int count_in, int count_out, bool dequantize, AttributeFormat* native_format, X64Reg scaling_register)
+{
 	X64Reg coords = XMM0;
 	int elem_size = 1 << (format / 2);
 	int load_bytes = elem_size * count_in;
@@ -131,7 +171,7 @@ int VertexLoaderX64::ReadVertex(OpArg data, u64 attribute, int format, int count
 		else
 			MOVD_xmm(coords, data);
 
-		PSHUFB(coords, MPIC(&shuffle_lut[format][count_in - 1]));
+		PSHUFB(coords, MPIC(&shuffle_lut[format][count_in - 1].lanes[0]));
 
 		// Sign-extend.
 		if (format == FORMAT_BYTE)
@@ -245,7 +285,7 @@ int VertexLoaderX64::ReadVertex(OpArg data, u64 attribute, int format, int count
 	return load_bytes;
 }
 
-void VertexLoaderX64::ReadColor(OpArg data, u64 attribute, int format)
+int VertexLoaderX64::ReadColor(OpArg data, OpArg dest, int format)
 {
 	int load_bytes = 0;
 	switch (format)
@@ -256,7 +296,7 @@ void VertexLoaderX64::ReadColor(OpArg data, u64 attribute, int format)
 		MOV(32, R(scratch1), data);
 		if (format != FORMAT_32B_8888)
 			OR(32, R(scratch1), Imm32(0xFF000000));
-		MOV(32, MDisp(dst_reg, m_dst_ofs), R(scratch1));
+		MOV(32, dest, R(scratch1));
 		load_bytes = 3 + (format != FORMAT_24B_888);
 		break;
 
@@ -297,7 +337,7 @@ void VertexLoaderX64::ReadColor(OpArg data, u64 attribute, int format)
 		}
 
 		OR(32, R(scratch1), Imm32(0x000000FF));
-		SwapAndStore(32, MDisp(dst_reg, m_dst_ofs), scratch1);
+		SwapAndStore(32, dest, scratch1);
 		load_bytes = 2;
 		break;
 
@@ -325,7 +365,7 @@ void VertexLoaderX64::ReadColor(OpArg data, u64 attribute, int format)
 		MOV(32, R(scratch2), R(scratch1));
 		SHL(32, R(scratch1), Imm8(4));
 		OR(32, R(scratch1), R(scratch2));
-		SwapAndStore(32, MDisp(dst_reg, m_dst_ofs), scratch1);
+		SwapAndStore(32, dest, scratch1);
 		load_bytes = 2;
 		break;
 
@@ -359,12 +399,103 @@ void VertexLoaderX64::ReadColor(OpArg data, u64 attribute, int format)
 		AND(32, R(scratch1), Imm32(0x03030303));
 		OR(32, R(scratch1), R(scratch2));
 
-		SwapAndStore(32, MDisp(dst_reg, m_dst_ofs), scratch1);
+		SwapAndStore(32, dest, scratch1);
 		load_bytes = 3;
 		break;
 	}
-	if (attribute == DIRECT)
-		m_src_ofs += load_bytes;
+	return load_bytes;
+}
+
+void VertexLoaderX64::ReadVertexPair(const AttributeLoad& load)
+{
+	// Same as the SSSE3 path of ReadVertex, with vertex 0 in the lower lane and vertex 1 in
+	// the upper one. Only VEX encoded instructions here, see GeneratePairedLoop.
+	X64Reg coords = YMM0;
+	X64Reg upper = XMM1;
+	int elem_size = 1 << (load.format / 2);
+	int load_bytes = elem_size * load.count_in;
+
+	OpArg data = GetPairedVertexAddr(load.source, 0);
+	if (load_bytes > 8)
+		VMOVDQU(coords, data);
+	else if (load_bytes > 4)
+		VMOVQ_xmm(coords, data);
+	else
+		VMOVD_xmm(coords, data);
+
+	data = GetPairedVertexAddr(load.source, 1);
+	if (load_bytes > 8)
+	{
+		VINSERTI128(coords, coords, data, 1);
+	}
+	else
+	{
+		if (load_bytes > 4)
+			VMOVQ_xmm(upper, data);
+		else
+			VMOVD_xmm(upper, data);
+		VINSERTI128(coords, coords, R(upper), 1);
+	}
+
+	VPSHUFB_ymm(coords, coords, MPIC(&shuffle_lut[load.format][load.count_in - 1]));
+
+	// Sign-extend.
+	if (load.format == FORMAT_BYTE)
+		VPSRAD_ymm(coords, coords, 24);
+	if (load.format == FORMAT_SHORT)
+		VPSRAD_ymm(coords, coords, 16);
+
+	if (load.format != FORMAT_FLOAT)
+	{
+		VCVTDQ2PS_ymm(coords, R(coords));
+
+		if (load.dequantize)
+			VMULPS_ymm(coords, coords, MPIC(&scale_factors[load.scale_index]));
+	}
+
+	VEXTRACTI128(R(upper), coords, 1);
+	for (int vertex = 0; vertex < 2; vertex++)
+	{
+		OpArg dest = MDisp(dst_reg, load.dst_ofs + vertex * m_native_stride);
+		X64Reg value = vertex ? upper : coords;
+		switch (load.count_out)
+		{
+		case 1: VMOVSS(dest, value); break;
+		case 2: VMOVLPS(dest, value); break;
+		case 3: VMOVUPS(dest, value); break;
+		}
+	}
+}
+
+void VertexLoaderX64::WriteTexMatrixIndex(OpArg src, OpArg dest, bool has_texcoord)
+{
+	MOVZX(64, 8, scratch1, src);
+	if (has_texcoord)
+	{
+		CVTSI2SS(XMM0, R(scratch1));
+		MOVSS(dest, XMM0);
+	}
+	else
+	{
+		PXOR(XMM0, R(XMM0));
+		CVTSI2SS(XMM0, R(scratch1));
+		SHUFPS(XMM0, R(XMM0), 0x45); // 000X -> 0X00
+		MOVUPS(dest, XMM0);
+	}
+}
+
+void VertexLoaderX64::WritePositionMatrixIndex(u32 src_ofs, u32 dst_ofs)
+{
+	if (m_VtxDesc.PosMatIdx)
+	{
+		MOVZX(32, 8, scratch1, MDisp(src_reg, src_ofs));
+	}
+	else
+	{
+		MOV(32, R(scratch1), MPIC(&g_main_cp_state.matrix_index_a));
+	}
+	AND(32, R(scratch1), Imm8(0x3F));
+	MOV(32, MDisp(dst_reg, dst_ofs), R(scratch1));
 }
 
 void VertexLoaderX64::GenerateVertexLoader()
@@ -413,6 +544,10 @@ void VertexLoaderX64::GenerateVertexLoader()
 	if (m_VtxDesc.Position & MASKINDEXED)
 		XOR(32, R(skipped_reg), R(skipped_reg));
 
+	FixupBranch to_paired_loop;
+	if (m_paired_loop)
+		to_paired_loop = J(true);
+
 	const u8* loop_start = GetCodePtr();
 
 	if (m_VtxDesc.PosMatIdx)
@@ -432,6 +567,8 @@ void VertexLoaderX64::GenerateVertexLoader()
 	}
 
 	OpArg data = GetVertexAddr(ARRAY_POSITION, m_VtxDesc.Position);
+	m_loads.push_back({ AttributeLoad::VERTEX, m_source, (int)m_VtxAttr.PosFormat,
+		(int)m_VtxAttr.PosElements + 2, 3, m_VtxAttr.ByteDequant != 0, 0, m_dst_ofs });
 	ReadVertex(data, m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements + 2, 3,
 		m_VtxAttr.ByteDequant, &m_native_vtx_decl.position, XMM2);
 
@@ -444,9 +581,14 @@ void VertexLoaderX64::GenerateVertexLoader()
 				data = GetVertexAddr(ARRAY_NORMAL, m_VtxDesc.Normal);
 				int elem_size = 1 << (m_VtxAttr.NormalFormat / 2);
 				data.AddMemOffset(i * elem_size * 3);
+				m_source.offset += i * elem_size * 3;
 			}
-			data.AddMemOffset(ReadVertex(data, m_VtxDesc.Normal, m_VtxAttr.NormalFormat, 3, 3,
-				true, &m_native_vtx_decl.normals[i], XMM3));
+			m_loads.push_back({ AttributeLoad::VERTEX, m_source, (int)m_VtxAttr.NormalFormat, 3, 3, true,
+				(int)m_VtxAttr.NormalFormat + 1, m_dst_ofs });
+			int load_bytes = ReadVertex(data, m_VtxDesc.Normal, m_VtxAttr.NormalFormat, 3, 3,
+				true, &m_native_vtx_decl.normals[i], XMM3);
+			data.AddMemOffset(load_bytes);
+			m_source.offset += load_bytes;
 		}
 
 		m_native_components |= VB_HAS_NRM0;
@@ -460,7 +602,11 @@ void VertexLoaderX64::GenerateVertexLoader()
 		if (col[i])
 		{
 			data = GetVertexAddr(ARRAY_COLOR + i, col[i]);
-			ReadColor(data, col[i], m_VtxAttr.color[i].Comp);
+			m_loads.push_back({ AttributeLoad::COLOR, m_source, (int)m_VtxAttr.color[i].Comp, 0, 0, false,
+				0, m_dst_ofs });
+			int load_bytes = ReadColor(data, MDisp(dst_reg, m_dst_ofs), m_VtxAttr.color[i].Comp);
+			if (col[i] == DIRECT)
+				m_src_ofs += load_bytes;
 			m_native_components |= VB_HAS_COL0 << i;
 			m_native_vtx_decl.colors[i].components = 4;
 			m_native_vtx_decl.colors[i].enable = true;
@@ -476,6 +622,8 @@ void VertexLoaderX64::GenerateVertexLoader()
 		if (tc[i])
 		{
 			data = GetVertexAddr(ARRAY_TEXCOORD0 + i, tc[i]);
+			m_loads.push_back({ AttributeLoad::VERTEX, m_source, (int)m_VtxAttr.texCoord[i].Format,
+				elements, tm[i] ? 2 : elements, m_VtxAttr.ByteDequant != 0, 5 + i, m_dst_ofs });
 			ReadVertex(data, tc[i], m_VtxAttr.texCoord[i].Format, elements, tm[i] ? 2 : elements,
 				m_VtxAttr.ByteDequant, &m_native_vtx_decl.texcoords[i], treg[i]);
 			m_native_components |= VB_HAS_UV0 << i;
@@ -486,34 +634,24 @@ void VertexLoaderX64::GenerateVertexLoader()
 			m_native_vtx_decl.texcoords[i].components = 3;
 			m_native_vtx_decl.texcoords[i].enable = true;
 			m_native_vtx_decl.texcoords[i].type = FORMAT_FLOAT;
-			MOVZX(64, 8, scratch1, MDisp(src_reg, texmatidx_ofs[i]));
+			AttributeLoad load = { AttributeLoad::TEX_MATRIX_INDEX };
+			load.dst_ofs = m_dst_ofs;
+			load.texmatidx_ofs = texmatidx_ofs[i];
+			load.has_texcoord = tc[i] != 0;
+			m_loads.push_back(load);
+			WriteTexMatrixIndex(MDisp(src_reg, texmatidx_ofs[i]), MDisp(dst_reg, m_dst_ofs), tc[i] != 0);
 			if (tc[i])
 			{
-				CVTSI2SS(XMM0, R(scratch1));
-				MOVSS(MDisp(dst_reg, m_dst_ofs), XMM0);
 				m_dst_ofs += sizeof(float);
 			}
 			else
 			{
 				m_native_vtx_decl.texcoords[i].offset = m_dst_ofs;
-				PXOR(XMM0, R(XMM0));
-				CVTSI2SS(XMM0, R(scratch1));
-				SHUFPS(XMM0, R(XMM0), 0x45); // 000X -> 0X00
-				MOVUPS(MDisp(dst_reg, m_dst_ofs), XMM0);
 				m_dst_ofs += sizeof(float) * 3;
 			}
 		}
 	}
-	if (m_VtxDesc.PosMatIdx)
-	{
-		MOVZX(32, 8, scratch1, MDisp(src_reg, 0));
-	}
-	else
-	{
-		MOV(32, R(scratch1), MPIC(&g_main_cp_state.matrix_index_a));
-	}
-	AND(32, R(scratch1), Imm8(0x3F));
-	MOV(32, MDisp(dst_reg, m_dst_ofs), R(scratch1));
+	WritePositionMatrixIndex(0, m_dst_ofs);
 	m_native_vtx_decl.posmtx.components = 4;
 	m_native_vtx_decl.posmtx.enable = true;
 	m_native_vtx_decl.posmtx.offset = m_dst_ofs;
@@ -527,8 +665,13 @@ void VertexLoaderX64::GenerateVertexLoader()
 	ADD(64, R(src_reg), Imm32(m_src_ofs));
 
 	SUB(32, R(count_reg), Imm8(1));
-	J_CC(CC_NZ, loop_start);
+	FixupBranch next_vertex;
+	if (m_paired_loop)
+		next_vertex = J_CC(CC_NZ, true);
+	else
+		J_CC(CC_NZ, loop_start);
 
+	const u8* done = GetCodePtr();
 	// Get the original count.
 	POP(32, R(ABI_RETURN));
 
@@ -550,6 +693,86 @@ void VertexLoaderX64::GenerateVertexLoader()
 	m_native_stride = m_dst_ofs;
 	m_VertexSize = m_src_ofs;
 	m_native_vtx_decl.stride = m_native_stride;
+
+	if (m_paired_loop)
+	{
+		SetJumpTarget(to_paired_loop);
+		SetJumpTarget(next_vertex);
+		GeneratePairedLoop(loop_start, done);
+	}
+}
+
+// Converts two vertices per iteration, each attribute of both vertices goes through one half
+// of a 256-bit register. The loop falls back to the single vertex one above for the last vertex
+// and for pairs with a skipped vertex, it jumps here again once that vertex is done.
+// Legacy SSE instructions are slow while the upper halves of the registers are in use, so
+// VZEROUPPER is issued before any of them runs.
+void VertexLoaderX64::GeneratePairedLoop(const u8* single_loop, const u8* done)
+{
+	const u8* loop_start = GetCodePtr();
+	CMP(32, R(count_reg), Imm8(2));
+	FixupBranch single = J_CC(CC_B, true);
+
+	FixupBranch skipped[2];
+	if (m_VtxDesc.Position & MASKINDEXED)
+	{
+		const AttributeSource& position = m_loads[0].source;
+		for (int vertex = 0; vertex < 2; vertex++)
+		{
+			LoadAndSwap(position.index_bits, scratch1, MDisp(src_reg, vertex * m_VertexSize + position.src_ofs));
+			CMP(position.index_bits, R(scratch1), Imm8(-1));
+			skipped[vertex] = J_CC(CC_E, true);
+		}
+	}
+
+	bool upper_dirty = false;
+	for (const AttributeLoad& load : m_loads)
+	{
+		switch (load.type)
+		{
+		case AttributeLoad::VERTEX:
+			ReadVertexPair(load);
+			upper_dirty = true;
+			break;
+
+		case AttributeLoad::COLOR:
+			for (int vertex = 0; vertex < 2; vertex++)
+			{
+				OpArg data = GetPairedVertexAddr(load.source, vertex);
+				ReadColor(data, MDisp(dst_reg, load.dst_ofs + vertex * m_native_stride), load.format);
+			}
+			break;
+
+		case AttributeLoad::TEX_MATRIX_INDEX:
+			if (upper_dirty)
+				VZEROUPPER();
+			upper_dirty = false;
+			for (int vertex = 0; vertex < 2; vertex++)
+			{
+				WriteTexMatrixIndex(MDisp(src_reg, load.texmatidx_ofs + vertex * m_VertexSize),
+					MDisp(dst_reg, load.dst_ofs + vertex * m_native_stride), load.has_texcoord);
+			}
+			break;
+		}
+	}
+	for (int vertex = 0; vertex < 2; vertex++)
+		WritePositionMatrixIndex(vertex * m_VertexSize, m_native_vtx_decl.posmtx.offset + vertex * m_native_stride);
+
+	ADD(64, R(dst_reg), Imm32(2 * m_native_stride));
+	ADD(64, R(src_reg), Imm32(2 * m_VertexSize));
+	SUB(32, R(count_reg), Imm8(2));
+	J_CC(CC_NZ, loop_start);
+	VZEROUPPER();
+	JMP(done, true);
+
+	SetJumpTarget(single);
+	if (m_VtxDesc.Position & MASKINDEXED)
+	{
+		SetJumpTarget(skipped[0]);
+		SetJumpTarget(skipped[1]);
+	}
+	VZEROUPPER();
+	JMP(single_loop, true);
 }
 
 bool VertexLoaderX64::EnvironmentIsSupported()
@@ -560,17 +783,17 @@ bool VertexLoaderX64::EnvironmentIsSupported()
 int VertexLoaderX64::RunVertices(const VertexLoaderParameters &parameters)
 {
 	const VAT &vat = *parameters.VtxAttr;
-	scale_factors[0] = _mm_set_ps1(fractionTable[vat.g0.PosFrac]);
+	scale_factors[0] = MakeScaleFactor(fractionTable[vat.g0.PosFrac]);
 	if (m_native_components & VB_HAS_UVALL)
 	{
-		scale_factors[5] = _mm_set_ps1(fractionTable[vat.g0.Tex0Frac]);
-		scale_factors[6] = _mm_set_ps1(fractionTable[vat.g1.Tex1Frac]);
-		scale_factors[7] = _mm_set_ps1(fractionTable[vat.g1.Tex2Frac]);
-		scale_factors[8] = _mm_set_ps1(fractionTable[vat.g1.Tex3Frac]);
-		scale_factors[9] = _mm_set_ps1(fractionTable[vat.g2.Tex4Frac]);
-		scale_factors[10] = _mm_set_ps1(fractionTable[vat.g2.Tex5Frac]);
-		scale_factors[11] = _mm_set_ps1(fractionTable[vat.g2.Tex6Frac]);
-		scale_factors[12] = _mm_set_ps1(fractionTable[vat.g2.Tex7Frac]);
+		scale_factors[5] = MakeScaleFactor(fractionTable[vat.g0.Tex0Frac]);
+		scale_factors[6] = MakeScaleFactor(fractionTable[vat.g1.Tex1Frac]);
+		scale_factors[7] = MakeScaleFactor(fractionTable[vat.g1.Tex2Frac]);
+		scale_factors[8] = MakeScaleFactor(fractionTable[vat.g1.Tex3Frac]);
+		scale_factors[9] = MakeScaleFactor(fractionTable[vat.g2.Tex4Frac]);
+		scale_factors[10] = MakeScaleFactor(fractionTable[vat.g2.Tex5Frac]);
+		scale_factors[11] = MakeScaleFactor(fractionTable[vat.g2.Tex6Frac]);
+		scale_factors[12] = MakeScaleFactor(fractionTable[vat.g2.Tex7Frac]);
 	}
 	m_numLoadedVertices += parameters.count;
 	return ((int(*)(const u8* src, u8* dst, int count, const void*))region)(parameters.source, parameters.destination, parameters.count, memory_base_ptr);
@@ -1,3 +1,5 @@
+#include <vector>
+
 #include "Common/x64Emitter.h"
 #include "VideoCommon/VertexLoaderBase.h"
 
@@ -14,11 +16,53 @@ protected:
 	int RunVertices(const VertexLoaderParameters &parameters) override;
 	bool EnvironmentIsSupported() override;
 private:
+	// Where vertex 0 reads an attribute from, vertex n reads it n * m_VertexSize bytes further
+	// (or through the index found there).
+	struct AttributeSource
+	{
+		bool indexed;
+		int array;
+		int index_bits;
+		// offset of the index, or of the data for direct attributes
+		u32 src_ofs;
+		// added to the address of the data
+		s32 offset;
+	};
+
+	// Everything the single vertex loop loads, in order, so that the paired loop can replay it
+	struct AttributeLoad
+	{
+		enum Type
+		{
+			VERTEX,
+			COLOR,
+			TEX_MATRIX_INDEX
+		};
+		Type type;
+		AttributeSource source;
+		int format;
+		int count_in;
+		int count_out;
+		bool dequantize;
+		int scale_index;
+		u32 dst_ofs;
+		u32 texmatidx_ofs;
+		bool has_texcoord;
+	};
+
 	u32 m_src_ofs = 0;
 	u32 m_dst_ofs = 0;
 	Gen::FixupBranch m_skip_vertex;
+	AttributeSource m_source;
+	std::vector<AttributeLoad> m_loads;
+	bool m_paired_loop = false;
 	Gen::OpArg GetVertexAddr(int array, u64 attribute);
+	Gen::OpArg GetPairedVertexAddr(const AttributeSource& source, int vertex);
 	int ReadVertex(Gen::OpArg data, u64 attribute, int format, int count_in, int count_out, bool dequantize, AttributeFormat* native_format, Gen::X64Reg scaling_register);
-	void ReadColor(Gen::OpArg data, u64 attribute, int format);
+	void ReadVertexPair(const AttributeLoad& load);
+	int ReadColor(Gen::OpArg data, Gen::OpArg dest, int format);
+	void WriteTexMatrixIndex(Gen::OpArg src, Gen::OpArg dest, bool has_texcoord);
+	void WritePositionMatrixIndex(u32 src_ofs, u32 dst_ofs);
 	void GenerateVertexLoader();
+	void GeneratePairedLoop(const u8* single_loop, const u8* done);
 };
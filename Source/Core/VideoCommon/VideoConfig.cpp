@@ -118,6 +118,11 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("DumpFormat", &sDumpFormat, "avi");
 	settings->Get("DumpCodec", &sDumpCodec, "");
 	settings->Get("DumpPath", &sDumpPath, "");
+	settings->Get("DumpEncoderPreset", &sDumpEncoderPreset, "");
+	settings->Get("DumpCodecOptions", &sDumpCodecOptions, "");
+	settings->Get("DumpThreads", &iDumpThreads, 0);
+	settings->Get("DumpAudioInVideo", &bDumpAudioInVideo, false);
+	settings->Get("DumpAudioCodec", &sDumpAudioCodec, "");
 	settings->Get("BitrateKbps", &iBitrateKbps, 2500);
 	settings->Get("InternalResolutionFrameDumps", &bInternalResolutionFrameDumps, 0);
 	settings->Get("EnablePixelLighting", &bEnablePixelLighting, 0);
@@ -204,10 +209,12 @@ void VideoConfig::Load(const std::string& ini_file)
 	hacks->Get("EFBEmulateFormatChanges", &bEFBEmulateFormatChanges, false);
 	hacks->Get("ForceDualSourceBlend", &bForceDualSourceBlend, false);
 	hacks->Get("FullAsyncShaderCompilation", &bFullAsyncShaderCompilation, true);
+	hacks->Get("GLSLAsyncShaderCompilation", &bGLSLAsyncShaderCompilation, false);
 	hacks->Get("WaitForShaderCompilation", &bWaitForShaderCompilation, false);
 	hacks->Get("EnableGPUTextureDecoding", &bEnableGPUTextureDecoding, false);
 	hacks->Get("EnableComputeTextureEncoding", &bEnableComputeTextureEncoding, false);
 	hacks->Get("PredictiveFifo", &bPredictiveFifo, false);
+	hacks->Get("CacheConvertedVertices", &bCacheConvertedVertices, false);
 	hacks->Get("BoundingBoxMode", &iBBoxMode, (int)BBoxMode::BBoxNone);
 	hacks->Get("LastStoryEFBToRam", &bLastStoryEFBToRam, false);
 	hacks->Get("ForceLogicOpBlend", &bForceLogicOpBlend, false);
@@ -366,6 +373,7 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video", "EnableGPUTextureDecoding", bEnableGPUTextureDecoding);
 	CHECK_SETTING("Video", "EnableComputeTextureEncoding", bEnableComputeTextureEncoding);
 	CHECK_SETTING("Video", "PredictiveFifo", bPredictiveFifo);
+	CHECK_SETTING("Video_Hacks", "CacheConvertedVertices", bCacheConvertedVertices);
 	if (gfx_override_exists)
 		OSD::AddMessage("Warning: Opening the graphics configuration will reset settings and might cause issues!", 10000);
 }
@@ -478,6 +486,11 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("DumpFormat", sDumpFormat);
 	settings->Set("DumpCodec", sDumpCodec);
 	settings->Set("DumpPath", sDumpPath);
+	settings->Set("DumpEncoderPreset", sDumpEncoderPreset);
+	settings->Set("DumpCodecOptions", sDumpCodecOptions);
+	settings->Set("DumpThreads", iDumpThreads);
+	settings->Set("DumpAudioInVideo", bDumpAudioInVideo);
+	settings->Set("DumpAudioCodec", sDumpAudioCodec);
 	settings->Set("BitrateKbps", iBitrateKbps);
 	settings->Set("EnablePixelLighting", bEnablePixelLighting);
 	settings->Set("ForcedLighting", bForcedLighting);
@@ -553,10 +566,12 @@ void VideoConfig::Save(const std::string& ini_file)
 	hacks->Set("EFBEmulateFormatChanges", bEFBEmulateFormatChanges);
 	hacks->Set("ForceDualSourceBlend", bForceDualSourceBlend);
 	hacks->Set("FullAsyncShaderCompilation", bFullAsyncShaderCompilation);
+	hacks->Set("GLSLAsyncShaderCompilation", bGLSLAsyncShaderCompilation);
 	hacks->Set("WaitForShaderCompilation", bWaitForShaderCompilation);
 	hacks->Set("EnableGPUTextureDecoding", bEnableGPUTextureDecoding);
 	hacks->Set("EnableComputeTextureEncoding", bEnableComputeTextureEncoding);
 	hacks->Set("PredictiveFifo", bPredictiveFifo);
+	hacks->Set("CacheConvertedVertices", bCacheConvertedVertices);
 	hacks->Set("BoundingBoxMode", iBBoxMode);
 	hacks->Set("LastStoryEFBToRam", bLastStoryEFBToRam);
 	hacks->Set("ForceLogicOpBlend", bForceLogicOpBlend);
@@ -157,6 +157,11 @@ struct VideoConfig final
 	std::string sDumpCodec;
 	std::string sDumpFormat;
 	std::string sDumpPath;
+	std::string sDumpEncoderPreset;
+	std::string sDumpCodecOptions;
+	int iDumpThreads;
+	bool bDumpAudioInVideo;
+	std::string sDumpAudioCodec;
 	bool bInternalResolutionFrameDumps;
 	bool bFreeLook;
 	bool bBorderlessFullscreen;
@@ -170,7 +175,9 @@ struct VideoConfig final
 	bool bForceProgressive;
 	bool bPerfQueriesEnable;
 	bool bFullAsyncShaderCompilation;
+	bool bGLSLAsyncShaderCompilation;
 	bool bPredictiveFifo;
+	bool bCacheConvertedVertices;
 	bool bWaitForShaderCompilation;
 	bool bEnableGPUTextureDecoding;
 	bool bEnableComputeTextureEncoding;
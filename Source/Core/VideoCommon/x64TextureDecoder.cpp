@@ -1057,6 +1057,329 @@ static PC_TexFormat TexDecoder_Decode_real(u8 *dst, const u8 *src, u32 width, u3
 
 
 
+// AVX2 tier of TexDecoder_Decode_RGBA, only used when cpu_info.bAVX2 is set.
+// The helpers work on 8 texels at once, one per 32-bit lane. 16-bit texels and TLUT entries
+// are kept in memory order in the low half of their lane.
+
+FUNCTION_TARGET_AVX2
+static inline __m256i Swap16Lanes_AVX2(__m256i raw)
+{
+	// Also clears the upper half of each lane
+	const __m256i mask = _mm256_setr_epi8(
+		1, 0, -1, -1, 5, 4, -1, -1, 9, 8, -1, -1, 13, 12, -1, -1,
+		1, 0, -1, -1, 5, 4, -1, -1, 9, 8, -1, -1, 13, 12, -1, -1);
+	return _mm256_shuffle_epi8(raw, mask);
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i Convert3To8_AVX2(__m256i v)
+{
+	return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(v, 5), _mm256_slli_epi32(v, 2)), _mm256_srli_epi32(v, 1));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i Convert4To8_AVX2(__m256i v)
+{
+	return _mm256_or_si256(_mm256_slli_epi32(v, 4), v);
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i Convert5To8_AVX2(__m256i v)
+{
+	return _mm256_or_si256(_mm256_slli_epi32(v, 3), _mm256_srli_epi32(v, 2));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i Convert6To8_AVX2(__m256i v)
+{
+	return _mm256_or_si256(_mm256_slli_epi32(v, 2), _mm256_srli_epi32(v, 4));
+}
+
+// Packs 8-bit components into RGBA texels
+FUNCTION_TARGET_AVX2
+static inline __m256i MakeRGBA_AVX2(__m256i r, __m256i g, __m256i b, __m256i a)
+{
+	return _mm256_or_si256(
+		_mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+		_mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_slli_epi32(a, 24)));
+}
+
+// Same as decodeIA8Swapped
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeIA8_AVX2(__m256i raw)
+{
+	// (..IA) -> (AIII)
+	const __m256i mask = _mm256_setr_epi8(
+		1, 1, 1, 0, 5, 5, 5, 4, 9, 9, 9, 8, 13, 13, 13, 12,
+		1, 1, 1, 0, 5, 5, 5, 4, 9, 9, 9, 8, 13, 13, 13, 12);
+	return _mm256_shuffle_epi8(raw, mask);
+}
+
+// Same as decode565RGBA
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeRGB565_AVX2(__m256i raw)
+{
+	const __m256i val = Swap16Lanes_AVX2(raw);
+	const __m256i r = _mm256_srli_epi32(val, 11);
+	const __m256i g = _mm256_and_si256(_mm256_srli_epi32(val, 5), _mm256_set1_epi32(0x3F));
+	const __m256i b = _mm256_and_si256(val, _mm256_set1_epi32(0x1F));
+	return MakeRGBA_AVX2(Convert5To8_AVX2(r), Convert6To8_AVX2(g), Convert5To8_AVX2(b), _mm256_set1_epi32(0xFF));
+}
+
+// Same as decode5A3RGBA, both encodings are decoded and the top bit picks one per texel
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeRGB5A3_AVX2(__m256i raw)
+{
+	const __m256i val = Swap16Lanes_AVX2(raw);
+	const __m256i kMask_x1f = _mm256_set1_epi32(0x1F);
+	const __m256i kMask_x0f = _mm256_set1_epi32(0x0F);
+	const __m256i kMask_x8000 = _mm256_set1_epi32(0x8000);
+
+	const __m256i rgb555 = MakeRGBA_AVX2(
+		Convert5To8_AVX2(_mm256_and_si256(_mm256_srli_epi32(val, 10), kMask_x1f)),
+		Convert5To8_AVX2(_mm256_and_si256(_mm256_srli_epi32(val, 5), kMask_x1f)),
+		Convert5To8_AVX2(_mm256_and_si256(val, kMask_x1f)),
+		_mm256_set1_epi32(0xFF));
+	const __m256i rgb4443 = MakeRGBA_AVX2(
+		Convert4To8_AVX2(_mm256_and_si256(_mm256_srli_epi32(val, 8), kMask_x0f)),
+		Convert4To8_AVX2(_mm256_and_si256(_mm256_srli_epi32(val, 4), kMask_x0f)),
+		Convert4To8_AVX2(_mm256_and_si256(val, kMask_x0f)),
+		Convert3To8_AVX2(_mm256_and_si256(_mm256_srli_epi32(val, 12), _mm256_set1_epi32(0x7))));
+
+	const __m256i is_rgb555 = _mm256_cmpeq_epi32(_mm256_and_si256(val, kMask_x8000), kMask_x8000);
+	return _mm256_blendv_epi8(rgb4443, rgb555, is_rgb555);
+}
+
+template <TlutFormat format>
+FUNCTION_TARGET_AVX2
+static inline __m256i Decode16_AVX2(__m256i raw)
+{
+	switch (format)
+	{
+	case GX_TL_IA8:
+		return DecodeIA8_AVX2(raw);
+	case GX_TL_RGB565:
+		return DecodeRGB565_AVX2(raw);
+	default:
+		return DecodeRGB5A3_AVX2(raw);
+	}
+}
+
+template <TlutFormat tlutfmt>
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeTlut_AVX2(const u16* tlut, __m256i indices)
+{
+	// Each gather reads 32 bits, the entry after the one we want is dropped by the decoders.
+	// TLUTs start in the lower half of TMEM and are at most 32KB, so this stays inside texMem.
+	return Decode16_AVX2<tlutfmt>(_mm256_i32gather_epi32((const int*)tlut, indices, 2));
+}
+
+// Texel n of a C4/I4 row is nibble n of the row, high nibble first
+FUNCTION_TARGET_AVX2
+static inline __m256i Unpack4BitRow_AVX2(const u8* src)
+{
+	const __m256i shifts = _mm256_setr_epi32(4, 0, 12, 8, 20, 16, 28, 24);
+	const __m256i row = _mm256_set1_epi32(*(const s32*)src);
+	return _mm256_and_si256(_mm256_srlv_epi32(row, shifts), _mm256_set1_epi32(0xF));
+}
+
+// Copies the low byte of each lane to the whole lane
+FUNCTION_TARGET_AVX2
+static inline __m256i BroadcastLowByte_AVX2(__m256i v)
+{
+	const __m256i mask = _mm256_setr_epi8(
+		0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12,
+		0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12);
+	return _mm256_shuffle_epi8(v, mask);
+}
+
+// 8 texels per row as in C8/I8/IA4, zero extended to one per lane
+FUNCTION_TARGET_AVX2
+static inline __m256i Unpack8BitRow_AVX2(const u8* src)
+{
+	return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)src));
+}
+
+// Writes lane 0 and 1 to two consecutive rows of 4 texels
+FUNCTION_TARGET_AVX2
+static inline void StoreRowPair_AVX2(u32* dst, u32 width, __m256i texels)
+{
+	_mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(texels));
+	_mm_storeu_si128((__m128i*)(dst + width), _mm256_extracti128_si256(texels, 1));
+}
+
+// The loops below walk the source in order, it is laid out block after block and row after row
+// inside each block.
+
+template <TlutFormat tlutfmt>
+FUNCTION_TARGET_AVX2
+static void DecodeC4_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height, const u16* tlut)
+{
+	for (u32 y = 0; y < height; y += 8)
+		for (u32 x = 0; x < width; x += 8)
+			for (u32 iy = 0; iy < 8; iy++, src += 4)
+				_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+					DecodeTlut_AVX2<tlutfmt>(tlut, Unpack4BitRow_AVX2(src)));
+}
+
+template <TlutFormat tlutfmt>
+FUNCTION_TARGET_AVX2
+static void DecodeC8_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height, const u16* tlut)
+{
+	for (u32 y = 0; y < height; y += 4)
+		for (u32 x = 0; x < width; x += 8)
+			for (u32 iy = 0; iy < 4; iy++, src += 8)
+				_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+					DecodeTlut_AVX2<tlutfmt>(tlut, Unpack8BitRow_AVX2(src)));
+}
+
+template <TlutFormat tlutfmt>
+FUNCTION_TARGET_AVX2
+static void DecodeC14X2_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height, const u16* tlut)
+{
+	const __m256i kMask_x3fff = _mm256_set1_epi32(0x3FFF);
+	for (u32 y = 0; y < height; y += 4)
+		for (u32 x = 0; x < width; x += 4)
+			for (u32 iy = 0; iy < 4; iy += 2, src += 16)
+			{
+				const __m256i raw = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)src));
+				const __m256i indices = _mm256_and_si256(Swap16Lanes_AVX2(raw), kMask_x3fff);
+				StoreRowPair_AVX2(dst + (y + iy) * width + x, width, DecodeTlut_AVX2<tlutfmt>(tlut, indices));
+			}
+}
+
+// IA8, RGB565 and RGB5A3 textures, which are encoded like the TLUT entries of the same name
+template <TlutFormat format>
+FUNCTION_TARGET_AVX2
+static void Decode16_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height)
+{
+	for (u32 y = 0; y < height; y += 4)
+		for (u32 x = 0; x < width; x += 4)
+			for (u32 iy = 0; iy < 4; iy += 2, src += 16)
+			{
+				const __m256i raw = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)src));
+				StoreRowPair_AVX2(dst + (y + iy) * width + x, width, Decode16_AVX2<format>(raw));
+			}
+}
+
+FUNCTION_TARGET_AVX2
+static void DecodeI4_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height)
+{
+	for (u32 y = 0; y < height; y += 8)
+		for (u32 x = 0; x < width; x += 8)
+			for (u32 iy = 0; iy < 8; iy++, src += 4)
+				_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+					BroadcastLowByte_AVX2(Convert4To8_AVX2(Unpack4BitRow_AVX2(src))));
+}
+
+FUNCTION_TARGET_AVX2
+static void DecodeI8_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height)
+{
+	for (u32 y = 0; y < height; y += 4)
+		for (u32 x = 0; x < width; x += 8)
+			for (u32 iy = 0; iy < 4; iy++, src += 8)
+				_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+					BroadcastLowByte_AVX2(Unpack8BitRow_AVX2(src)));
+}
+
+FUNCTION_TARGET_AVX2
+static void DecodeIA4_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height)
+{
+	const __m256i kMask_x00ffffff = _mm256_set1_epi32(0x00FFFFFF);
+	for (u32 y = 0; y < height; y += 4)
+		for (u32 x = 0; x < width; x += 8)
+			for (u32 iy = 0; iy < 4; iy++, src += 8)
+			{
+				const __m256i texels = Unpack8BitRow_AVX2(src);
+				const __m256i a = Convert4To8_AVX2(_mm256_srli_epi32(texels, 4));
+				const __m256i l = Convert4To8_AVX2(_mm256_and_si256(texels, _mm256_set1_epi32(0xF)));
+				const __m256i lll = _mm256_and_si256(BroadcastLowByte_AVX2(l), kMask_x00ffffff);
+				_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+					_mm256_or_si256(lll, _mm256_slli_epi32(a, 24)));
+			}
+}
+
+FUNCTION_TARGET_AVX2
+static void DecodeRGBA8_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height)
+{
+	// Same shuffle as the SSSE3 version, (BRGA) -> (ABGR) in each lane
+	const __m256i mask0312 = _mm256_setr_epi8(
+		2, 1, 3, 0, 6, 5, 7, 4, 10, 9, 11, 8, 14, 13, 15, 12,
+		2, 1, 3, 0, 6, 5, 7, 4, 10, 9, 11, 8, 14, 13, 15, 12);
+	for (u32 y = 0; y < height; y += 4)
+		for (u32 x = 0; x < width; x += 4, src += 64)
+		{
+			// 16 AR pairs followed by 16 GB pairs
+			const __m256i ar = _mm256_loadu_si256((const __m256i*)src);
+			const __m256i gb = _mm256_loadu_si256((const __m256i*)(src + 32));
+			// Rows 0 and 2, then rows 1 and 3
+			const __m256i rgba02 = _mm256_shuffle_epi8(_mm256_unpacklo_epi8(ar, gb), mask0312);
+			const __m256i rgba13 = _mm256_shuffle_epi8(_mm256_unpackhi_epi8(ar, gb), mask0312);
+			u32* row = dst + y * width + x;
+			_mm_storeu_si128((__m128i*)row, _mm256_castsi256_si128(rgba02));
+			_mm_storeu_si128((__m128i*)(row + width), _mm256_castsi256_si128(rgba13));
+			_mm_storeu_si128((__m128i*)(row + width * 2), _mm256_extracti128_si256(rgba02, 1));
+			_mm_storeu_si128((__m128i*)(row + width * 3), _mm256_extracti128_si256(rgba13, 1));
+		}
+}
+
+// Returns false for the formats left to the SSE versions
+static bool TexDecoder_Decode_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height, u32 texformat, u32 tlutaddr, TlutFormat tlutfmt)
+{
+	const u16* tlut = (const u16*)(texMem + tlutaddr);
+	switch (texformat)
+	{
+	case GX_TF_C4:
+		if (tlutfmt == GX_TL_RGB5A3)
+			DecodeC4_RGBA_AVX2<GX_TL_RGB5A3>(dst, src, width, height, tlut);
+		else if (tlutfmt == GX_TL_IA8)
+			DecodeC4_RGBA_AVX2<GX_TL_IA8>(dst, src, width, height, tlut);
+		else
+			DecodeC4_RGBA_AVX2<GX_TL_RGB565>(dst, src, width, height, tlut);
+		return true;
+	case GX_TF_C8:
+		if (tlutfmt == GX_TL_RGB5A3)
+			DecodeC8_RGBA_AVX2<GX_TL_RGB5A3>(dst, src, width, height, tlut);
+		else if (tlutfmt == GX_TL_IA8)
+			DecodeC8_RGBA_AVX2<GX_TL_IA8>(dst, src, width, height, tlut);
+		else
+			DecodeC8_RGBA_AVX2<GX_TL_RGB565>(dst, src, width, height, tlut);
+		return true;
+	case GX_TF_C14X2:
+		if (tlutfmt == GX_TL_RGB5A3)
+			DecodeC14X2_RGBA_AVX2<GX_TL_RGB5A3>(dst, src, width, height, tlut);
+		else if (tlutfmt == GX_TL_IA8)
+			DecodeC14X2_RGBA_AVX2<GX_TL_IA8>(dst, src, width, height, tlut);
+		else
+			DecodeC14X2_RGBA_AVX2<GX_TL_RGB565>(dst, src, width, height, tlut);
+		return true;
+	case GX_TF_I4:
+		DecodeI4_RGBA_AVX2(dst, src, width, height);
+		return true;
+	case GX_TF_I8:
+		DecodeI8_RGBA_AVX2(dst, src, width, height);
+		return true;
+	case GX_TF_IA4:
+		DecodeIA4_RGBA_AVX2(dst, src, width, height);
+		return true;
+	case GX_TF_IA8:
+		Decode16_RGBA_AVX2<GX_TL_IA8>(dst, src, width, height);
+		return true;
+	case GX_TF_RGB565:
+		Decode16_RGBA_AVX2<GX_TL_RGB565>(dst, src, width, height);
+		return true;
+	case GX_TF_RGB5A3:
+		Decode16_RGBA_AVX2<GX_TL_RGB5A3>(dst, src, width, height);
+		return true;
+	case GX_TF_RGBA8:
+		DecodeRGBA8_RGBA_AVX2(dst, src, width, height);
+		return true;
+	default:
+		// CMPR is already SIMD and its per block palette doesn't widen well
+		return false;
+	}
+}
+
 // JSD 01/06/11:
 // TODO: we really should ensure BOTH the source and destination addresses are aligned to 16-byte boundaries to
 // squeeze out a little more performance. _mm_loadu_si128/_mm_storeu_si128 is slower than _mm_load_si128/_mm_store_si128
@@ -1067,6 +1390,9 @@ static PC_TexFormat TexDecoder_Decode_real(u8 *dst, const u8 *src, u32 width, u3
 
 static PC_TexFormat TexDecoder_Decode_RGBA(u32 * dst, const u8 * src, u32 width, u32 height, u32 texformat, u32 tlutaddr, TlutFormat tlutfmt)
 {
+	if (cpu_info.bAVX2 && TexDecoder_Decode_RGBA_AVX2(dst, src, width, height, texformat, tlutaddr, tlutfmt))
+		return PC_TEX_FMT_RGBA32;
+
 	const u32 Wsteps4 = (width + 3) / 4;
 	const u32 Wsteps8 = (width + 7) / 8;
 
@@ -1437,7 +1763,7 @@ static PC_TexFormat TexDecoder_Decode_RGBA(u32 * dst, const u8 * src, u32 width,
 			for (u32 y = 0; y < height; y += 4)
 				for (u32 x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
 					for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
-						decodebytesC14X2_5A3_To_BGRA32(dst + (y + iy) * width + x, (u16*)(src + 8 * xStep), tlutaddr);
+						decodebytesC14X2_5A3_To_RGBA(dst + (y + iy) * width + x, (u16*)(src + 8 * xStep), tlutaddr);
 		}
 		else if (tlutfmt == GX_TL_IA8)
 		{
@@ -0,0 +1,109 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "Common/SPSCQueue.h"
+
+TEST(SPSCQueue, Simple)
+{
+  Common::SPSCQueue<u32, 1024> q;
+
+  EXPECT_EQ(0u, q.Size());
+  EXPECT_TRUE(q.Empty());
+
+  EXPECT_TRUE(q.Push(1));
+  EXPECT_EQ(1u, q.Size());
+  EXPECT_FALSE(q.Empty());
+
+  u32 v;
+  EXPECT_TRUE(q.Pop(v));
+  EXPECT_EQ(1u, v);
+  EXPECT_EQ(0u, q.Size());
+  EXPECT_TRUE(q.Empty());
+  EXPECT_FALSE(q.Pop(v));
+
+  // Test the FIFO order, wrapping around the ring a few times.
+  for (u32 round = 0; round < 3; ++round)
+  {
+    for (u32 i = 0; i < 1000; ++i)
+      EXPECT_TRUE(q.Push(i));
+    EXPECT_EQ(1000u, q.Size());
+    for (u32 i = 0; i < 1000; ++i)
+    {
+      u32 v2;
+      EXPECT_TRUE(q.Pop(v2));
+      EXPECT_EQ(i, v2);
+    }
+    EXPECT_TRUE(q.Empty());
+  }
+
+  for (u32 i = 0; i < 1000; ++i)
+    q.Push(i);
+  EXPECT_FALSE(q.Empty());
+  q.Clear();
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(SPSCQueue, Full)
+{
+  Common::SPSCQueue<u32, 4> q;
+
+  for (u32 i = 0; i < 4; ++i)
+    EXPECT_TRUE(q.Push(i));
+  EXPECT_FALSE(q.Push(4));
+  EXPECT_EQ(4u, q.Size());
+
+  u32 v;
+  EXPECT_TRUE(q.Pop(v));
+  EXPECT_EQ(0u, v);
+  EXPECT_TRUE(q.Push(4));
+  for (u32 i = 1; i < 5; ++i)
+  {
+    EXPECT_TRUE(q.Pop(v));
+    EXPECT_EQ(i, v);
+  }
+}
+
+TEST(SPSCQueue, ReusesElements)
+{
+  Common::SPSCQueue<std::vector<u8>, 2> q;
+
+  q.Push(std::vector<u8>(64, 1));
+  std::vector<u8> v;
+  q.Pop(v);
+  EXPECT_EQ(64u, v.size());
+  EXPECT_EQ(1, v[63]);
+}
+
+TEST(SPSCQueue, MultiThreaded)
+{
+  Common::SPSCQueue<u32, 1024> q;
+
+  auto inserter = [&q]() {
+    for (u32 i = 0; i < 100000; ++i)
+    {
+      while (!q.Push(i))
+        ;
+    }
+  };
+
+  auto popper = [&q]() {
+    for (u32 i = 0; i < 100000; ++i)
+    {
+      u32 v;
+      while (!q.Pop(v))
+        ;
+      EXPECT_EQ(i, v);
+    }
+  };
+
+  std::thread popper_thread(popper);
+  std::thread inserter_thread(inserter);
+
+  popper_thread.join();
+  inserter_thread.join();
+}
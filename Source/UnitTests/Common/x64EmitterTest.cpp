@@ -1079,4 +1079,56 @@ FMA4_TEST(VFNMSUB, S, false)
 FMA4_TEST(VFMADDSUB, P, true)
 FMA4_TEST(VFMSUBADD, P, true)
 
+TEST_INSTR_NO_OPERANDS(VZEROUPPER, "vzeroupper")
+
+TEST_F(x64EmitterTest, VEX_MOV)
+{
+  for (const auto& r : xmmnames)
+  {
+    emitter->VMOVD_xmm(r.reg, MatR(R12));
+    emitter->VMOVQ_xmm(r.reg, MatR(R12));
+    emitter->VMOVDQU(r.reg, MatR(R12));
+    emitter->VMOVSS(MatR(R12), r.reg);
+    emitter->VMOVLPS(MatR(R12), r.reg);
+    emitter->VMOVUPS(MatR(R12), r.reg);
+    ExpectDisassembly("vmovd " + r.name + ", dword ptr ds:[r12] "
+                      "vmovq " + r.name + ", qword ptr ds:[r12] "
+                      "vmovdqu " + r.name + ", dqword ptr ds:[r12] "
+                      "vmovss dword ptr ds:[r12], " + r.name + " "
+                      "vmovlps qword ptr ds:[r12], " + r.name + " "
+                      "vmovups dqword ptr ds:[r12], " + r.name);
+  }
+}
+
+TEST_F(x64EmitterTest, AVX_256)
+{
+  for (const auto& r : ymmnames)
+  {
+    emitter->VCVTDQ2PS_ymm(r.reg, R(YMM1));
+    emitter->VMULPS_ymm(r.reg, YMM1, MatR(R12));
+    emitter->VPSHUFB_ymm(YMM1, r.reg, MatR(R12));
+    emitter->VPSRAD_ymm(r.reg, YMM1, 24);
+    ExpectDisassembly("vcvtdq2ps " + r.name + ", ymm1 "
+                      "vmulps " + r.name + ", ymm1, qqword ptr ds:[r12] "
+                      "vpshufb ymm1, " + r.name + ", qqword ptr ds:[r12] "
+                      "vpsrad " + r.name + ", ymm1, 0x18");
+  }
+}
+
+TEST_F(x64EmitterTest, VINSERTI128_VEXTRACTI128)
+{
+  for (size_t i = 0; i < ymmnames.size(); i++)
+  {
+    emitter->VINSERTI128(ymmnames[i].reg, YMM1, MatR(R12), 1);
+    emitter->VINSERTI128(YMM1, ymmnames[i].reg, R(XMM2), 1);
+    emitter->VEXTRACTI128(MatR(R12), ymmnames[i].reg, 1);
+    emitter->VEXTRACTI128(R(xmmnames[i].reg), YMM1, 1);
+    // Bochs prints the 128-bit operand with the size of the 256-bit one
+    ExpectDisassembly("vinserti128 " + ymmnames[i].name + ", ymm1, qqword ptr ds:[r12], 0x01 "
+                      "vinserti128 ymm1, " + ymmnames[i].name + ", ymm2, 0x01 "
+                      "vextracti128 qqword ptr ds:[r12], " + ymmnames[i].name + ", 0x01 "
+                      "vextracti128 " + ymmnames[i].name + ", ymm1, 0x01");
+  }
+}
+
 }  // namespace Gen
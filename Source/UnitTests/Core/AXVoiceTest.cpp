@@ -0,0 +1,264 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/CoreTiming.h"
+#include "Core/DSPEmulator.h"
+#include "Core/HW/DSP.h"
+
+#define AX_GC
+#include "Core/HW/DSPHLE/UCodes/AXVoice.h"
+
+namespace
+{
+// The scalar loops ApplyVolume and MixAdd replaced, the block and SSE2 paths must match them
+// bit for bit.
+void ReferenceApplyVolume(s16* samples, u32 count, u16& volume, u16 volume_delta)
+{
+  for (u32 i = 0; i < count; ++i)
+  {
+    samples[i] = MathUtil::Clamp(((s32)samples[i] * volume) >> 15, -32767, 32767);
+    volume += volume_delta;
+  }
+}
+
+void ReferenceMixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
+{
+  u16& volume = pvol[0];
+  u16 volume_delta = ramp ? pvol[1] : 0;
+
+  for (u32 i = 0; i < count; ++i)
+  {
+    s64 sample = input[i];
+    sample *= volume;
+    sample >>= 15;
+    sample = MathUtil::Clamp((s32)sample, -32767, 32767);
+
+    out[i] += (s16)sample;
+    volume += volume_delta;
+
+    *dpop = (s16)sample;
+  }
+}
+
+// Mostly random samples, with runs of full scale ones so that the volume saturates.
+std::vector<s16> RandomSamples(std::mt19937& rng, size_t count)
+{
+  std::uniform_int_distribution<int> sample(-32768, 32767);
+  std::uniform_int_distribution<int> pick(0, 7);
+  std::vector<s16> samples(count);
+  for (s16& s : samples)
+  {
+    switch (pick(rng))
+    {
+    case 0:
+      s = 32767;
+      break;
+    case 1:
+      s = -32768;
+      break;
+    default:
+      s = sample(rng);
+      break;
+    }
+  }
+  return samples;
+}
+
+// Ratios resampling a frame from at most MAX_BLOCK_INPUT_SAMPLES input samples.
+u32 RandomBlockRatio(std::mt19937& rng, u32 count)
+{
+  const u32 max_ratio = (u32)(((u64)MAX_BLOCK_INPUT_SAMPLES << 16) / count) - 0x10000;
+  switch (std::uniform_int_distribution<int>(0, 3)(rng))
+  {
+  case 0:
+    return 0x10000;
+  case 1:
+    return std::uniform_int_distribution<u32>(1, 0x10000)(rng);
+  default:
+    return std::uniform_int_distribution<u32>(1, max_ratio)(rng);
+  }
+}
+
+const std::array<int, 3> SRC_TYPES{{SRCTYPE_POLYPHASE, SRCTYPE_LINEAR, SRCTYPE_NEAREST}};
+
+class ScopeInit final
+{
+public:
+  ScopeInit()
+  {
+    SConfig::Init();
+    CoreTiming::Init();
+    DSP::Init(true);
+    DSP::GetDSPEmulator()->Initialize(false, false);
+  }
+  ~ScopeInit()
+  {
+    DSP::Shutdown();
+    CoreTiming::Shutdown();
+    SConfig::Shutdown();
+  }
+};
+}
+
+TEST(AXVoice, ResampleBlockMatchesResampleAudio)
+{
+  std::mt19937 rng(26);
+  std::vector<s16> coeffs = RandomSamples(rng, 0x200);
+
+  for (int srctype : SRC_TYPES)
+  {
+    for (int iteration = 0; iteration < 2000; ++iteration)
+    {
+      const u32 count = std::uniform_int_distribution<u32>(4, MAX_SAMPLES_PER_FRAME)(rng);
+      const u32 frac = std::uniform_int_distribution<u32>(0, 0xFFFF)(rng);
+      const u32 ratio = RandomBlockRatio(rng, count);
+      const u64 input_count = GetResampleInputCount(count, frac, ratio, srctype);
+      ASSERT_LE(input_count, (u64)MAX_BLOCK_INPUT_SAMPLES);
+
+      std::vector<s16> input = RandomSamples(rng, 4 + MAX_BLOCK_INPUT_SAMPLES);
+      std::vector<s16> history = RandomSamples(rng, 4);
+
+      std::vector<s16> expected(count);
+      std::array<s16, 4> expected_history;
+      std::copy(history.begin(), history.end(), expected_history.begin());
+      u32 read = 0;
+      const u32 expected_pos =
+          ResampleAudio([&](u32) { return input[4 + read++]; }, expected.data(), count,
+                        expected_history.data(), frac, ratio, srctype, coeffs.data());
+
+      std::vector<s16> actual(count);
+      std::array<s16, 4> actual_history;
+      std::copy(history.begin(), history.end(), actual_history.begin());
+      const u32 actual_pos = ResampleBlock(input.data(), actual.data(), count,
+                                           actual_history.data(), frac, ratio, srctype, coeffs.data());
+
+      EXPECT_EQ(input_count, read);
+      EXPECT_EQ(expected, actual);
+      EXPECT_EQ(expected_history, actual_history);
+      EXPECT_EQ(expected_pos & 0xFFFF, actual_pos & 0xFFFF);
+    }
+  }
+}
+
+TEST(AXVoice, ApplyVolumeMatchesScalar)
+{
+  std::mt19937 rng(26);
+  std::uniform_int_distribution<u32> u16_value(0, 0xFFFF);
+
+  for (int iteration = 0; iteration < 5000; ++iteration)
+  {
+    const u32 count = std::uniform_int_distribution<u32>(1, MAX_SAMPLES_PER_FRAME)(rng);
+    // Steep ramps wrap around within a frame.
+    u16 expected_volume = u16_value(rng);
+    const u16 delta = iteration % 4 ? u16_value(rng) : 0;
+    std::vector<s16> expected = RandomSamples(rng, count);
+    std::vector<s16> actual = expected;
+    u16 actual_volume = expected_volume;
+
+    ReferenceApplyVolume(expected.data(), count, expected_volume, delta);
+    ApplyVolume(actual.data(), count, actual_volume, delta);
+
+    EXPECT_EQ(expected, actual);
+    EXPECT_EQ(expected_volume, actual_volume);
+  }
+}
+
+TEST(AXVoice, MixAddMatchesScalar)
+{
+  std::mt19937 rng(26);
+  std::uniform_int_distribution<u32> u16_value(0, 0xFFFF);
+  std::uniform_int_distribution<int> out_value(-1 << 20, 1 << 20);
+
+  for (int iteration = 0; iteration < 5000; ++iteration)
+  {
+    const u32 count = std::uniform_int_distribution<u32>(1, MAX_SAMPLES_PER_FRAME)(rng);
+    const bool ramp = iteration % 2 == 0;
+    const std::vector<s16> input = RandomSamples(rng, count);
+
+    std::vector<int> expected(count);
+    for (int& out : expected)
+      out = out_value(rng);
+    std::vector<int> actual = expected;
+    std::array<u16, 2> expected_vol{{(u16)u16_value(rng), (u16)u16_value(rng)}};
+    std::array<u16, 2> actual_vol = expected_vol;
+    s16 expected_dpop = 123;
+    s16 actual_dpop = expected_dpop;
+
+    ReferenceMixAdd(expected.data(), input.data(), count, expected_vol.data(), &expected_dpop,
+                    ramp);
+    MixAdd(actual.data(), input.data(), count, actual_vol.data(), &actual_dpop, ramp);
+
+    EXPECT_EQ(expected, actual);
+    EXPECT_EQ(expected_vol, actual_vol);
+    EXPECT_EQ(expected_dpop, actual_dpop);
+  }
+}
+
+// GetInputSamples on 16-bit PCM in ARAM, both for ratios that fit in a block and for the ones
+// so high that it has to fall back to resampling sample by sample.
+TEST(AXVoice, GetInputSamplesMatchesResampleAudio)
+{
+  ScopeInit init;
+  std::mt19937 rng(26);
+
+  const u32 start = 0x1000;
+  const std::vector<s16> pcm = RandomSamples(rng, 0x10000);
+  u8* aram = DSP::GetARAMPtr();
+  for (size_t i = 0; i < pcm.size(); ++i)
+  {
+    aram[(start + i) * 2] = (u8)(pcm[i] >> 8);
+    aram[(start + i) * 2 + 1] = (u8)pcm[i];
+  }
+
+  const u32 count = MAX_SAMPLES_PER_FRAME;
+  const u32 max_block_ratio = (u32)(((u64)MAX_BLOCK_INPUT_SAMPLES << 16) / count) - 0x10000;
+  const std::array<u32, 6> ratios{{0x8000, 0x10000, 0x3A5E3, max_block_ratio,
+                                   max_block_ratio + 0x20000, 0x1C0000}};
+
+  for (int srctype : SRC_TYPES)
+  {
+    for (u32 ratio : ratios)
+    {
+      AXPB pb = {};
+      pb.src_type = srctype;
+      pb.audio_addr.sample_format = 0x0A;
+      pb.audio_addr.cur_addr_hi = start >> 16;
+      pb.audio_addr.cur_addr_lo = start & 0xFFFF;
+      pb.audio_addr.end_addr_hi = (start + (u32)pcm.size() - 1) >> 16;
+      pb.audio_addr.end_addr_lo = (start + (u32)pcm.size() - 1) & 0xFFFF;
+      pb.src.ratio_hi = ratio >> 16;
+      pb.src.ratio_lo = ratio & 0xFFFF;
+      pb.src.cur_addr_frac = 0x1234;
+      for (int i = 0; i < 4; ++i)
+        pb.src.last_samples[i] = pcm[i] ^ 0x5555;
+
+      std::vector<s16> expected(count);
+      std::array<s16, 4> expected_history;
+      std::copy(pb.src.last_samples, pb.src.last_samples + 4, expected_history.begin());
+      u32 read = 0;
+      const u32 expected_pos =
+          ResampleAudio([&](u32) { return pcm[read++]; }, expected.data(), count,
+                        expected_history.data(), pb.src.cur_addr_frac, ratio, srctype, nullptr);
+
+      std::vector<s16> actual(count);
+      GetInputSamples(pb, actual.data(), count, nullptr);
+
+      EXPECT_EQ(expected, actual);
+      EXPECT_TRUE(std::equal(expected_history.begin(), expected_history.end(),
+                             pb.src.last_samples));
+      EXPECT_EQ(expected_pos & 0xFFFF, pb.src.cur_addr_frac);
+      EXPECT_EQ(start + read, (u32)HILO_TO_32(pb.audio_addr.cur_addr));
+    }
+  }
+}
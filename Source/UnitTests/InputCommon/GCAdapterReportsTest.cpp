@@ -0,0 +1,171 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
+#include "InputCommon/GCAdapterReports.h"
+
+using namespace GCAdapter;
+
+namespace
+{
+// What a WUP-028 looks like from the PC: the controllers are polled every 1.2ms, but the
+// reports only come in on 1ms USB frames, hence a 2ms gap every 5 reports.
+AdapterReportStream MakeOfficialAdapterStream(u32 num_reports)
+{
+  AdapterReportStream stream;
+  const time_point start = std::chrono::high_resolution_clock::now();
+  u64 offset_ms = 0;
+  for (u32 i = 0; i < num_reports; ++i)
+  {
+    u8 payload[ADAPTER_PAYLOAD_SIZE] = {0x21};
+    payload[1] = (u8)i;
+    stream.Append(start + std::chrono::milliseconds(offset_ms), payload, ADAPTER_PAYLOAD_SIZE);
+    offset_ms += i % 5 == 0 ? 2 : 1;
+  }
+  return stream;
+}
+}
+
+TEST(GCAdapterReports, RingKeepsLatestReports)
+{
+  AdapterReportRing ring;
+  AdapterReport report;
+  EXPECT_EQ(0u, ring.Published());
+  EXPECT_FALSE(ring.Read(0, &report));
+
+  for (u32 i = 0; i < AdapterReportRing::CAPACITY + 10; ++i)
+  {
+    report.payload_size = ADAPTER_PAYLOAD_SIZE;
+    report.payload[1] = (u8)i;
+    ring.Publish(report);
+  }
+
+  EXPECT_EQ((u32)AdapterReportRing::CAPACITY + 10, ring.Published());
+  // the first 10 were overwritten
+  EXPECT_FALSE(ring.Read(9, &report));
+  for (u32 i = 10; i < ring.Published(); ++i)
+  {
+    ASSERT_TRUE(ring.Read(i, &report));
+    EXPECT_EQ((u8)i, report.payload[1]);
+  }
+  EXPECT_FALSE(ring.Read(ring.Published(), &report));
+
+  ring.Reset();
+  EXPECT_EQ(0u, ring.Published());
+  EXPECT_FALSE(ring.Read(10, &report));
+}
+
+TEST(GCAdapterReports, FetchLatestWithoutTiming)
+{
+  AdapterReportRing ring;
+  ReportTimingEstimator estimator;
+  AdapterReport report;
+  EXPECT_FALSE(FetchReport(ring, nullptr, true, &report));
+
+  MakeOfficialAdapterStream(20).Replay(std::chrono::high_resolution_clock::now(), false,
+    &estimator, &ring);
+  ASSERT_TRUE(FetchReport(ring, nullptr, true, &report));
+  EXPECT_EQ(19, report.payload[1]);
+  EXPECT_EQ(report.raw_timing, report.estimated_timing);
+}
+
+TEST(GCAdapterReports, FetchMatchesPollTiming)
+{
+  AdapterReportRing ring;
+  ReportTimingEstimator estimator;
+  const time_point start = std::chrono::high_resolution_clock::now();
+  MakeOfficialAdapterStream(2000).Replay(start, true, &estimator, &ring);
+
+  AdapterReport latest;
+  ASSERT_TRUE(ring.Read(ring.Published() - 1, &latest));
+  // ~830Hz, well over the rate at which timings get reconstructed
+  EXPECT_TRUE(latest.eilv_optims);
+  EXPECT_TRUE(latest.timing_reconstruction);
+
+  // Reconstructed polls are 1.2ms apart
+  AdapterReport previous;
+  ASSERT_TRUE(ring.Read(ring.Published() - 6, &previous));
+  EXPECT_EQ(6'000'000, std::chrono::duration_cast<std::chrono::nanoseconds>(
+    latest.estimated_timing - previous.estimated_timing).count());
+
+  // A poll right after the latest report can't see it yet, it gets the one before
+  AdapterReport report;
+  time_point tp = latest.raw_timing;
+  ASSERT_TRUE(FetchReport(ring, &tp, true, &report));
+  EXPECT_LT(report.estimated_timing, latest.estimated_timing);
+
+  // Far enough in the future, the latest report is used
+  tp = latest.raw_timing + std::chrono::milliseconds(5);
+  ASSERT_TRUE(FetchReport(ring, &tp, true, &report));
+  EXPECT_EQ(latest.payload[1], report.payload[1]);
+
+  // Without dispersion reduction the latest report is always used
+  tp = latest.raw_timing;
+  ASSERT_TRUE(FetchReport(ring, &tp, false, &report));
+  EXPECT_EQ(latest.payload[1], report.payload[1]);
+}
+
+TEST(GCAdapterReports, ReplayIsDeterministic)
+{
+  const std::string temp_dir = File::CreateTempDir();
+  const std::string filename = temp_dir + DIR_SEP "reports.gcar";
+  const AdapterReportStream recorded = MakeOfficialAdapterStream(300);
+  ASSERT_TRUE(recorded.Save(filename));
+
+  AdapterReportStream loaded;
+  ASSERT_TRUE(loaded.Load(filename));
+  ASSERT_EQ(recorded.GetEntries().size(), loaded.GetEntries().size());
+
+  const time_point start = std::chrono::high_resolution_clock::now();
+  AdapterReportRing ring_a, ring_b;
+  ReportTimingEstimator estimator_a, estimator_b;
+  recorded.Replay(start, true, &estimator_a, &ring_a);
+  loaded.Replay(start, true, &estimator_b, &ring_b);
+
+  ASSERT_EQ(ring_a.Published(), ring_b.Published());
+  for (u32 i = ring_a.Published() - AdapterReportRing::CAPACITY; i < ring_a.Published(); ++i)
+  {
+    AdapterReport a, b;
+    ASSERT_TRUE(ring_a.Read(i, &a));
+    ASSERT_TRUE(ring_b.Read(i, &b));
+    EXPECT_EQ(a.raw_timing, b.raw_timing);
+    EXPECT_EQ(a.estimated_timing, b.estimated_timing);
+    EXPECT_EQ(a.payload_size, b.payload_size);
+    EXPECT_EQ(0, memcmp(a.payload, b.payload, ADAPTER_PAYLOAD_SIZE));
+  }
+
+  File::DeleteDirRecursively(temp_dir);
+}
+
+TEST(GCAdapterReports, LatencyHistogram)
+{
+  LatencyHistogram histogram;
+  EXPECT_EQ(0u, histogram.GetStats().count);
+
+  for (s64 i = 1; i <= 100; ++i)
+    histogram.Record(i * 100'000);
+
+  LatencyStats stats = histogram.GetStats();
+  EXPECT_EQ(100u, stats.count);
+  EXPECT_EQ(100'000u, stats.min_ns);
+  EXPECT_EQ(10'000'000u, stats.max_ns);
+  EXPECT_EQ(5'050'000u, stats.mean_ns);
+  // percentiles are rounded up to the end of their 50us bucket
+  EXPECT_EQ(5'050'000u, stats.p50_ns);
+  EXPECT_EQ(9'550'000u, stats.p95_ns);
+  EXPECT_EQ(9'950'000u, stats.p99_ns);
+
+  // Anything past the last bucket is still accounted for
+  histogram.Record(1'000'000'000);
+  EXPECT_EQ(1'000'000'000u, histogram.GetStats().max_ns);
+
+  histogram.Reset();
+  EXPECT_EQ(0u, histogram.GetStats().count);
+}
@@ -0,0 +1,94 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
+
+namespace
+{
+// One triangle, line or point at a time, like the generators did before they were vectorized
+void AppendReferenceIndices(int primitive, u32 base, u32 count, std::vector<u16>* out)
+{
+  u32 top = base + count;
+  switch (primitive)
+  {
+  case GX_DRAW_QUADS:
+  case GX_DRAW_QUADS_2:
+    for (u32 i = base; i + 3 < top; i += 4)
+      out->insert(out->end(), {(u16)i, (u16)(i + 1), (u16)(i + 2), (u16)i, (u16)(i + 2), (u16)(i + 3)});
+    if (count % 4 == 3)
+      out->insert(out->end(), {(u16)(top - 3), (u16)(top - 2), (u16)(top - 1)});
+    break;
+  case GX_DRAW_TRIANGLES:
+    for (u32 i = base; i + 2 < top; i += 3)
+      out->insert(out->end(), {(u16)i, (u16)(i + 1), (u16)(i + 2)});
+    break;
+  case GX_DRAW_TRIANGLE_STRIP:
+    for (u32 i = base; i + 2 < top; ++i)
+    {
+      if ((i - base) & 1)
+        out->insert(out->end(), {(u16)i, (u16)(i + 2), (u16)(i + 1)});
+      else
+        out->insert(out->end(), {(u16)i, (u16)(i + 1), (u16)(i + 2)});
+    }
+    break;
+  case GX_DRAW_TRIANGLE_FAN:
+    for (u32 i = base + 1; i + 1 < top; ++i)
+      out->insert(out->end(), {(u16)base, (u16)i, (u16)(i + 1)});
+    break;
+  case GX_DRAW_LINES:
+    for (u32 i = base; i + 1 < top; i += 2)
+      out->insert(out->end(), {(u16)i, (u16)(i + 1)});
+    break;
+  case GX_DRAW_LINE_STRIP:
+    for (u32 i = base; i + 1 < top; ++i)
+      out->insert(out->end(), {(u16)i, (u16)(i + 1)});
+    break;
+  case GX_DRAW_POINTS:
+    for (u32 i = base; i < top; ++i)
+      out->push_back((u16)i);
+    break;
+  }
+}
+}
+
+TEST(IndexGenerator, MatchesReference)
+{
+  static const int primitives[] = {
+      GX_DRAW_QUADS,          GX_DRAW_QUADS_2,      GX_DRAW_TRIANGLES,  GX_DRAW_TRIANGLE_STRIP,
+      GX_DRAW_TRIANGLE_FAN,   GX_DRAW_LINES,        GX_DRAW_LINE_STRIP, GX_DRAW_POINTS,
+  };
+
+  // Twice the largest batch times 3 indices per vertex, plus room to detect overruns
+  std::vector<u16> buffer(2 * 3 * 100 + 16);
+  for (int primitive : primitives)
+  {
+    for (u32 count = 0; count < 100; ++count)
+    {
+      std::fill(buffer.begin(), buffer.end(), 0xDEAD);
+      IndexGenerator::Start(buffer.data());
+      // The second batch doesn't start at index 0
+      IndexGenerator::AddIndices(primitive, count);
+      IndexGenerator::AddIndices(primitive, count);
+
+      std::vector<u16> expected;
+      AppendReferenceIndices(primitive, 0, count, &expected);
+      AppendReferenceIndices(primitive, count, count, &expected);
+
+      ASSERT_EQ(expected.size(), IndexGenerator::GetIndexLen())
+          << "primitive " << primitive << " count " << count;
+      EXPECT_EQ(2 * count, IndexGenerator::GetNumVerts());
+      for (size_t i = 0; i < expected.size(); ++i)
+        ASSERT_EQ(expected[i], buffer[i]) << "primitive " << primitive << " count " << count
+                                          << " index " << i;
+      EXPECT_EQ(0xDEAD, buffer[expected.size()]);
+    }
+  }
+}
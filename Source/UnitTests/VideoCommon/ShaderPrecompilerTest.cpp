@@ -0,0 +1,98 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/ShaderPrecompiler.h"
+
+namespace
+{
+using Precompiler = ShaderPrecompiler<u32, std::string>;
+
+bool GenerateCode(const u32& uid, std::string& code)
+{
+  // Every 7th shader can't be generated
+  if (uid % 7 == 0)
+    return false;
+  code = std::to_string(uid);
+  return true;
+}
+
+// Keeps calling Process like the GPU thread would, until everything went through
+void ProcessAll(Precompiler* precompiler, std::chrono::microseconds budget)
+{
+  const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (!precompiler->Process(budget))
+  {
+    ASSERT_LT(std::chrono::steady_clock::now(), timeout);
+    std::this_thread::yield();
+  }
+}
+}
+
+TEST(ShaderPrecompiler, CompilesInOrder)
+{
+  // More than GENERATE_AHEAD, in an order unrelated to the uids
+  std::vector<u32> uids;
+  for (u32 i = 0; i < 500; ++i)
+    uids.push_back((i * 37) % 500);
+
+  std::vector<u32> compiled;
+  Precompiler precompiler(uids, GenerateCode, [&](const u32& uid, std::string& code) {
+    EXPECT_EQ(std::to_string(uid), code);
+    compiled.push_back(uid);
+  });
+  EXPECT_EQ(uids.size(), precompiler.GetTotalCount());
+  ProcessAll(&precompiler, std::chrono::microseconds(1000));
+
+  std::vector<u32> expected;
+  for (u32 uid : uids)
+  {
+    if (uid % 7 != 0)
+      expected.push_back(uid);
+  }
+  EXPECT_EQ(expected, compiled);
+  EXPECT_EQ(expected.size(), precompiler.GetCompiledCount());
+  EXPECT_TRUE(precompiler.IsDone());
+}
+
+TEST(ShaderPrecompiler, CompilesOneShaderWithoutBudget)
+{
+  std::vector<u32> uids = {1, 2, 3, 4, 5};
+  u32 compiled = 0;
+  Precompiler precompiler(uids, GenerateCode,
+                          [&](const u32& uid, std::string& code) { compiled++; });
+
+  const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (!precompiler.IsDone())
+  {
+    ASSERT_LT(std::chrono::steady_clock::now(), timeout);
+    const u32 before = compiled;
+    precompiler.Process(std::chrono::microseconds(0));
+    EXPECT_LE(compiled, before + 1);
+  }
+  EXPECT_EQ(uids.size(), compiled);
+}
+
+TEST(ShaderPrecompiler, DestroyWhileGenerating)
+{
+  std::vector<u32> uids(1000, 1);
+  {
+    Precompiler precompiler(uids,
+                            [](const u32& uid, std::string& code) {
+                              std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                              return true;
+                            },
+                            [](const u32& uid, std::string& code) {});
+    precompiler.Process(std::chrono::microseconds(0));
+  }
+  // The running tasks must stop without touching the precompiler
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+}